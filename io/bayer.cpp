@@ -0,0 +1,124 @@
+#include "bayer.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace io
+{
+// 解马赛克插值需要的邻域
+constexpr int ROI_MARGIN = 2;
+
+int bayer2bgr_code(BayerPattern pattern)
+{
+  // OpenCV以第二行第二、三列命名Bayer排列, 与SDK的命名错开一行一列
+  switch (pattern) {
+    case BayerPattern::RGGB:
+      return cv::COLOR_BayerBG2BGR;
+    case BayerPattern::GRBG:
+      return cv::COLOR_BayerGB2BGR;
+    case BayerPattern::GBRG:
+      return cv::COLOR_BayerGR2BGR;
+    case BayerPattern::BGGR:
+      return cv::COLOR_BayerRG2BGR;
+    default:
+      throw std::invalid_argument("Not a bayer pattern!");
+  }
+}
+
+void demosaic(const cv::Mat & raw, BayerPattern pattern, cv::Mat & bgr)
+{
+  if (pattern == BayerPattern::none) {
+    bgr = raw;
+    return;
+  }
+  cv::cvtColor(raw, bgr, bayer2bgr_code(pattern));
+}
+
+void demosaic(const cv::Mat & raw, BayerPattern pattern, const cv::Rect & roi, cv::Mat & bgr)
+{
+  auto image_rect = cv::Rect(0, 0, raw.cols, raw.rows);
+  auto valid_roi = roi & image_rect;
+  if (valid_roi.empty()) {
+    bgr.release();
+    return;
+  }
+
+  if (pattern == BayerPattern::none) {
+    raw(valid_roi).copyTo(bgr);
+    return;
+  }
+
+  // 起点对齐到偶数坐标以保持Bayer排列不变, 并留出插值邻域
+  auto x0 = std::max(0, (valid_roi.x - ROI_MARGIN) & ~1);
+  auto y0 = std::max(0, (valid_roi.y - ROI_MARGIN) & ~1);
+  auto x1 = std::min(raw.cols, valid_roi.x + valid_roi.width + ROI_MARGIN);
+  auto y1 = std::min(raw.rows, valid_roi.y + valid_roi.height + ROI_MARGIN);
+  auto padded_roi = cv::Rect(x0, y0, x1 - x0, y1 - y0);
+
+  cv::Mat padded_bgr;
+  cv::cvtColor(raw(padded_roi), padded_bgr, bayer2bgr_code(pattern));
+  padded_bgr(valid_roi - padded_roi.tl()).copyTo(bgr);
+}
+
+double demosaic_resize(
+  const cv::Mat & raw, BayerPattern pattern, const cv::Size & size, cv::Mat & bgr)
+{
+  auto scale = std::min(
+    static_cast<double>(size.width) / raw.cols, static_cast<double>(size.height) / raw.rows);
+  auto w = static_cast<int>(raw.cols * scale);
+  auto h = static_cast<int>(raw.rows * scale);
+
+  bgr.create(size, CV_8UC3);
+  bgr.setTo(cv::Scalar(0, 0, 0));
+  cv::Mat dst = bgr(cv::Rect(0, 0, w, h));
+
+  if (pattern == BayerPattern::none) {
+    cv::resize(raw, dst, {w, h});
+    return scale;
+  }
+
+  // 放大或轻微缩小时超像素会损失细节, 退化为完整解马赛克
+  if (w * 2 > raw.cols || h * 2 > raw.rows) {
+    cv::Mat full;
+    cv::cvtColor(raw, full, bayer2bgr_code(pattern));
+    cv::resize(full, dst, {w, h});
+    return scale;
+  }
+
+  // 2x2单元内R、B的位置, G取两个像素的平均
+  int r_row, r_col;
+  switch (pattern) {
+    case BayerPattern::RGGB:
+      r_row = 0, r_col = 0;
+      break;
+    case BayerPattern::GRBG:
+      r_row = 0, r_col = 1;
+      break;
+    case BayerPattern::GBRG:
+      r_row = 1, r_col = 0;
+      break;
+    default:
+      r_row = 1, r_col = 1;
+      break;
+  }
+  auto b_row = 1 - r_row, b_col = 1 - r_col;
+
+  cv::Mat half(raw.rows / 2, raw.cols / 2, CV_8UC3);
+  cv::parallel_for_(cv::Range(0, half.rows), [&](const cv::Range & range) {
+    for (int i = range.start; i < range.end; i++) {
+      const uchar * rows[2] = {raw.ptr<uchar>(2 * i), raw.ptr<uchar>(2 * i + 1)};
+      auto dst = half.ptr<cv::Vec3b>(i);
+      for (int j = 0; j < half.cols; j++) {
+        auto r = rows[r_row][2 * j + r_col];
+        auto b = rows[b_row][2 * j + b_col];
+        auto g = (rows[r_row][2 * j + b_col] + rows[b_row][2 * j + r_col] + 1) >> 1;
+        dst[j] = cv::Vec3b(b, g, r);
+      }
+    }
+  });
+
+  cv::resize(half, dst, {w, h}, 0, 0, cv::INTER_AREA);
+  return scale;
+}
+
+}  // namespace io
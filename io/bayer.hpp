@@ -0,0 +1,36 @@
+#ifndef IO__BAYER_HPP
+#define IO__BAYER_HPP
+
+#include <opencv2/opencv.hpp>
+
+namespace io
+{
+// Bayer排列方式, 以左上角2x2像素命名(与相机SDK一致)
+// none表示图像已经是BGR
+enum class BayerPattern
+{
+  none,
+  RGGB,
+  GRBG,
+  GBRG,
+  BGGR
+};
+
+// 对应的cv::cvtColor转换码(输出BGR)
+int bayer2bgr_code(BayerPattern pattern);
+
+// 整幅图像解马赛克, pattern为none时直接拷贝引用
+void demosaic(const cv::Mat & raw, BayerPattern pattern, cv::Mat & bgr);
+
+// 只解马赛克raw中的roi区域, bgr大小为roi.size()
+void demosaic(const cv::Mat & raw, BayerPattern pattern, const cv::Rect & roi, cv::Mat & bgr);
+
+// 直接由Bayer图像得到letterbox后的BGR图像(用作神经网络输入), 返回缩放比例
+// 保持宽高比缩放到size内, 左上对齐, 其余填0; bgr已是size大小的CV_8UC3时原地写入
+// 先按2x2超像素合成半分辨率BGR, 再缩放, 不产生全分辨率BGR
+double demosaic_resize(
+  const cv::Mat & raw, BayerPattern pattern, const cv::Size & size, cv::Mat & bgr);
+
+}  // namespace io
+
+#endif  // IO__BAYER_HPP
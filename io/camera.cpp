@@ -4,36 +4,139 @@
 
 #include "hikrobot/hikrobot.hpp"
 #include "mindvision/mindvision.hpp"
+#include "replay/replay.hpp"
+#include "tools/logger.hpp"
 #include "tools/yaml.hpp"
 
 namespace io
 {
+bool CameraBase::read(cv::Mat & img, std::chrono::steady_clock::time_point & timestamp)
+{
+  cv::Mat raw;
+  BayerPattern pattern;
+  if (!read_raw(raw, pattern, timestamp)) return false;
+
+  if (pattern == BayerPattern::none) {
+    img = raw;
+    return true;
+  }
+
+  bgr_pool_.acquire(raw.rows, raw.cols, CV_8UC3, img);
+  demosaic(raw, pattern, img);
+  return true;
+}
+
+bool CameraBase::read_raw(
+  cv::Mat & raw, BayerPattern & pattern, std::chrono::steady_clock::time_point & timestamp)
+{
+  {
+    std::unique_lock<std::mutex> lock(mailbox_mutex_);
+
+    if (mailbox_seq_ == last_read_seq_) stats_.duplicate_reads++;
+    mailbox_cv_.wait(lock, [this] { return mailbox_seq_ != last_read_seq_ || closed_; });
+    if (mailbox_seq_ == last_read_seq_) return false;
+
+    // 移出而非拷贝, 使信箱不再持有该帧的引用
+    raw = std::move(mailbox_img_);
+    pattern = mailbox_pattern_;
+    timestamp = mailbox_timestamp_;
+    last_read_seq_ = mailbox_seq_;
+
+    auto now = std::chrono::steady_clock::now();
+    if (stats_.reads == 0) stats_.first_read = now;
+    stats_.last_read = now;
+    stats_.reads++;
+  }
+  mailbox_cv_.notify_all();
+  return true;
+}
+
+CameraStats CameraBase::stats() const
+{
+  std::lock_guard<std::mutex> lock(mailbox_mutex_);
+  return stats_;
+}
+
+void CameraBase::publish(
+  const cv::Mat & img, const std::chrono::steady_clock::time_point & timestamp,
+  BayerPattern pattern)
+{
+  {
+    std::lock_guard<std::mutex> lock(mailbox_mutex_);
+    if (mailbox_seq_ != last_read_seq_) stats_.overwritten++;
+    mailbox_img_ = img;
+    mailbox_pattern_ = pattern;
+    mailbox_timestamp_ = timestamp;
+    mailbox_seq_++;
+    stats_.published++;
+  }
+  mailbox_cv_.notify_all();
+}
+
+bool CameraBase::wait_until_read(std::chrono::milliseconds timeout)
+{
+  std::unique_lock<std::mutex> lock(mailbox_mutex_);
+  return mailbox_cv_.wait_for(lock, timeout, [this] { return mailbox_seq_ == last_read_seq_; });
+}
+
+void CameraBase::close()
+{
+  {
+    std::lock_guard<std::mutex> lock(mailbox_mutex_);
+    closed_ = true;
+  }
+  mailbox_cv_.notify_all();
+}
+
 Camera::Camera(const std::string & config_path)
 {
   auto yaml = tools::load(config_path);
   auto camera_name = tools::read<std::string>(yaml, "camera_name");
-  auto exposure_ms = tools::read<double>(yaml, "exposure_ms");
 
   if (camera_name == "mindvision") {
+    auto exposure_ms = tools::read<double>(yaml, "exposure_ms");
     auto gamma = tools::read<double>(yaml, "gamma");
     auto vid_pid = tools::read<std::string>(yaml, "vid_pid");
     camera_ = std::make_unique<MindVision>(exposure_ms, gamma, vid_pid);
   }
 
   else if (camera_name == "hikrobot") {
+    auto exposure_ms = tools::read<double>(yaml, "exposure_ms");
     auto gain = tools::read<double>(yaml, "gain");
     auto vid_pid = tools::read<std::string>(yaml, "vid_pid");
     camera_ = std::make_unique<HikRobot>(exposure_ms, gain, vid_pid);
   }
 
+  else if (camera_name == "replay") {
+    auto replay_path = tools::read<std::string>(yaml, "replay_path");
+    auto realtime = yaml["replay_realtime"] ? yaml["replay_realtime"].as<bool>() : true;
+    camera_ = std::make_unique<Replay>(replay_path, realtime);
+  }
+
   else {
     throw std::runtime_error("Unknow camera_name: " + camera_name + "!");
   }
 }
 
-void Camera::read(cv::Mat & img, std::chrono::steady_clock::time_point & timestamp)
+bool Camera::read(cv::Mat & img, std::chrono::steady_clock::time_point & timestamp)
+{
+  return camera_->read(img, timestamp);
+}
+
+bool Camera::read_raw(
+  cv::Mat & raw, BayerPattern & pattern, std::chrono::steady_clock::time_point & timestamp)
+{
+  return camera_->read_raw(raw, pattern, timestamp);
+}
+
+CameraStats Camera::stats() const { return camera_->stats(); }
+
+void Camera::report() const
 {
-  camera_->read(img, timestamp);
+  auto stats = camera_->stats();
+  tools::logger()->info(
+    "[Camera] {} frames read at {:.1f} fps | {} overwritten | {} duplicate reads", stats.reads,
+    stats.fps(), stats.overwritten, stats.duplicate_reads);
 }
 
 }  // namespace io
\ No newline at end of file
@@ -2,24 +2,91 @@
 #define IO__CAMERA_HPP
 
 #include <chrono>
+#include <condition_variable>
+#include <cstdint>
 #include <memory>
+#include <mutex>
 #include <opencv2/opencv.hpp>
 #include <string>
 
+#include "io/bayer.hpp"
+#include "tools/frame_pool.hpp"
+
 namespace io
 {
+struct CameraStats
+{
+  uint64_t published = 0;        // 取图线程发布的帧数
+  uint64_t overwritten = 0;      // 未被读取就被新帧覆盖的帧数(消费者跟不上)
+  uint64_t duplicate_reads = 0;  // read()时只有已读过的帧、需要等待新帧的次数(消费者比相机快)
+  uint64_t reads = 0;            // read()成功读到的帧数
+  std::chrono::steady_clock::time_point first_read, last_read;
+
+  // 第一次与最后一次read()之间的平均帧率
+  double fps() const
+  {
+    std::chrono::duration<double> dt = last_read - first_read;
+    return reads > 1 && dt.count() > 0 ? (reads - 1) / dt.count() : 0;
+  }
+};
+
 class CameraBase
 {
 public:
   virtual ~CameraBase() = default;
-  virtual void read(cv::Mat & img, std::chrono::steady_clock::time_point & timestamp) = 0;
+
+  // 阻塞直到有比上一次读到的更新的帧, 总是返回最新的一帧(BGR)
+  // 相机发布的是Bayer图像时, 在调用者线程中解马赛克
+  // 数据源已结束(如回放到文件末尾)且没有未读的帧时返回false
+  virtual bool read(cv::Mat & img, std::chrono::steady_clock::time_point & timestamp);
+
+  // 同read(), 但不解马赛克, 直接返回相机原始图像及其Bayer排列
+  // 需要时再用io/bayer.hpp中的函数只处理网络输入或ROI
+  bool read_raw(
+    cv::Mat & raw, BayerPattern & pattern, std::chrono::steady_clock::time_point & timestamp);
+
+  CameraStats stats() const;
+
+protected:
+  // 取图线程调用: 覆盖单槽信箱中的帧, 新帧优先
+  void publish(
+    const cv::Mat & img, const std::chrono::steady_clock::time_point & timestamp,
+    BayerPattern pattern = BayerPattern::none);
+
+  // 等待信箱中的帧被读走, 超时返回false (回放等需要背压的数据源使用)
+  bool wait_until_read(std::chrono::milliseconds timeout);
+
+  // 取图线程调用: 不会再有新帧, 唤醒并结束阻塞中的read()
+  void close();
+
+private:
+  mutable std::mutex mailbox_mutex_;
+  std::condition_variable mailbox_cv_;
+  cv::Mat mailbox_img_;
+  BayerPattern mailbox_pattern_ = BayerPattern::none;
+  std::chrono::steady_clock::time_point mailbox_timestamp_;
+  uint64_t mailbox_seq_ = 0;  // 最新帧的序号, 0表示还没有帧
+  uint64_t last_read_seq_ = 0;
+  bool closed_ = false;
+  CameraStats stats_;
+
+  // read()解马赛克的输出缓冲, 只在调用read()的线程中使用
+  tools::FramePool bgr_pool_{4};
 };
 
 class Camera
 {
 public:
   Camera(const std::string & config_path);
-  void read(cv::Mat & img, std::chrono::steady_clock::time_point & timestamp);
+
+  // 数据源已结束(如回放到文件末尾)时返回false, 调用者应退出主循环
+  bool read(cv::Mat & img, std::chrono::steady_clock::time_point & timestamp);
+  bool read_raw(
+    cv::Mat & raw, BayerPattern & pattern, std::chrono::steady_clock::time_point & timestamp);
+  CameraStats stats() const;
+
+  // 输出读到的帧数与平均帧率, 在程序退出前调用
+  void report() const;
 
 private:
   std::unique_ptr<CameraBase> camera_;
@@ -27,4 +94,4 @@ private:
 
 }  // namespace io
 
-#endif  // IO__CAMERA_HPP
\ No newline at end of file
+#endif  // IO__CAMERA_HPP
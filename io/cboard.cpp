@@ -1,5 +1,8 @@
 #include "cboard.hpp"
 
+#include <algorithm>
+#include <cstring>
+
 #include "tools/math_tools.hpp"
 #include "tools/yaml.hpp"
 
@@ -9,45 +12,56 @@ CBoard::CBoard(const std::string & config_path)
 : mode(Mode::idle),
   shoot_mode(ShootMode::left_shoot),
   bullet_speed(0),
-  queue_(5000),
-  can_(read_yaml(config_path), std::bind(&CBoard::callback, this, std::placeholders::_1))
-// 注意: callback的运行会早于Cboard构造函数的完成
+  imu_history_(5000)
 {
+  auto can_interface = read_yaml(config_path);
+
+  if (replay_imu_) {
+    tools::logger()->info("[Cboard] Replaying, CAN disabled.");
+    return;
+  }
+
+  // 注意: callback的运行会早于Cboard构造函数的完成
+  can_ = std::make_unique<SocketCAN>(can_interface, [this](const can_frame & frame, auto t) {
+    callback(frame, t);
+  });
+
+  tx_ = std::make_unique<Transmitter>("CBoard", send_rate_, [this](const uint8_t * data, size_t) {
+    can_frame frame;
+    std::memcpy(&frame, data, sizeof(frame));
+    can_->write(&frame);
+  });
+
   tools::logger()->info("[Cboard] Waiting for q...");
-  queue_.pop(data_ahead_);
-  queue_.pop(data_behind_);
+  while (imu_history_.size() < 2) std::this_thread::sleep_for(1ms);
   tools::logger()->info("[Cboard] Opened.");
 }
 
-// 球面线性插值（SLERP）
+// 不消耗历史数据, 可在多个线程中并发调用
 Eigen::Quaterniond CBoard::imu_at(std::chrono::steady_clock::time_point timestamp)
 {
-  if (data_behind_.timestamp < timestamp) data_ahead_ = data_behind_;
+  return attitude_at(timestamp).q;
+}
 
-  while (true) {
-    queue_.pop(data_behind_);
-    if (data_behind_.timestamp > timestamp) break;
-    data_ahead_ = data_behind_;
-  }
+tools::ImuHistory::Attitude CBoard::attitude_at(std::chrono::steady_clock::time_point timestamp)
+{
+  if (replay_imu_) return {replay_imu_->imu_at(timestamp), 0, false, false};
 
-  Eigen::Quaterniond q_a = data_ahead_.q.normalized();
-  Eigen::Quaterniond q_b = data_behind_.q.normalized();
-  auto t_a = data_ahead_.timestamp;
-  auto t_b = data_behind_.timestamp;
-  auto t_c = timestamp;
-  std::chrono::duration<double> t_ab = t_b - t_a;
-  std::chrono::duration<double> t_ac = t_c - t_a;
+  auto attitude = imu_history_.attitude_at(timestamp);
 
-  // 四元数插值
-  auto k = t_ac / t_ab;
-  Eigen::Quaterniond q_c = q_a.slerp(k, q_b).normalized();
+  // 限制日志输出频率为1Hz
+  if (imu_history_.stale_warning_due(attitude, std::chrono::steady_clock::now())) {
+    tools::logger()->warn("[CBoard] IMU data is {:.1f}ms old, link lost?", attitude.age * 1e3);
+  }
 
-  return q_c;
+  return attitude;
 }
 
 void CBoard::send(Command command) const
 {
-  can_frame frame;
+  if (!tx_) return;
+
+  can_frame frame{};  // 填充字节清零, 使相同的命令逐字节相同
   frame.can_id = send_canid_;
   frame.can_dlc = 8;
   frame.data[0] = (command.control) ? 1 : 0;
@@ -59,17 +73,11 @@ void CBoard::send(Command command) const
   frame.data[6] = (int16_t)(command.horizon_distance * 1e4) >> 8;
   frame.data[7] = (int16_t)(command.horizon_distance * 1e4);
 
-  try {
-    can_.write(&frame);
-  } catch (const std::exception & e) {
-    tools::logger()->warn("{}", e.what());
-  }
+  tx_->publish(&frame, sizeof(frame));
 }
 
-void CBoard::callback(const can_frame & frame)
+void CBoard::callback(const can_frame & frame, std::chrono::steady_clock::time_point timestamp)
 {
-  auto timestamp = std::chrono::steady_clock::now();
-
   if (frame.can_id == quaternion_canid_) {
     auto x = (int16_t)(frame.data[0] << 8 | frame.data[1]) / 1e4;
     auto y = (int16_t)(frame.data[2] << 8 | frame.data[3]) / 1e4;
@@ -81,7 +89,7 @@ void CBoard::callback(const can_frame & frame)
       return;
     }
 
-    queue_.push({{w, x, y, z}, timestamp});
+    imu_history_.push({w, x, y, z}, timestamp);
   }
 
   else if (frame.can_id == bullet_speed_canid_) {
@@ -111,6 +119,20 @@ std::string CBoard::read_yaml(const std::string & config_path)
   quaternion_canid_ = tools::read<int>(yaml, "quaternion_canid");
   bullet_speed_canid_ = tools::read<int>(yaml, "bullet_speed_canid");
   send_canid_ = tools::read<int>(yaml, "send_canid");
+  send_rate_ = yaml["send_rate"] ? yaml["send_rate"].as<double>() : 500;
+
+  // 与回放相机共用同一份录像
+  if (yaml["camera_name"] && yaml["camera_name"].as<std::string>() == "replay") {
+    replay_imu_ = std::make_unique<ReplayIMU>(tools::read<std::string>(yaml, "replay_path"));
+    if (yaml["replay_mode"]) {
+      auto replay_mode = yaml["replay_mode"].as<std::string>();
+      auto it = std::find(MODES.begin(), MODES.end(), replay_mode);
+      if (it == MODES.end()) throw std::runtime_error("Unknow replay_mode: " + replay_mode + "!");
+      mode = Mode(it - MODES.begin());
+    } else {
+      mode = Mode::auto_aim;
+    }
+  }
 
   if (!yaml["can_interface"]) {
     throw std::runtime_error("Missing 'can_interface' in YAML configuration.");
@@ -5,13 +5,16 @@
 #include <chrono>
 #include <cmath>
 #include <functional>
+#include <memory>
 #include <string>
 #include <vector>
 
 #include "io/command.hpp"
+#include "io/replay/replay.hpp"
 #include "io/socketcan.hpp"
+#include "io/transmitter.hpp"
+#include "tools/imu_history.hpp"
 #include "tools/logger.hpp"
-#include "tools/thread_safe_queue.hpp"
 
 namespace io
 {
@@ -44,25 +47,25 @@ public:
 
   CBoard(const std::string & config_path);
 
+  // 不阻塞: timestamp晚于最新的IMU数据时按角速度外推
   Eigen::Quaterniond imu_at(std::chrono::steady_clock::time_point timestamp);
 
+  // 同imu_at(), 并返回外推标志与数据时效, 供调用者决定是否信任
+  tools::ImuHistory::Attitude attitude_at(std::chrono::steady_clock::time_point timestamp);
+
+  // 不阻塞: 只更新待发送的命令, 由发送线程按send_rate写出
   void send(Command command) const;
 
 private:
-  struct IMUData
-  {
-    Eigen::Quaterniond q;
-    std::chrono::steady_clock::time_point timestamp;
-  };
-
-  tools::ThreadSafeQueue<IMUData> queue_;  // 必须在can_之前初始化，否则存在死锁的可能
-  SocketCAN can_;
-  IMUData data_ahead_;
-  IMUData data_behind_;
+  tools::ImuHistory imu_history_;  // 必须在can_之前初始化，callback会写入
+  std::unique_ptr<SocketCAN> can_;
+  std::unique_ptr<ReplayIMU> replay_imu_;  // camera_name为replay时代替下位机
+  std::unique_ptr<Transmitter> tx_;        // 声明在can_之后, 保证先于can_析构
 
   int quaternion_canid_, bullet_speed_canid_, send_canid_;
+  double send_rate_;
 
-  void callback(const can_frame & frame);
+  void callback(const can_frame & frame, std::chrono::steady_clock::time_point timestamp);
 
   std::string read_yaml(const std::string & config_path);
 };
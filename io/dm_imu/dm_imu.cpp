@@ -14,12 +14,11 @@
 
 namespace io
 {
-DM_IMU::DM_IMU() : queue_(5000)
+DM_IMU::DM_IMU() : imu_history_(5000)
 {
   init_serial();
   rec_thread_ = std::thread(&DM_IMU::get_imu_data_thread, this);
-  queue_.pop(data_ahead_);
-  queue_.pop(data_behind_);
+  while (imu_history_.size() < 2) std::this_thread::sleep_for(std::chrono::milliseconds(1));
   tools::logger()->info("[DM_IMU] initialized");
 }
 
@@ -96,36 +95,30 @@ void DM_IMU::get_imu_data_thread()
                              Eigen::AngleAxisd(data.pitch * M_PI / 180, Eigen::Vector3d::UnitY()) *
                              Eigen::AngleAxisd(data.roll * M_PI / 180, Eigen::Vector3d::UnitX());
       q.normalize();
-      queue_.push({q, timestamp});
+      // 陀螺仪为机体系角速度(rad/s), 供外推使用
+      imu_history_.push(q, timestamp, Eigen::Vector3d(data.gyrox, data.gyroy, data.gyroz));
     } else {
       tools::logger()->info("[DM_IMU] failed to get correct data");
     }
   }
 }
 
+// 不消耗历史数据, 可在多个线程中并发调用
 Eigen::Quaterniond DM_IMU::imu_at(std::chrono::steady_clock::time_point timestamp)
 {
-  if (data_behind_.timestamp < timestamp) data_ahead_ = data_behind_;
-
-  while (true) {
-    queue_.pop(data_behind_);
-    if (data_behind_.timestamp > timestamp) break;
-    data_ahead_ = data_behind_;
-  }
+  return attitude_at(timestamp).q;
+}
 
-  Eigen::Quaterniond q_a = data_ahead_.q.normalized();
-  Eigen::Quaterniond q_b = data_behind_.q.normalized();
-  auto t_a = data_ahead_.timestamp;
-  auto t_b = data_behind_.timestamp;
-  auto t_c = timestamp;
-  std::chrono::duration<double> t_ab = t_b - t_a;
-  std::chrono::duration<double> t_ac = t_c - t_a;
+tools::ImuHistory::Attitude DM_IMU::attitude_at(std::chrono::steady_clock::time_point timestamp)
+{
+  auto attitude = imu_history_.attitude_at(timestamp);
 
-  // 四元数插值
-  auto k = t_ac / t_ab;
-  Eigen::Quaterniond q_c = q_a.slerp(k, q_b).normalized();
+  // 限制日志输出频率为1Hz
+  if (imu_history_.stale_warning_due(attitude, std::chrono::steady_clock::now())) {
+    tools::logger()->warn("[DM_IMU] IMU data is {:.1f}ms old, link lost?", attitude.age * 1e3);
+  }
 
-  return q_c;
+  return attitude;
 }
 
 }  // namespace io
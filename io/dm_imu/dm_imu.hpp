@@ -6,12 +6,14 @@
 
 #include <Eigen/Geometry>
 #include <array>
+#include <atomic>
+#include <chrono>
 #include <fstream>
 #include <initializer_list>
 #include <iostream>
 #include <thread>
 
-#include "tools/thread_safe_queue.hpp"
+#include "tools/imu_history.hpp"
 
 namespace io
 {
@@ -68,23 +70,20 @@ public:
   DM_IMU();
   ~DM_IMU();
 
+  // 不阻塞: timestamp晚于最新的IMU数据时按陀螺仪角速度外推
   Eigen::Quaterniond imu_at(std::chrono::steady_clock::time_point timestamp);
 
-private:
-  struct IMUData
-  {
-    Eigen::Quaterniond q;
-    std::chrono::steady_clock::time_point timestamp;
-  };
+  // 同imu_at(), 并返回外推标志与数据时效, 供调用者决定是否信任
+  tools::ImuHistory::Attitude attitude_at(std::chrono::steady_clock::time_point timestamp);
 
+private:
   void init_serial();
   void get_imu_data_thread();
 
   serial::Serial serial_;
   std::thread rec_thread_;
 
-  tools::ThreadSafeQueue<IMUData> queue_;
-  IMUData data_ahead_, data_behind_;
+  tools::ImuHistory imu_history_;
 
   std::atomic<bool> stop_thread_{false};
   IMU_Receive_Frame receive_data{};  //receive data frame
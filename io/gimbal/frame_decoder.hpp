@@ -0,0 +1,120 @@
+#ifndef IO__FRAME_DECODER_HPP
+#define IO__FRAME_DECODER_HPP
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "tools/crc.hpp"
+
+namespace io
+{
+// 串口字节流解帧器
+// Frame须以head[2] = {'S', 'P'}开头、以crc16结尾, 且为packed结构体
+// 每次喂入任意长度的字节, 解出其中所有通过CRC16校验的帧; 出错后逐字节重新寻找帧头
+template <typename Frame>
+class FrameDecoder
+{
+public:
+  FrameDecoder() : buffer_(BUFFER_SIZE), begin_(0), end_(0) {}
+
+  // 可直接写入的缓冲区, 写入n字节后调用commit(n), 省去一次拷贝
+  uint8_t * write_ptr(size_t & capacity)
+  {
+    compact();
+    capacity = buffer_.size() - end_;
+    return buffer_.data() + end_;
+  }
+
+  template <typename Handler>
+  void commit(size_t n, Handler && handler)
+  {
+    end_ += n;
+    parse(handler);
+  }
+
+  template <typename Handler>
+  void feed(const uint8_t * data, size_t size, Handler && handler)
+  {
+    while (size > 0) {
+      size_t capacity;
+      auto dst = write_ptr(capacity);
+      auto n = std::min(size, capacity);
+      std::memcpy(dst, data, n);
+      data += n;
+      size -= n;
+      commit(n, handler);
+    }
+  }
+
+  uint64_t frame_count() const { return frame_count_; }
+  uint64_t crc_errors() const { return crc_errors_; }
+  uint64_t discarded_bytes() const { return discarded_bytes_; }
+
+private:
+  static constexpr size_t FRAME_SIZE = sizeof(Frame);
+  static constexpr size_t BUFFER_SIZE = FRAME_SIZE * 64;
+
+  std::vector<uint8_t> buffer_;
+  size_t begin_, end_;  // 未解析的数据为[begin_, end_)
+
+  uint64_t frame_count_ = 0;
+  uint64_t crc_errors_ = 0;
+  uint64_t discarded_bytes_ = 0;
+
+  template <typename Handler>
+  void parse(Handler & handler)
+  {
+    while (end_ - begin_ >= 2) {
+      // 寻找帧头
+      auto data = buffer_.data();
+      auto p = static_cast<uint8_t *>(std::memchr(data + begin_, 'S', end_ - begin_));
+      if (p == nullptr) {
+        discard(end_ - begin_);
+        return;
+      }
+      discard(p - (data + begin_));
+
+      if (end_ - begin_ < 2) return;
+      if (data[begin_ + 1] != 'P') {
+        discard(1);
+        continue;
+      }
+
+      // 等待完整的帧
+      if (end_ - begin_ < FRAME_SIZE) return;
+
+      if (!tools::check_crc16(data + begin_, FRAME_SIZE)) {
+        crc_errors_++;
+        discard(1);
+        continue;
+      }
+
+      Frame frame;
+      std::memcpy(&frame, data + begin_, FRAME_SIZE);
+      begin_ += FRAME_SIZE;
+      frame_count_++;
+      handler(frame);
+    }
+  }
+
+  void discard(size_t n)
+  {
+    begin_ += n;
+    discarded_bytes_ += n;
+  }
+
+  // 把未解析的数据移到缓冲区开头, 剩余不足一帧, 拷贝量很小
+  void compact()
+  {
+    if (begin_ == 0) return;
+    std::memmove(buffer_.data(), buffer_.data() + begin_, end_ - begin_);
+    end_ -= begin_;
+    begin_ = 0;
+  }
+};
+
+}  // namespace io
+
+#endif  // IO__FRAME_DECODER_HPP
@@ -1,5 +1,9 @@
 #include "gimbal.hpp"
 
+#include <cstddef>
+#include <cstring>
+#include <type_traits>
+
 #include "tools/crc.hpp"
 #include "tools/logger.hpp"
 #include "tools/math_tools.hpp"
@@ -7,22 +11,53 @@
 
 namespace io
 {
+// 等待数据的超时时间, 连续MAX_ERROR_COUNT次没有数据则重连
+constexpr uint32_t READ_TIMEOUT_MS = 100;
+constexpr int MAX_ERROR_COUNT = 10;
+
+// 扩展帧在原有帧的crc16处追加字段, 之前的部分布局相同
+static_assert(offsetof(VisionToGimbalSeq, seq) == offsetof(VisionToGimbal, crc16));
+
 Gimbal::Gimbal(const std::string & config_path)
 {
   auto yaml = tools::load(config_path);
   auto com_port = tools::read<std::string>(yaml, "com_port");
+  command_echo_ = yaml["command_echo"] ? yaml["command_echo"].as<bool>() : false;
 
   try {
     serial_.setPort(com_port);
+    serial::Timeout timeout = serial::Timeout::simpleTimeout(READ_TIMEOUT_MS);
+    serial_.setTimeout(timeout);
     serial_.open();
   } catch (const std::exception & e) {
     tools::logger()->error("[Gimbal] Failed to open serial: {}", e.what());
     exit(1);
   }
 
-  thread_ = std::thread(&Gimbal::read_thread, this);
+  auto send_rate = yaml["send_rate"] ? yaml["send_rate"].as<double>() : 500;
+  tx_ = std::make_unique<Transmitter>(
+    "Gimbal", send_rate, [this](const uint8_t * data, size_t size) {
+      on_written(data, size);
+      if (serial_.write(data, size) != size) throw std::runtime_error("Incomplete write!");
+    });
+
+  if (command_echo_)
+    thread_ = std::thread([this] { read_thread(echo_decoder_); });
+  else
+    thread_ = std::thread([this] { read_thread(decoder_); });
 
-  queue_.pop();
+  // 帧格式与下位机不一致时每帧都无法通过校验, 定时提示
+  auto wait_start = std::chrono::steady_clock::now();
+  auto last_warn_time = wait_start;
+  while (imu_history_.size() == 0) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    auto now = std::chrono::steady_clock::now();
+    if (tools::delta_time(now, last_warn_time) < 1.0) continue;
+    tools::logger()->warn(
+      "[Gimbal] No valid frame in {:.0f}s, does command_echo ({}) match the firmware?",
+      tools::delta_time(now, wait_start), command_echo_);
+    last_warn_time = now;
+  }
   tools::logger()->info("[Gimbal] First q received.");
 }
 
@@ -30,6 +65,7 @@ Gimbal::~Gimbal()
 {
   quit_ = true;
   if (thread_.joinable()) thread_.join();
+  tx_.reset();
   serial_.close();
 }
 
@@ -63,140 +99,198 @@ std::string Gimbal::str(GimbalMode mode) const //未调用
 
 Eigen::Quaterniond Gimbal::q(std::chrono::steady_clock::time_point t)// 外部调用
 {
-  while (true) {
-    auto [q_a, t_a] = queue_.pop();
-    auto [q_b, t_b] = queue_.front();
-    auto t_ab = tools::delta_time(t_a, t_b);
-    auto t_ac = tools::delta_time(t_a, t);
-    auto k = t_ac / t_ab;
-    Eigen::Quaterniond q_c = q_a.slerp(k, q_b).normalized();
-    if (t < t_a) return q_c;
-    if (!(t_a < t && t <= t_b)) continue;
-
-    return q_c;
-  }
+  return attitude_at(t).q;
 }
 
-void Gimbal::send(io::VisionToGimbal VisionToGimbal) //未调用
+tools::ImuHistory::Attitude Gimbal::attitude_at(std::chrono::steady_clock::time_point t)
 {
-  tx_data_.mode = VisionToGimbal.mode;
-  tx_data_.yaw = VisionToGimbal.yaw;
-  tx_data_.yaw_vel = VisionToGimbal.yaw_vel;
-  tx_data_.yaw_acc = VisionToGimbal.yaw_acc;
-  tx_data_.pitch = VisionToGimbal.pitch;
-  tx_data_.pitch_vel = VisionToGimbal.pitch_vel;
-  tx_data_.pitch_acc = VisionToGimbal.pitch_acc;
-  tx_data_.crc16 = tools::get_crc16(
-    reinterpret_cast<uint8_t *>(&tx_data_), sizeof(tx_data_) - sizeof(tx_data_.crc16));
+  auto attitude = imu_history_.attitude_at(t);
 
-  try {
-    serial_.write(reinterpret_cast<uint8_t *>(&tx_data_), sizeof(tx_data_));
-  } catch (const std::exception & e) {
-    tools::logger()->warn("[Gimbal] Failed to write serial: {}", e.what());
+  // 限制日志输出频率为1Hz
+  if (imu_history_.stale_warning_due(attitude, std::chrono::steady_clock::now())) {
+    tools::logger()->warn("[Gimbal] q is {:.1f}ms old, link lost?", attitude.age * 1e3);
   }
+
+  return attitude;
+}
+
+void Gimbal::send(io::VisionToGimbal VisionToGimbal) //未调用
+{
+  publish(VisionToGimbal);
 }
 
 void Gimbal::send(
   bool control, bool fire, float yaw, float yaw_vel, float yaw_acc, float pitch, float pitch_vel,
   float pitch_acc)
 {
-  tx_data_.mode = control ? (fire ? 2 : 1) : 0;
-  tx_data_.yaw = yaw;
-  tx_data_.yaw_vel = yaw_vel;
-  tx_data_.yaw_acc = yaw_acc;
-  tx_data_.pitch = pitch;
-  tx_data_.pitch_vel = pitch_vel;
-  tx_data_.pitch_acc = pitch_acc;
-  tx_data_.crc16 = tools::get_crc16(
-    reinterpret_cast<uint8_t *>(&tx_data_), sizeof(tx_data_) - sizeof(tx_data_.crc16));
+  VisionToGimbal command;
+  command.mode = control ? (fire ? 2 : 1) : 0;
+  command.yaw = yaw;
+  command.yaw_vel = yaw_vel;
+  command.yaw_acc = yaw_acc;
+  command.pitch = pitch;
+  command.pitch_vel = pitch_vel;
+  command.pitch_acc = pitch_acc;
+  publish(command);
+}
 
-  try {
-    serial_.write(reinterpret_cast<uint8_t *>(&tx_data_), sizeof(tx_data_));
-  } catch (const std::exception & e) {
-    tools::logger()->warn("[Gimbal] Failed to write serial: {}", e.what());
+const tools::LatencyHistogram * Gimbal::command_latency() const
+{
+  return command_echo_ ? &command_latency_ : nullptr;
+}
+
+const tools::LatencyHistogram * Gimbal::round_trip() const
+{
+  return command_echo_ ? &round_trip_ : nullptr;
+}
+
+void Gimbal::publish(const VisionToGimbal & command)
+{
+  if (!command_echo_) {
+    auto tx_data = command;
+    tx_data.crc16 = tools::get_crc16(
+      reinterpret_cast<uint8_t *>(&tx_data), sizeof(tx_data) - sizeof(tx_data.crc16));
+    tx_->publish(&tx_data, sizeof(tx_data));
+    return;
   }
+
+  std::lock_guard<std::mutex> lock(record_mutex_);
+
+  // 只有内容变化时才换新序号, 使重复的命令逐字节相同, 可被发送线程跳过
+  auto begin = offsetof(VisionToGimbalSeq, mode), end = offsetof(VisionToGimbalSeq, seq);
+  auto src = reinterpret_cast<const uint8_t *>(&command);
+  auto dst = reinterpret_cast<uint8_t *>(&tx_data_);
+  if (std::memcmp(src + begin, dst + begin, end - begin) != 0) {
+    std::memcpy(dst + begin, src + begin, end - begin);
+    tx_data_.seq = tx_data_.seq == UINT16_MAX ? 1 : tx_data_.seq + 1;
+    tx_data_.crc16 = tools::get_crc16(dst, sizeof(tx_data_) - sizeof(tx_data_.crc16));
+    records_[tx_data_.seq % RECORD_NUM] = {tx_data_.seq, std::chrono::steady_clock::now(), {}};
+  }
+
+  tx_->publish(&tx_data_, sizeof(tx_data_));
 }
 
-bool Gimbal::read(uint8_t * buffer, size_t size)
+// 在发送线程中、写串口之前调用
+void Gimbal::on_written(const uint8_t * data, size_t size)
 {
-  try {
-    return serial_.read(buffer, size) == size;
-  } catch (const std::exception & e) {
-    // tools::logger()->warn("[Gimbal] Failed to read serial: {}", e.what());
-    return false;
+  if (!command_echo_ || size != sizeof(VisionToGimbalSeq)) return;
+  uint16_t seq;
+  std::memcpy(&seq, data + offsetof(VisionToGimbalSeq, seq), sizeof(seq));
+
+  std::lock_guard<std::mutex> lock(record_mutex_);
+  auto & record = records_[seq % RECORD_NUM];
+  // 保活重发时保留第一次写出的时刻
+  if (record.seq == seq && record.written.time_since_epoch().count() == 0)
+    record.written = std::chrono::steady_clock::now();
+}
+
+// 往返时间 = 收到回传的时刻 - 写出时刻 - 下位机持有该命令的时间, 假设上下行对称
+// 命令延迟 = 发送线程排队时间 + 往返时间 / 2
+void Gimbal::on_echo(const GimbalToVisionEcho & rx_data, std::chrono::steady_clock::time_point t)
+{
+  // 每条命令只统计第一次回传, 之后的帧echo_age会继续增大, 与第一次等价
+  if (rx_data.echo_seq == 0 || rx_data.echo_seq == last_echo_seq_) return;
+  last_echo_seq_ = rx_data.echo_seq;
+
+  CommandRecord record;
+  {
+    std::lock_guard<std::mutex> lock(record_mutex_);
+    record = records_[rx_data.echo_seq % RECORD_NUM];
   }
+  if (record.seq != rx_data.echo_seq || record.written.time_since_epoch().count() == 0) return;
+
+  auto rtt = tools::delta_time(t, record.written) - rx_data.echo_age * 1e-4;
+  if (rtt < 0) return;
+
+  round_trip_.add(rtt);
+  command_latency_.add(tools::delta_time(record.written, record.published) + rtt / 2);
 }
 
-void Gimbal::read_thread()
+template <typename Frame>
+void Gimbal::read_thread(FrameDecoder<Frame> & decoder)
 {
   tools::logger()->info("[Gimbal] read_thread started.");
   int error_count = 0;
+  uint64_t last_crc_errors = 0;
 
   while (!quit_) {
-    if (error_count > 5000) {
+    if (error_count > MAX_ERROR_COUNT) {
       error_count = 0;
       tools::logger()->warn("[Gimbal] Too many errors, attempting to reconnect...");
       reconnect();
       continue;
     }
 
-    if (!read(reinterpret_cast<uint8_t *>(&rx_data_), sizeof(rx_data_.head))) {
+    // 阻塞等待数据, 一次读出所有可读的字节
+    size_t n;
+    try {
+      if (!serial_.waitReadable()) {
+        error_count++;
+        continue;
+      }
+
+      auto t = std::chrono::steady_clock::now();
+      size_t capacity;
+      auto buffer = decoder.write_ptr(capacity);
+      n = serial_.read(buffer, std::min(std::max<size_t>(serial_.available(), 1), capacity));
+      decoder.commit(n, [this, t](const Frame & rx_data) { handle(rx_data, t); });
+    } catch (const std::exception & e) {
+      // tools::logger()->warn("[Gimbal] Failed to read serial: {}", e.what());
       error_count++;
       continue;
     }
 
-    if (rx_data_.head[0] != 'S' || rx_data_.head[1] != 'P') continue;
-
-    auto t = std::chrono::steady_clock::now();
-
-    if (!read(
-          reinterpret_cast<uint8_t *>(&rx_data_) + sizeof(rx_data_.head),
-          sizeof(rx_data_) - sizeof(rx_data_.head))) {
+    if (n == 0) {
       error_count++;
       continue;
     }
+    error_count = 0;
 
-    if (!tools::check_crc16(reinterpret_cast<uint8_t *>(&rx_data_), sizeof(rx_data_))) {
+    if (decoder.crc_errors() != last_crc_errors) {
       tools::logger()->debug("[Gimbal] CRC16 check failed.");
-      continue;
-    }
-
-    error_count = 0;
-    Eigen::Quaterniond q(rx_data_.q[0], rx_data_.q[1], rx_data_.q[2], rx_data_.q[3]);
-    queue_.push({q, t});
-
-    std::lock_guard<std::mutex> lock(mutex_);
-
-    state_.yaw = rx_data_.yaw;
-    state_.yaw_vel = rx_data_.yaw_vel;
-    state_.pitch = rx_data_.pitch;
-    state_.pitch_vel = rx_data_.pitch_vel;
-    state_.bullet_speed = rx_data_.bullet_speed;
-    state_.bullet_count = rx_data_.bullet_count;
-
-    switch (rx_data_.mode) {
-      case 0:
-        mode_ = GimbalMode::IDLE;
-        break;
-      case 1:
-        mode_ = GimbalMode::AUTO_AIM;
-        break;
-      case 2:
-        mode_ = GimbalMode::SMALL_BUFF;
-        break;
-      case 3:
-        mode_ = GimbalMode::BIG_BUFF;
-        break;
-      default:
-        mode_ = GimbalMode::IDLE;
-        tools::logger()->warn("[Gimbal] Invalid mode: {}", rx_data_.mode);
-        break;
+      last_crc_errors = decoder.crc_errors();
     }
   }
 
   tools::logger()->info("[Gimbal] read_thread stopped.");
 }
 
+template <typename Frame>
+void Gimbal::handle(const Frame & rx_data, std::chrono::steady_clock::time_point t)
+{
+  Eigen::Quaterniond q(rx_data.q[0], rx_data.q[1], rx_data.q[2], rx_data.q[3]);
+  imu_history_.push(q, t);
+  if constexpr (std::is_same_v<Frame, GimbalToVisionEcho>) on_echo(rx_data, t);
+
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  state_.yaw = rx_data.yaw;
+  state_.yaw_vel = rx_data.yaw_vel;
+  state_.pitch = rx_data.pitch;
+  state_.pitch_vel = rx_data.pitch_vel;
+  state_.bullet_speed = rx_data.bullet_speed;
+  state_.bullet_count = rx_data.bullet_count;
+
+  switch (rx_data.mode) {
+    case 0:
+      mode_ = GimbalMode::IDLE;
+      break;
+    case 1:
+      mode_ = GimbalMode::AUTO_AIM;
+      break;
+    case 2:
+      mode_ = GimbalMode::SMALL_BUFF;
+      break;
+    case 3:
+      mode_ = GimbalMode::BIG_BUFF;
+      break;
+    default:
+      mode_ = GimbalMode::IDLE;
+      tools::logger()->warn("[Gimbal] Invalid mode: {}", rx_data.mode);
+      break;
+  }
+}
+
 void Gimbal::reconnect()
 {
   int max_retry_count = 10;
@@ -210,7 +304,6 @@ void Gimbal::reconnect()
 
     try {
       serial_.open();  // 尝试重新打开
-      queue_.clear();
       tools::logger()->info("[Gimbal] Reconnected serial successfully.");
       break;
     } catch (const std::exception & e) {
@@ -4,13 +4,16 @@
 #include <Eigen/Geometry>
 #include <atomic>
 #include <chrono>
+#include <memory>
 #include <mutex>
 #include <string>
 #include <thread>
-#include <tuple>
 
+#include "io/gimbal/frame_decoder.hpp"
+#include "io/transmitter.hpp"
+#include "tools/latency_histogram.hpp"
 #include "serial/serial.h"
-#include "tools/thread_safe_queue.hpp"
+#include "tools/imu_history.hpp"
 
 namespace io
 {
@@ -30,6 +33,25 @@ struct __attribute__((packed)) GimbalToVision
 
 static_assert(sizeof(GimbalToVision) <= 64);
 
+// 回传命令序号的扩展帧, 配置command_echo: true时使用, 需下位机同时支持
+struct __attribute__((packed)) GimbalToVisionEcho
+{
+  uint8_t head[2] = {'S', 'P'};
+  uint8_t mode;  // 0: 空闲, 1: 自瞄, 2: 小符, 3: 大符
+  float q[4];    // wxyz顺序
+  float yaw;
+  float yaw_vel;
+  float pitch;
+  float pitch_vel;
+  float bullet_speed;
+  uint16_t bullet_count;  // 子弹累计发送次数
+  uint16_t echo_seq;      // 最近收到的VisionToGimbalSeq::seq, 0表示还没有收到
+  uint16_t echo_age;      // 收到该命令至发出本帧经过的时间, 单位0.1ms
+  uint16_t crc16;
+};
+
+static_assert(sizeof(GimbalToVisionEcho) <= 64);
+
 struct __attribute__((packed)) VisionToGimbal
 {
   uint8_t head[2] = {'S', 'P'};
@@ -45,6 +67,23 @@ struct __attribute__((packed)) VisionToGimbal
 
 static_assert(sizeof(VisionToGimbal) <= 64);
 
+// 带命令序号的扩展帧, 与GimbalToVisionEcho配套
+struct __attribute__((packed)) VisionToGimbalSeq
+{
+  uint8_t head[2] = {'S', 'P'};
+  uint8_t mode;  // 0: 不控制, 1: 控制云台但不开火，2: 控制云台且开火
+  float yaw;
+  float yaw_vel;
+  float yaw_acc;
+  float pitch;
+  float pitch_vel;
+  float pitch_acc;
+  uint16_t seq;  // 命令序号, 命令内容变化时加1, 跳过0
+  uint16_t crc16;
+};
+
+static_assert(sizeof(VisionToGimbalSeq) <= 64);
+
 enum class GimbalMode
 {
   IDLE,        // 空闲
@@ -73,31 +112,65 @@ public:
   GimbalMode mode() const;
   GimbalState state() const;
   std::string str(GimbalMode mode) const;
+  // 不阻塞: t晚于最新数据时按角速度外推
   Eigen::Quaterniond q(std::chrono::steady_clock::time_point t);
 
+  // 同q(), 并返回外推标志与数据时效, 供调用者决定是否信任
+  tools::ImuHistory::Attitude attitude_at(std::chrono::steady_clock::time_point t);
+
+  // 不阻塞: 只更新待发送的命令, 由发送线程按send_rate写出
   void send(
     bool control, bool fire, float yaw, float yaw_vel, float yaw_acc, float pitch, float pitch_vel,
     float pitch_acc);
 
   void send(io::VisionToGimbal VisionToGimbal);
 
+  // 命令从send()到被云台收到的延迟, 未启用command_echo时返回nullptr
+  const tools::LatencyHistogram * command_latency() const;
+
+  // 串口往返时间(不含下位机处理时间与发送排队), 未启用command_echo时返回nullptr
+  const tools::LatencyHistogram * round_trip() const;
+
 private:
+  // 记录每条命令的发出时刻, 用于匹配回传的序号
+  struct CommandRecord
+  {
+    uint16_t seq = 0;
+    std::chrono::steady_clock::time_point published, written;
+  };
+  static constexpr size_t RECORD_NUM = 64;
+
   serial::Serial serial_;
 
   std::thread thread_;
   std::atomic<bool> quit_ = false;
   mutable std::mutex mutex_;
 
-  GimbalToVision rx_data_;
-  VisionToGimbal tx_data_;
+  // 默认使用原有的帧格式, command_echo为true时收发扩展帧
+  bool command_echo_;
+  FrameDecoder<GimbalToVision> decoder_;
+  FrameDecoder<GimbalToVisionEcho> echo_decoder_;
+  VisionToGimbalSeq tx_data_{};
+  std::unique_ptr<Transmitter> tx_;
+
+  std::mutex record_mutex_;
+  CommandRecord records_[RECORD_NUM];
+  uint16_t last_echo_seq_ = 0;
+  tools::LatencyHistogram command_latency_, round_trip_;
 
   GimbalMode mode_ = GimbalMode::IDLE;
   GimbalState state_;
-  tools::ThreadSafeQueue<std::tuple<Eigen::Quaterniond, std::chrono::steady_clock::time_point>>
-    queue_{1000};
+  tools::ImuHistory imu_history_{1000};
+
+  void publish(const VisionToGimbal & command);
+  void on_written(const uint8_t * data, size_t size);
+  void on_echo(const GimbalToVisionEcho & rx_data, std::chrono::steady_clock::time_point t);
+
+  template <typename Frame>
+  void read_thread(FrameDecoder<Frame> & decoder);
 
-  bool read(uint8_t * buffer, size_t size);
-  void read_thread();
+  template <typename Frame>
+  void handle(const Frame & rx_data, std::chrono::steady_clock::time_point t);
   void reconnect();
 };
 
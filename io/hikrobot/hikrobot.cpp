@@ -3,13 +3,19 @@
 #include <libusb-1.0/libusb.h>
 
 #include "tools/logger.hpp"
+#include "tools/math_tools.hpp"
 
 using namespace std::chrono_literals;
 
 namespace io
 {
+// 信箱(1) + 主循环持有(1) + 录像/调试等(若干), 留足余量
+constexpr size_t FRAME_POOL_SIZE = 8;
+// 每多少帧打印一次取图统计
+constexpr size_t STATS_INTERVAL = 1500;
+
 HikRobot::HikRobot(double exposure_ms, double gain, const std::string & vid_pid)
-: exposure_us_(exposure_ms * 1e3), gain_(gain), queue_(1), daemon_quit_(false), vid_(-1), pid_(-1)
+: exposure_us_(exposure_ms * 1e3), gain_(gain), pool_(FRAME_POOL_SIZE), daemon_quit_(false), vid_(-1), pid_(-1)
 {
   set_vid_pid(vid_pid);
   if (libusb_init(NULL)) tools::logger()->warn("Unable to init libusb!");
@@ -42,15 +48,6 @@ HikRobot::~HikRobot()
   tools::logger()->info("HikRobot destructed.");
 }
 
-void HikRobot::read(cv::Mat & img, std::chrono::steady_clock::time_point & timestamp)
-{
-  CameraData data;
-  queue_.pop(data);
-
-  img = data.img;
-  timestamp = data.timestamp;
-}
-
 void HikRobot::capture_start()
 {
   capturing_ = false;
@@ -101,14 +98,23 @@ void HikRobot::capture_start()
     capturing_ = true;
 
     MV_FRAME_OUT raw;
-    MV_CC_PIXEL_CONVERT_PARAM cvt_param;
 
-    while (!capture_quit_) {
-      std::this_thread::sleep_for(1ms);
+    const static std::unordered_map<MvGvspPixelType, BayerPattern> type_map = {
+      {PixelType_Gvsp_BayerGR8, BayerPattern::GRBG},
+      {PixelType_Gvsp_BayerRG8, BayerPattern::RGGB},
+      {PixelType_Gvsp_BayerGB8, BayerPattern::GBRG},
+      {PixelType_Gvsp_BayerBG8, BayerPattern::BGGR}};
+
+    // 取图统计: 取到图像 -> 发布到信箱 的耗时
+    size_t frame_count = 0;
+    size_t last_exhausted = pool_.exhausted();
+    double latency_sum_ms = 0, latency_max_ms = 0;
 
+    while (!capture_quit_) {
       unsigned int ret;
       unsigned int nMsec = 100;
 
+      // 阻塞等待新帧, 无需额外sleep
       ret = MV_CC_GetImageBuffer(handle_, &raw, nMsec);
       if (ret != MV_OK) {
         tools::logger()->warn("MV_CC_GetImageBuffer failed: {:#x}", ret);
@@ -116,34 +122,37 @@ void HikRobot::capture_start()
       }
 
       auto timestamp = std::chrono::steady_clock::now();
-      cv::Mat img(cv::Size(raw.stFrameInfo.nWidth, raw.stFrameInfo.nHeight), CV_8U, raw.pBufAddr);
-
-      cvt_param.nWidth = raw.stFrameInfo.nWidth;
-      cvt_param.nHeight = raw.stFrameInfo.nHeight;
+      const auto & frame_info = raw.stFrameInfo;
+      cv::Mat raw_img(cv::Size(frame_info.nWidth, frame_info.nHeight), CV_8U, raw.pBufAddr);
 
-      cvt_param.pSrcData = raw.pBufAddr;
-      cvt_param.nSrcDataLen = raw.stFrameInfo.nFrameLen;
-      cvt_param.enSrcPixelType = raw.stFrameInfo.enPixelType;
+      // 只把Bayer原图拷贝到池中的缓冲, 解马赛克推迟到消费者按需进行
+      cv::Mat img;
+      pool_.acquire(frame_info.nHeight, frame_info.nWidth, CV_8U, img);
+      raw_img.copyTo(img);
 
-      cvt_param.pDstBuffer = img.data;
-      cvt_param.nDstBufferSize = img.total() * img.elemSize();
-      cvt_param.enDstPixelType = PixelType_Gvsp_BGR8_Packed;
+      ret = MV_CC_FreeImageBuffer(handle_, &raw);
 
-      // ret = MV_CC_ConvertPixelType(handle_, &cvt_param);
-      const auto & frame_info = raw.stFrameInfo;
-      auto pixel_type = frame_info.enPixelType;
-      cv::Mat dst_image;
-      const static std::unordered_map<MvGvspPixelType, cv::ColorConversionCodes> type_map = {
-        {PixelType_Gvsp_BayerGR8, cv::COLOR_BayerGR2RGB},
-        {PixelType_Gvsp_BayerRG8, cv::COLOR_BayerRG2RGB},
-        {PixelType_Gvsp_BayerGB8, cv::COLOR_BayerGB2RGB},
-        {PixelType_Gvsp_BayerBG8, cv::COLOR_BayerBG2RGB}};
-      cv::cvtColor(img, dst_image, type_map.at(pixel_type));
-      img = dst_image;
-
-      queue_.push({img, timestamp});
+      publish(img, timestamp, type_map.at(frame_info.enPixelType));
+
+      auto latency_ms = tools::delta_time(std::chrono::steady_clock::now(), timestamp) * 1e3;
+      latency_sum_ms += latency_ms;
+      latency_max_ms = std::max(latency_max_ms, latency_ms);
+
+      if (++frame_count == STATS_INTERVAL) {
+        auto exhausted = pool_.exhausted() - last_exhausted;
+        tools::logger()->debug(
+          "[HikRobot] capture->publish avg {:.2f}ms max {:.2f}ms, pool exhausted {}/{}",
+          latency_sum_ms / frame_count, latency_max_ms, exhausted, frame_count);
+        if (exhausted > 0)
+          tools::logger()->warn(
+            "[HikRobot] Frame pool ({}) exhausted {} times, consumers hold frames too long.",
+            pool_.capacity(), exhausted);
+
+        frame_count = 0;
+        last_exhausted = pool_.exhausted();
+        latency_sum_ms = latency_max_ms = 0;
+      }
 
-      ret = MV_CC_FreeImageBuffer(handle_, &raw);
       if (ret != MV_OK) {
         tools::logger()->warn("MV_CC_FreeImageBuffer failed: {:#x}", ret);
         break;
@@ -9,7 +9,7 @@
 
 #include "MvCameraControl.h"
 #include "io/camera.hpp"
-#include "tools/thread_safe_queue.hpp"
+#include "tools/frame_pool.hpp"
 
 namespace io
 {
@@ -18,15 +18,8 @@ class HikRobot : public CameraBase
 public:
   HikRobot(double exposure_ms, double gain, const std::string & vid_pid);
   ~HikRobot() override;
-  void read(cv::Mat & img, std::chrono::steady_clock::time_point & timestamp) override;
 
 private:
-  struct CameraData
-  {
-    cv::Mat img;
-    std::chrono::steady_clock::time_point timestamp;
-  };
-
   double exposure_us_;
   double gain_;
 
@@ -37,7 +30,7 @@ private:
   std::thread capture_thread_;
   std::atomic<bool> capturing_;
   std::atomic<bool> capture_quit_;
-  tools::ThreadSafeQueue<CameraData> queue_;
+  tools::FramePool pool_;
 
   int vid_, pid_;
 
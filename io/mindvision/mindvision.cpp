@@ -16,7 +16,6 @@ MindVision::MindVision(double exposure_ms, double gamma, const std::string & vid
   handle_(-1),
   quit_(false),
   ok_(false),
-  queue_(1),
   vid_(-1),
   pid_(-1)
 {
@@ -50,15 +49,6 @@ MindVision::~MindVision()
   tools::logger()->info("Mindvision destructed.");
 }
 
-void MindVision::read(cv::Mat & img, std::chrono::steady_clock::time_point & timestamp)
-{
-  CameraData data;
-  queue_.pop(data);
-
-  img = data.img;
-  timestamp = data.timestamp;
-}
-
 void MindVision::open()
 {
   int camera_num = 1;
@@ -108,7 +98,7 @@ void MindVision::open()
       CameraImageProcess(handle_, raw, img.data, &head);
       CameraReleaseImageBuffer(handle_, raw);
 
-      queue_.push({img, timestamp});
+      publish(img, timestamp);
     }
   }};
 
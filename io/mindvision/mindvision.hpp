@@ -7,7 +7,6 @@
 
 #include "CameraApi.h"
 #include "io/camera.hpp"
-#include "tools/thread_safe_queue.hpp"
 
 namespace io
 {
@@ -16,22 +15,14 @@ class MindVision : public CameraBase
 public:
   MindVision(double exposure_ms, double gamma, const std::string & vid_pid);
   ~MindVision() override;
-  void read(cv::Mat & img, std::chrono::steady_clock::time_point & timestamp) override;
 
 private:
-  struct CameraData
-  {
-    cv::Mat img;
-    std::chrono::steady_clock::time_point timestamp;
-  };
-
   double exposure_ms_, gamma_;
   CameraHandle handle_;
   int height_, width_;
   bool quit_, ok_;
   std::thread capture_thread_;
   std::thread daemon_thread_;
-  tools::ThreadSafeQueue<CameraData> queue_;
   int vid_, pid_;
 
   void open();
@@ -0,0 +1,130 @@
+#include "replay.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <stdexcept>
+
+#include "tools/logger.hpp"
+
+using namespace std::chrono_literals;
+
+namespace io
+{
+namespace
+{
+struct ReplayRecord
+{
+  double t;
+  Eigen::Quaterniond q;
+};
+
+std::vector<ReplayRecord> load_records(const std::string & text_path)
+{
+  std::ifstream text(text_path);
+  if (!text.is_open()) throw std::runtime_error("Unable to open " + text_path + "!");
+
+  std::vector<ReplayRecord> records;
+  double t, w, x, y, z;
+  while (text >> t >> w >> x >> y >> z) records.push_back({t, {w, x, y, z}});
+
+  if (records.empty()) throw std::runtime_error("Empty replay record: " + text_path + "!");
+  return records;
+}
+
+std::atomic<std::chrono::steady_clock::time_point> & start_time()
+{
+  static std::atomic<std::chrono::steady_clock::time_point> start_time{
+    std::chrono::steady_clock::now()};
+  return start_time;
+}
+
+std::chrono::steady_clock::duration to_duration(double t)
+{
+  return std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+    std::chrono::duration<double>(t));
+}
+
+}  // namespace
+
+std::chrono::steady_clock::time_point replay_start_time() { return start_time(); }
+
+Replay::Replay(const std::string & path, bool realtime) : realtime_(realtime), quit_(false)
+{
+  for (const auto & record : load_records(path + ".txt")) times_.push_back(record.t);
+
+  video_.open(path + ".avi");
+  if (!video_.isOpened()) throw std::runtime_error("Unable to open " + path + ".avi!");
+
+  tools::logger()->info(
+    "[Replay] {} frames from {}, {}.", times_.size(), path,
+    realtime ? "realtime" : "as fast as read");
+
+  // 回放线程
+  play_thread_ = std::thread{[this] {
+    // 第一帧对应现在, IMU替身据此查询同一时间轴上的姿态
+    start_time() = std::chrono::steady_clock::now() - to_duration(times_[0]);
+
+    for (size_t i = 0; i < times_.size() && !quit_; i++) {
+      cv::Mat img;
+      if (!video_.read(img)) break;
+
+      auto record_time = replay_start_time() + to_duration(times_[i]);
+      if (realtime_) {
+        // 等到录制时的节奏, 析构时立即醒来
+        std::unique_lock<std::mutex> lock(quit_mutex_);
+        if (quit_cv_.wait_until(lock, record_time, [this] { return quit_.load(); })) break;
+      } else {
+        // 等上一帧被读走, 定时醒来检查是否退出
+        while (!quit_ && !wait_until_read(100ms)) continue;
+        if (quit_) break;
+      }
+
+      publish(img, realtime_ ? std::chrono::steady_clock::now() : record_time);
+    }
+
+    // 通知消费者不会再有新帧
+    close();
+    tools::logger()->info("[Replay] Finished.");
+  }};
+}
+
+Replay::~Replay()
+{
+  {
+    std::lock_guard<std::mutex> lock(quit_mutex_);
+    quit_ = true;
+  }
+  quit_cv_.notify_all();
+  if (play_thread_.joinable()) play_thread_.join();
+  tools::logger()->info("Replay destructed.");
+}
+
+ReplayIMU::ReplayIMU(const std::string & path)
+{
+  for (const auto & record : load_records(path + ".txt")) {
+    times_.push_back(record.t);
+    qs_.push_back(record.q.normalized());
+  }
+  tools::logger()->info("[ReplayIMU] {} quaternions from {}.", qs_.size(), path);
+}
+
+// 球面线性插值（SLERP）, 超出录制范围时取端点
+Eigen::Quaterniond ReplayIMU::imu_at(std::chrono::steady_clock::time_point timestamp) const
+{
+  // 回放开始时间在回放线程中确定, 每次查询时换算到录制的时间轴
+  std::chrono::duration<double> since_start = timestamp - replay_start_time();
+  auto t = since_start.count();
+
+  auto it = std::upper_bound(times_.begin(), times_.end(), t);
+  if (it == times_.begin()) return qs_.front();
+  if (it == times_.end()) return qs_.back();
+
+  auto i = it - times_.begin();
+  auto t_ab = times_[i] - times_[i - 1];
+  auto t_ac = t - times_[i - 1];
+  if (t_ab <= 0) return qs_[i];
+
+  return qs_[i - 1].slerp(t_ac / t_ab, qs_[i]).normalized();
+}
+
+}  // namespace io
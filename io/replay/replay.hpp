@@ -0,0 +1,57 @@
+#ifndef IO__REPLAY_HPP
+#define IO__REPLAY_HPP
+
+#include <Eigen/Geometry>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <opencv2/opencv.hpp>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "io/camera.hpp"
+
+namespace io
+{
+// 回放时间轴的起点(录制时刻0对应的时间), 回放相机与IMU替身共用, 保证两者的时间戳一致
+// 回放线程开始时重新设置, 使第一帧对应开始回放的时刻
+std::chrono::steady_clock::time_point replay_start_time();
+
+// 回放tools::Recorder录制的records/*.avi + *.txt
+// path不含扩展名, txt每行为"t w x y z", t为录制开始后的秒数, 与视频帧一一对应
+class Replay : public CameraBase
+{
+public:
+  // realtime为true时按录制时的节奏发布, 时间戳为实际发布的时刻
+  // 否则等消费者读走上一帧后立即发布下一帧, 时间戳为录制时的时刻
+  // 回放结束后read()返回false
+  Replay(const std::string & path, bool realtime);
+  ~Replay() override;
+
+private:
+  cv::VideoCapture video_;
+  std::vector<double> times_;
+  bool realtime_;
+  std::atomic<bool> quit_;
+  std::mutex quit_mutex_;
+  std::condition_variable quit_cv_;
+  std::thread play_thread_;
+};
+
+// 回放时的IMU替身, 由录制的四元数插值得到任意时刻的姿态
+class ReplayIMU
+{
+public:
+  explicit ReplayIMU(const std::string & path);
+  Eigen::Quaterniond imu_at(std::chrono::steady_clock::time_point timestamp) const;
+
+private:
+  std::vector<double> times_;  // s, 录制开始后的时刻
+  std::vector<Eigen::Quaterniond> qs_;
+};
+
+}  // namespace io
+
+#endif  // IO__REPLAY_HPP
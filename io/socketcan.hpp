@@ -2,11 +2,14 @@
 #define IO__SOCKETCAN_HPP
 
 #include <linux/can.h>
+#include <linux/net_tstamp.h>
 #include <net/if.h>
 #include <sys/epoll.h>
 #include <sys/ioctl.h>
+#include <sys/socket.h>
 #include <unistd.h>
 
+#include <cerrno>
 #include <chrono>
 #include <cstring>
 #include <functional>
@@ -18,13 +21,18 @@
 using namespace std::chrono_literals;
 
 constexpr int MAX_EVENTS = 10;
+constexpr int RECV_BATCH = 32;  // 每次recvmmsg最多读取的帧数
 
 namespace io
 {
 class SocketCAN
 {
 public:
-  SocketCAN(const std::string & interface, std::function<void(const can_frame & frame)> rx_handler)
+  // rx_handler的timestamp为帧到达内核的时刻(映射到steady_clock), 内核不支持时为读取时刻
+  using RxHandler = std::function<void(
+    const can_frame & frame, std::chrono::steady_clock::time_point timestamp)>;
+
+  SocketCAN(const std::string & interface, RxHandler rx_handler)
   : interface_(interface),
     socket_fd_(-1),
     epoll_fd_(-1),
@@ -72,9 +80,15 @@ private:
   bool ok_;
   std::thread read_thread_;
   std::thread daemon_thread_;
-  can_frame frame_;
   epoll_event events_[MAX_EVENTS];
-  std::function<void(const can_frame & frame)> rx_handler_;
+  RxHandler rx_handler_;
+
+  // recvmmsg的缓冲
+  can_frame frames_[RECV_BATCH];
+  iovec iovecs_[RECV_BATCH];
+  mmsghdr msgs_[RECV_BATCH];
+  // SCM_TIMESTAMPING携带3个timespec(软件, 保留, 硬件)
+  char controls_[RECV_BATCH][CMSG_SPACE(3 * sizeof(timespec))];
 
   void open()
   {
@@ -95,6 +109,14 @@ private:
       throw std::runtime_error("Error binding socket to interface!");
     }
 
+    // 内核接收时间戳, 优先SO_TIMESTAMPING, 否则退化为SO_TIMESTAMPNS
+    int flags = SOF_TIMESTAMPING_RX_SOFTWARE | SOF_TIMESTAMPING_SOFTWARE;
+    if (setsockopt(socket_fd_, SOL_SOCKET, SO_TIMESTAMPING, &flags, sizeof(flags)) < 0) {
+      int enable = 1;
+      if (setsockopt(socket_fd_, SOL_SOCKET, SO_TIMESTAMPNS, &enable, sizeof(enable)) < 0)
+        tools::logger()->warn("SocketCAN: kernel timestamps unavailable, using receive time.");
+    }
+
     epoll_event ev;
     epoll_fd_ = epoll_create1(0);
     if (epoll_fd_ == -1) throw std::runtime_error("Error creating epoll file descriptor!");
@@ -108,8 +130,6 @@ private:
     read_thread_ = std::thread([this]() {
       ok_ = true;
       while (!quit_) {
-        std::this_thread::sleep_for(10us);
-
         try {
           read();
         } catch (const std::exception & e) {
@@ -132,17 +152,74 @@ private:
     }
   }
 
+  // 阻塞等待(超时只用于检查quit_), 每次唤醒读空所有待接收的帧
   void read()
   {
-    int num_events = epoll_wait(epoll_fd_, events_, MAX_EVENTS, 2);
-    if (num_events == -1) throw std::runtime_error("Error wating for events!");
+    int num_events = epoll_wait(epoll_fd_, events_, MAX_EVENTS, 100);
+    if (num_events == -1) {
+      if (errno == EINTR) return;
+      throw std::runtime_error("Error wating for events!");
+    }
+    if (num_events == 0) return;
+
+    while (true) {
+      for (int i = 0; i < RECV_BATCH; i++) {
+        iovecs_[i] = {&frames_[i], sizeof(can_frame)};
+        std::memset(&msgs_[i], 0, sizeof(mmsghdr));
+        msgs_[i].msg_hdr.msg_iov = &iovecs_[i];
+        msgs_[i].msg_hdr.msg_iovlen = 1;
+        msgs_[i].msg_hdr.msg_control = controls_[i];
+        msgs_[i].msg_hdr.msg_controllen = sizeof(controls_[i]);
+      }
+
+      int num_msgs = recvmmsg(socket_fd_, msgs_, RECV_BATCH, MSG_DONTWAIT, nullptr);
+      if (num_msgs == -1) {
+        if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) return;
+        throw std::runtime_error("Error reading from SocketCAN!");
+      }
+
+      // 内核时间戳为CLOCK_REALTIME, 按此刻两个时钟的差映射到steady_clock
+      auto steady_now = std::chrono::steady_clock::now();
+      auto system_now = std::chrono::system_clock::now();
+
+      for (int i = 0; i < num_msgs; i++) {
+        if (msgs_[i].msg_len < sizeof(can_frame)) continue;
+
+        auto timestamp = steady_now;
+        timespec ts;
+        if (kernel_timestamp(msgs_[i].msg_hdr, ts)) {
+          auto kernel_time = std::chrono::system_clock::time_point(
+            std::chrono::duration_cast<std::chrono::system_clock::duration>(
+              std::chrono::seconds(ts.tv_sec) + std::chrono::nanoseconds(ts.tv_nsec)));
+          auto age = system_now - kernel_time;
+          if (age > std::chrono::system_clock::duration::zero())
+            timestamp -= std::chrono::duration_cast<std::chrono::steady_clock::duration>(age);
+        }
+
+        rx_handler_(frames_[i], timestamp);
+      }
+
+      if (num_msgs < RECV_BATCH) return;
+    }
+  }
+
+  static bool kernel_timestamp(msghdr & msg, timespec & ts)
+  {
+    for (auto cmsg = CMSG_FIRSTHDR(&msg); cmsg; cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+      if (cmsg->cmsg_level != SOL_SOCKET) continue;
 
-    for (int i = 0; i < num_events; i++) {
-      ssize_t num_bytes = recv(socket_fd_, &frame_, sizeof(can_frame), MSG_DONTWAIT);
-      if (num_bytes == -1) throw std::runtime_error("Error reading from SocketCAN!");
+      if (cmsg->cmsg_type == SCM_TIMESTAMPING) {
+        // ts[0]为软件时间戳
+        std::memcpy(&ts, CMSG_DATA(cmsg), sizeof(timespec));
+        return ts.tv_sec != 0 || ts.tv_nsec != 0;
+      }
 
-      rx_handler_(frame_);
+      if (cmsg->cmsg_type == SCM_TIMESTAMPNS) {
+        std::memcpy(&ts, CMSG_DATA(cmsg), sizeof(timespec));
+        return true;
+      }
     }
+    return false;
   }
 
   void close()
@@ -0,0 +1,126 @@
+#include "transmitter.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+#include "tools/logger.hpp"
+#include "tools/math_tools.hpp"
+
+namespace io
+{
+constexpr double STATS_INTERVAL = 5.0;  // s
+
+Transmitter::Transmitter(
+  const std::string & name, double rate, WriteFunction write, double keepalive)
+: name_(name),
+  min_interval_(std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+    std::chrono::duration<double>(1.0 / rate))),
+  keepalive_(std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+    std::chrono::duration<double>(keepalive))),
+  write_(write)
+{
+  thread_ = std::thread(&Transmitter::send_loop, this);
+}
+
+Transmitter::~Transmitter()
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    quit_ = true;
+  }
+  cv_.notify_all();
+  if (thread_.joinable()) thread_.join();
+}
+
+void Transmitter::publish(const void * data, size_t size)
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto bytes = static_cast<const uint8_t *>(data);
+    latest_.assign(bytes, bytes + size);
+    has_new_ = true;
+    stats_.published++;
+  }
+  cv_.notify_one();
+}
+
+Transmitter::Stats Transmitter::stats()
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto stats = stats_;
+  if (stats.sent > 0) stats.write_avg_us = write_sum_us_ / stats.sent;
+  return stats;
+}
+
+void Transmitter::send_loop()
+{
+  std::vector<uint8_t> last_sent, to_send;
+  auto last_send_time = std::chrono::steady_clock::time_point::min();
+  auto last_log_time = std::chrono::steady_clock::now();
+  uint64_t last_log_failures = 0;
+
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (!quit_) {
+    // 等待新命令, 或到了保活重发的时刻
+    auto keepalive_time = last_sent.empty() ? std::chrono::steady_clock::time_point::max()
+                                            : last_send_time + keepalive_;
+    cv_.wait_until(lock, keepalive_time, [this] { return has_new_ || quit_; });
+    if (quit_) break;
+
+    auto now = std::chrono::steady_clock::now();
+    if (has_new_) {
+      // 限制发送速率, 期间到达的命令会覆盖latest_
+      if (now < last_send_time + min_interval_) {
+        cv_.wait_until(lock, last_send_time + min_interval_, [this] { return quit_; });
+        if (quit_) break;
+      }
+      has_new_ = false;
+
+      if (latest_ == last_sent && std::chrono::steady_clock::now() < keepalive_time) {
+        stats_.skipped_repeats++;
+        continue;
+      }
+      to_send = latest_;
+    } else {
+      if (now < keepalive_time) continue;
+      to_send = last_sent;
+    }
+
+    lock.unlock();
+    auto t0 = std::chrono::steady_clock::now();
+    bool ok = true;
+    try {
+      write_(to_send.data(), to_send.size());
+    } catch (const std::exception & e) {
+      ok = false;
+      tools::logger()->debug("[{}] Failed to write: {}", name_, e.what());
+    }
+    auto t1 = std::chrono::steady_clock::now();
+    lock.lock();
+
+    auto write_us = tools::delta_time(t1, t0) * 1e6;
+    write_sum_us_ += write_us;
+    stats_.write_max_us = std::max(stats_.write_max_us, write_us);
+    stats_.sent++;
+    if (!ok) stats_.failures++;
+
+    last_send_time = t0;
+    last_sent.swap(to_send);
+    if (!ok) last_sent.clear();  // 失败后下一条命令无论是否相同都要发送
+
+    // 每STATS_INTERVAL秒汇报一次
+    if (tools::delta_time(t1, last_log_time) < STATS_INTERVAL) continue;
+    tools::logger()->debug(
+      "[{}] published {}, sent {}, skipped {}, write avg {:.1f}us max {:.1f}us", name_,
+      stats_.published, stats_.sent, stats_.skipped_repeats, write_sum_us_ / stats_.sent,
+      stats_.write_max_us);
+    if (stats_.failures > last_log_failures)
+      tools::logger()->warn(
+        "[{}] {} writes failed in the last {:.0f}s.", name_, stats_.failures - last_log_failures,
+        STATS_INTERVAL);
+    last_log_failures = stats_.failures;
+    last_log_time = t1;
+  }
+}
+
+}  // namespace io
@@ -0,0 +1,65 @@
+#ifndef IO__TRANSMITTER_HPP
+#define IO__TRANSMITTER_HPP
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace io
+{
+// 异步发送线程, 每条链路一个
+// 调用者publish()后立即返回, 只保留最新一条命令; 发送线程按限定速率写出,
+// 与上次发送的字节完全相同时跳过(超过keepalive仍会重发, 防止下位机超时)
+class Transmitter
+{
+public:
+  // write失败时应抛出异常
+  using WriteFunction = std::function<void(const uint8_t * data, size_t size)>;
+
+  struct Stats
+  {
+    uint64_t published = 0;        // publish()次数
+    uint64_t sent = 0;             // 实际写出次数
+    uint64_t skipped_repeats = 0;  // 因与上次发送相同而跳过的次数
+    uint64_t failures = 0;         // 写失败次数
+    double write_avg_us = 0;       // write()平均耗时
+    double write_max_us = 0;       // write()最大耗时
+  };
+
+  // rate: 最高发送频率, Hz; keepalive: 命令不变时的重发间隔, s
+  Transmitter(
+    const std::string & name, double rate, WriteFunction write, double keepalive = 0.1);
+  ~Transmitter();
+
+  void publish(const void * data, size_t size);
+
+  // 累计统计
+  Stats stats();
+
+private:
+  std::string name_;
+  std::chrono::steady_clock::duration min_interval_;
+  std::chrono::steady_clock::duration keepalive_;
+  WriteFunction write_;
+
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  std::vector<uint8_t> latest_;
+  bool has_new_ = false;
+  bool quit_ = false;
+  Stats stats_;
+  double write_sum_us_ = 0;
+
+  std::thread thread_;
+
+  void send_loop();
+};
+
+}  // namespace io
+
+#endif  // IO__TRANSMITTER_HPP
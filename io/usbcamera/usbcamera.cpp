@@ -10,7 +10,7 @@ using namespace std::chrono_literals;
 namespace io
 {
 USBCamera::USBCamera(const std::string & open_name, const std::string & config_path)
-: open_name_(open_name), quit_(false), ok_(false), queue_(1), open_count_(0)
+: open_name_(open_name), quit_(false), ok_(false), open_count_(0)
 {
   auto yaml = tools::load(config_path);
   image_width_ = tools::read<double>(yaml, "image_width");
@@ -81,15 +81,6 @@ cv::Mat USBCamera::read()
   return img_;
 }
 
-void USBCamera::read(cv::Mat & img, std::chrono::steady_clock::time_point & timestamp)
-{
-  CameraData data;
-  queue_.pop(data);
-
-  img = data.img;
-  timestamp = data.timestamp;
-}
-
 void USBCamera::open()
 {
   std::lock_guard<std::mutex> lock(cap_mutex_);
@@ -147,7 +138,7 @@ void USBCamera::open()
       }
 
       auto timestamp = std::chrono::steady_clock::now();
-      queue_.push({img, timestamp});
+      publish(img, timestamp);
     }
     ok_ = false;
   }};
@@ -6,26 +6,20 @@
 #include <opencv2/opencv.hpp>
 #include <thread>
 
-#include "tools/thread_safe_queue.hpp"
+#include "io/camera.hpp"
 
 namespace io
 {
-class USBCamera
+class USBCamera : public CameraBase
 {
 public:
   USBCamera(const std::string & open_name, const std::string & config_path);
-  ~USBCamera();
+  ~USBCamera() override;
   cv::Mat read();
-  void read(cv::Mat & img, std::chrono::steady_clock::time_point & timestamp);
+  using CameraBase::read;
   std::string device_name;
 
 private:
-  struct CameraData
-  {
-    cv::Mat img;
-    std::chrono::steady_clock::time_point timestamp;
-  };
-
   std::mutex cap_mutex_;
   cv::VideoCapture cap_;
   cv::Mat img_;
@@ -37,7 +31,6 @@ private:
   bool quit_, ok_;
   std::thread capture_thread_;
   std::thread daemon_thread_;
-  tools::ThreadSafeQueue<CameraData> queue_;
 
   void try_open();
   void open();
@@ -108,11 +108,11 @@ int main(int argc, char * argv[])
   std::chrono::steady_clock::time_point t;
 
   while (!exiter.exit()) {
-    camera.read(img, t);
+    if (!camera.read(img, t)) break;
     auto q = gimbal.q(t);
 
     solver.set_R_gimbal2world(q);
-    auto armors = yolo.detect(img);
+    auto armors = yolo.detect(img, tracker.roi(t));
     auto targets = tracker.track(armors, t);
     if (!targets.empty())
       target_queue.push(targets.front());
@@ -146,5 +146,6 @@ int main(int argc, char * argv[])
   if (plan_thread.joinable()) plan_thread.join();
   gimbal.send(false, false, 0, 0, 0, 0, 0, 0);
 
+  camera.report();
   return 0;
 }
\ No newline at end of file
@@ -53,7 +53,7 @@ int main(int argc, char * argv[])
   std::chrono::steady_clock::time_point t;
 
   while (!exiter.exit()) {
-    camera.read(img, t);
+    if (!camera.read(img, t)) break;
     q = cboard.imu_at(t);
     // recorder.record(img, q, t);
 
@@ -154,5 +154,6 @@ int main(int argc, char * argv[])
     if (key == 'q') break;
   }
 
+  camera.report();
   return 0;
 }
\ No newline at end of file
@@ -53,7 +53,7 @@ int main(int argc, char * argv[])
   std::chrono::steady_clock::time_point t;
 
   while (!exiter.exit()) {
-    camera.read(img, t);
+    if (!camera.read(img, t)) break;
     q = gimbal.q(t);
     auto gs = gimbal.state();
     // recorder.record(img, q, t);
@@ -161,5 +161,6 @@ int main(int argc, char * argv[])
     if (key == 'q') break;
   }
 
+  camera.report();
   return 0;
 }
\ No newline at end of file
@@ -45,6 +45,7 @@ int main(int argc, char * argv[])
   auto_aim::multithread::MultiThreadDetector detector(config_path, true);
   auto_aim::Solver solver(config_path);
   auto_aim::Tracker tracker(config_path, solver);
+  tracker.set_ekf_diagnostics(true);
   auto_aim::Aimer aimer(config_path);
   auto_aim::Shooter shooter(config_path);
   auto_aim::multithread::CommandGener commandgener(shooter, aimer, cboard, plotter, true);
@@ -54,9 +55,10 @@ int main(int argc, char * argv[])
     std::chrono::steady_clock::time_point t;
 
     while (!exiter.exit()) {
-      camera.read(img, t);
+      if (!camera.read(img, t)) break;
       detector.push(img, t);
     }
+    detector.close();
   });
 
   auto mode = io::Mode::idle;
@@ -66,6 +68,7 @@ int main(int argc, char * argv[])
     auto t0 = std::chrono::steady_clock::now();
     /// 自瞄核心逻辑
     auto [img, armors, t] = detector.debug_pop();
+    if (img.empty()) break;  // 回放结束
     Eigen::Quaterniond q = cboard.imu_at(t - 1ms);
     mode = cboard.mode;
 
@@ -88,6 +91,13 @@ int main(int argc, char * argv[])
     nlohmann::json data;
     data["t"] = tools::delta_time(std::chrono::steady_clock::now(), t0);
 
+    // 检测流水线各阶段耗时
+    auto timing = detector.last_timing();
+    data["detect_queue"] = tools::delta_time(timing.start, timing.enqueue);
+    data["detect_infer"] = tools::delta_time(timing.done, timing.start);
+    data["detect_total"] = tools::delta_time(timing.pop, timing.enqueue);
+    data["detect_dropped"] = detector.dropped();
+
     // 装甲板原始观测数据
     data["armor_num"] = armors.size();
     if (!armors.empty()) {
@@ -143,15 +153,16 @@ int main(int argc, char * argv[])
       data["last_id"] = target.last_id;
 
       // 卡方检验数据
-      data["residual_yaw"] = target.ekf().data.at("residual_yaw");
-      data["residual_pitch"] = target.ekf().data.at("residual_pitch");
-      data["residual_distance"] = target.ekf().data.at("residual_distance");
-      data["residual_angle"] = target.ekf().data.at("residual_angle");
-      data["nis"] = target.ekf().data.at("nis");
-      data["nees"] = target.ekf().data.at("nees");
-      data["nis_fail"] = target.ekf().data.at("nis_fail");
-      data["nees_fail"] = target.ekf().data.at("nees_fail");
-      data["recent_nis_failures"] = target.ekf().data.at("recent_nis_failures");
+      const auto & diagnostics = target.ekf().diagnostics;
+      data["residual_yaw"] = diagnostics.residual[0];
+      data["residual_pitch"] = diagnostics.residual[1];
+      data["residual_distance"] = diagnostics.residual[2];
+      data["residual_angle"] = diagnostics.residual[3];
+      data["nis"] = diagnostics.nis;
+      data["nees"] = diagnostics.nees;
+      data["nis_fail"] = diagnostics.nis_fail ? 1 : 0;
+      data["nees_fail"] = diagnostics.nees_fail ? 1 : 0;
+      data["nis_fail_rate"] = diagnostics.nis_fail_rate;
     }
 
     // 云台响应情况
@@ -169,5 +180,6 @@ int main(int argc, char * argv[])
 
   detect_thread.join();
 
+  camera.report();
   return 0;
 }
\ No newline at end of file
@@ -5,6 +5,7 @@
 #include "io/camera.hpp"
 #include "io/dm_imu/dm_imu.hpp"
 #include "tasks/auto_aim/aimer.hpp"
+#include "tasks/auto_aim/inference_engine.hpp"
 #include "tasks/auto_aim/multithread/commandgener.hpp"
 #include "tasks/auto_aim/multithread/mt_detector.hpp"
 #include "tasks/auto_aim/shooter.hpp"
@@ -58,23 +59,35 @@ int main(int argc, char * argv[])
 
   auto_aim::multithread::CommandGener commandgener(shooter, aimer, cboard, plotter);
 
+  // 模型内letterbox按图像尺寸编译, 由第一帧确定尺寸, 与其余模型一并预热
+  {
+    cv::Mat img;
+    std::chrono::steady_clock::time_point t;
+    if (!camera.read(img, t)) return 1;
+    detector.prepare(img.size());
+    auto_aim::InferenceEngine::instance().warm_up();
+  }
+
   std::atomic<io::Mode> mode{io::Mode::idle};
   auto last_mode{io::Mode::idle};
+  std::atomic<bool> camera_closed = false;  // 回放结束
 
   auto detect_thread = std::thread([&]() {
     cv::Mat img;
     std::chrono::steady_clock::time_point t;
 
-    while (!exiter.exit()) {
+    while (!exiter.exit() && !camera_closed) {
       if (mode.load() == io::Mode::auto_aim) {
-        camera.read(img, t);
+        if (!camera.read(img, t)) break;
         detector.push(img, t);
       } else
         continue;
     }
+    camera_closed = true;
+    detector.close();
   });
 
-  while (!exiter.exit()) {
+  while (!exiter.exit() && !camera_closed) {
     mode = cboard.mode;
 
     if (last_mode != mode) {
@@ -85,6 +98,7 @@ int main(int argc, char * argv[])
     /// 自瞄
     if (mode.load() == io::Mode::auto_aim) {
       auto [img, armors, t] = detector.debug_pop();
+      if (img.empty()) break;
       Eigen::Quaterniond q = cboard.imu_at(t - 1ms);
 
       // recorder.record(img, q, t);
@@ -105,7 +119,10 @@ int main(int argc, char * argv[])
       Eigen::Quaterniond q;
       std::chrono::steady_clock::time_point t;
 
-      camera.read(img, t);
+      if (!camera.read(img, t)) {
+        camera_closed = true;
+        break;
+      }
       q = cboard.imu_at(t - 1ms);
 
       // recorder.record(img, q, t);
@@ -134,5 +151,6 @@ int main(int argc, char * argv[])
 
   detect_thread.join();
 
+  camera.report();
   return 0;
 }
\ No newline at end of file
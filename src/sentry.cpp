@@ -63,7 +63,7 @@ int main(int argc, char * argv[])
   io::Command last_command;
 
   while (!exiter.exit()) {
-    camera.read(img, timestamp);
+    if (!camera.read(img, timestamp)) break;
     Eigen::Quaterniond q = cboard.imu_at(timestamp - 1ms);
     // recorder.record(img, q, timestamp);
 
@@ -102,5 +102,7 @@ int main(int argc, char * argv[])
 
     ros2.publish(target_info);
   }
+
+  camera.report();
   return 0;
 }
\ No newline at end of file
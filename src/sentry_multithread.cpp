@@ -1,4 +1,5 @@
 #include <fmt/core.h>
+#include <yaml-cpp/yaml.h>
 
 #include <chrono>
 #include <future>
@@ -13,6 +14,7 @@
 #include "io/ros2/ros2.hpp"
 #include "io/usbcamera/usbcamera.hpp"
 #include "tasks/auto_aim/aimer.hpp"
+#include "tasks/auto_aim/inference_scheduler.hpp"
 #include "tasks/auto_aim/shooter.hpp"
 #include "tasks/auto_aim/solver.hpp"
 #include "tasks/auto_aim/tracker.hpp"
@@ -60,7 +62,21 @@ int main(int argc, char * argv[])
   auto_aim::Shooter shooter(config_path);
 
   omniperception::Decider decider(config_path);
-  omniperception::Perceptron perceptron(&usbcam1, &usbcam2, &usbcam3, &usbcam4, config_path);
+
+  // 主相机与全向相机共用算力, 由调度器保证主相机的延迟
+  auto_aim::InferenceScheduler scheduler(config_path);
+
+  // omni_batch: 四路相机合成一个batch推理, 否则每路相机一个线程单独推理
+  std::unique_ptr<omniperception::Perceptron> perceptron;
+  std::unique_ptr<omniperception::BatchPerceptron> batch_perceptron;
+  auto yaml = YAML::LoadFile(config_path);
+  if (yaml["omni_batch"] && yaml["omni_batch"].as<bool>())
+    batch_perceptron = std::make_unique<omniperception::BatchPerceptron>(
+      std::vector<io::USBCamera *>{&usbcam1, &usbcam2, &usbcam3, &usbcam4}, config_path,
+      &scheduler);
+  else
+    perceptron = std::make_unique<omniperception::Perceptron>(
+      &usbcam1, &usbcam2, &usbcam3, &usbcam4, config_path, &scheduler);
 
   omniperception::DetectionResult switch_target;
   cv::Mat img;
@@ -68,7 +84,7 @@ int main(int argc, char * argv[])
   io::Command last_command;
 
   while (!exiter.exit()) {
-    camera.read(img, timestamp);
+    if (!camera.read(img, timestamp)) break;
     Eigen::Quaterniond q = cboard.imu_at(timestamp - 1ms);
     recorder.record(img, q, timestamp);
     /// 自瞄核心逻辑
@@ -76,7 +92,8 @@ int main(int argc, char * argv[])
 
     Eigen::Vector3d gimbal_pos = tools::eulers(solver.R_gimbal2world(), 2, 1, 0);
 
-    auto armors = yolo.detect(img);
+    auto armors =
+      scheduler.run(auto_aim::InferenceScheduler::MAIN, [&] { return yolo.detect(img); }).value();
 
     decider.get_invincible_armor(ros2.subscribe_enemy_status());
 
@@ -84,7 +101,8 @@ int main(int argc, char * argv[])
 
     decider.set_priority(armors);
 
-    auto detection_queue = perceptron.get_detection_queue();
+    auto detection_queue = batch_perceptron ? batch_perceptron->get_detection_queue()
+                                            : perceptron->get_detection_queue();
 
     decider.sort(detection_queue);
 
@@ -121,5 +139,6 @@ int main(int argc, char * argv[])
     ros2.publish(target_info);
   }
 
+  camera.report();
   return 0;
 }
\ No newline at end of file
@@ -7,6 +7,7 @@
 #include "io/camera.hpp"
 #include "io/cboard.hpp"
 #include "tasks/auto_aim/aimer.hpp"
+#include "tasks/auto_aim/inference_engine.hpp"
 #include "tasks/auto_aim/multithread/commandgener.hpp"
 #include "tasks/auto_aim/shooter.hpp"
 #include "tasks/auto_aim/solver.hpp"
@@ -18,6 +19,7 @@
 #include "tools/math_tools.hpp"
 #include "tools/plotter.hpp"
 #include "tools/recorder.hpp"
+#include "tools/startup.hpp"
 
 using namespace std::chrono;
 
@@ -38,24 +40,41 @@ int main(int argc, char * argv[])
   tools::Plotter plotter;
   tools::Recorder recorder;
 
-  io::CBoard cboard(config_path);
-  io::Camera camera(config_path);
+  // 打开设备与编译模型互不依赖, 并行进行
+  tools::Startup startup;
+  auto cboard_future = startup.async<io::CBoard>("cboard", config_path);
+  auto camera_future = startup.async<io::Camera>("camera", config_path);
+  auto detector_future = startup.async<auto_aim::YOLO>("detector", config_path, false);
 
-  auto_aim::YOLO detector(config_path, false);
   auto_aim::Solver solver(config_path);
   auto_aim::Tracker tracker(config_path, solver);
   auto_aim::Aimer aimer(config_path);
   auto_aim::Shooter shooter(config_path);
 
-  cv::Mat img;
+  auto cboard_ptr = cboard_future.get();
+  auto camera_ptr = camera_future.get();
+  auto detector_ptr = detector_future.get();
+  auto & cboard = *cboard_ptr;
+  auto & camera = *camera_ptr;
+  auto & detector = *detector_ptr;
+
+  cv::Mat raw_img;
+  io::BayerPattern pattern;
   Eigen::Quaterniond q;
   std::chrono::steady_clock::time_point t;
 
+  // 模型内letterbox按图像尺寸编译, 由第一帧确定尺寸, 与其余模型一并预热
+  if (!camera.read_raw(raw_img, pattern, t)) return 1;
+  detector.prepare(raw_img.size(), pattern);
+  startup.measure("warm up", [] { auto_aim::InferenceEngine::instance().warm_up(); });
+  startup.report();
+
   auto mode = io::Mode::idle;
   auto last_mode = io::Mode::idle;
 
   while (!exiter.exit()) {
-    camera.read(img, t);
+    // 不在主循环中解马赛克整幅图像, 检测器只处理网络输入与装甲板附近的区域
+    if (!camera.read_raw(raw_img, pattern, t)) break;
     q = cboard.imu_at(t - 1ms);
     mode = cboard.mode;
 
@@ -70,7 +89,7 @@ int main(int argc, char * argv[])
 
     Eigen::Vector3d ypr = tools::eulers(solver.R_gimbal2world(), 2, 1, 0);
 
-    auto armors = detector.detect(img);
+    auto armors = detector.detect(raw_img, pattern, tracker.roi(t));
 
     auto targets = tracker.track(armors, t);
 
@@ -79,5 +98,6 @@ int main(int argc, char * argv[])
     cboard.send(command);
   }
 
+  camera.report();
   return 0;
 }
\ No newline at end of file
@@ -5,6 +5,7 @@
 #include "io/camera.hpp"
 #include "io/dm_imu/dm_imu.hpp"
 #include "tasks/auto_aim/aimer.hpp"
+#include "tasks/auto_aim/inference_engine.hpp"
 #include "tasks/auto_aim/multithread/commandgener.hpp"
 #include "tasks/auto_aim/multithread/mt_detector.hpp"
 #include "tasks/auto_aim/shooter.hpp"
@@ -21,6 +22,8 @@
 #include "tools/math_tools.hpp"
 #include "tools/plotter.hpp"
 #include "tools/recorder.hpp"
+#include "tools/startup.hpp"
+#include "tools/yaml.hpp"
 
 const std::string keys =
   "{help h usage ? | | 输出命令行参数说明}"
@@ -41,27 +44,54 @@ int main(int argc, char * argv[])
   tools::Plotter plotter;
   tools::Recorder recorder;
 
-  io::Gimbal gimbal(config_path);
-  io::Camera camera(config_path);
+  // 打开设备与编译模型互不依赖, 并行进行
+  tools::Startup startup;
+  auto gimbal_future = startup.async<io::Gimbal>("gimbal", config_path);
+  auto camera_future = startup.async<io::Camera>("camera", config_path);
+  auto yolo_future = startup.async<auto_aim::YOLO>("yolo", config_path, true);
+  auto buff_detector_future = startup.async<auto_buff::Buff_Detector>("buff detector", config_path);
 
-  auto_aim::YOLO yolo(config_path, true);
   auto_aim::Solver solver(config_path);
   auto_aim::Tracker tracker(config_path, solver);
   auto_aim::Planner planner(config_path);
 
+  auto gimbal_ptr = gimbal_future.get();
+  auto camera_ptr = camera_future.get();
+  auto yolo_ptr = yolo_future.get();
+  auto buff_detector_ptr = buff_detector_future.get();
+  auto & gimbal = *gimbal_ptr;
+  auto & camera = *camera_ptr;
+  auto & yolo = *yolo_ptr;
+  auto & buff_detector = *buff_detector_ptr;
+
+  // 下位机回传命令序号(command_echo)时, 用实测的命令延迟补偿预测时间
+  auto yaml = tools::load(config_path);
+  if (yaml["use_measured_latency"] && yaml["use_measured_latency"].as<bool>()) {
+    if (gimbal.command_latency())
+      planner.use_measured_latency(gimbal.command_latency());
+    else
+      tools::logger()->warn("use_measured_latency needs command_echo: true, ignored.");
+  }
+
   tools::ThreadSafeQueue<std::optional<auto_aim::Target>, true> target_queue(1);
   target_queue.push(std::nullopt);
 
-  auto_buff::Buff_Detector buff_detector(config_path);
   auto_buff::Solver buff_solver(config_path);
   auto_buff::SmallTarget buff_small_target;
   auto_buff::BigTarget buff_big_target;
   auto_buff::Aimer buff_aimer(config_path);
 
-  cv::Mat img;
+  cv::Mat raw_img;
+  io::BayerPattern pattern;
   Eigen::Quaterniond q;
   std::chrono::steady_clock::time_point t;
 
+  // 模型内letterbox按图像尺寸编译, 由第一帧确定尺寸, 与其余模型一并预热
+  if (!camera.read_raw(raw_img, pattern, t)) return 1;
+  yolo.prepare(raw_img.size(), pattern);
+  startup.measure("warm up", [] { auto_aim::InferenceEngine::instance().warm_up(); });
+  startup.report();
+
   std::atomic<bool> quit = false;
 
   std::atomic<io::GimbalMode> mode{io::GimbalMode::IDLE};
@@ -95,15 +125,20 @@ int main(int argc, char * argv[])
       last_mode = mode.load();
     }
 
-    camera.read(img, t);
+    // 只在录像或打符需要时解马赛克整幅图像
+    if (!camera.read_raw(raw_img, pattern, t)) break;
     auto q = gimbal.q(t);
     auto gs = gimbal.state();
-    recorder.record(img, q, t);
+    if (recorder.due(t)) {
+      cv::Mat img;  // 录像线程异步写入, 每次使用新的缓冲
+      io::demosaic(raw_img, pattern, img);
+      recorder.record(img, q, t);
+    }
     solver.set_R_gimbal2world(q);
 
     /// 自瞄
     if (mode.load() == io::GimbalMode::AUTO_AIM) {
-      auto armors = yolo.detect(img);
+      auto armors = yolo.detect(raw_img, pattern, tracker.roi(t));
       auto targets = tracker.track(armors, t);
       if (!targets.empty())
         target_queue.push(targets.front());
@@ -115,6 +150,8 @@ int main(int argc, char * argv[])
     else if (mode.load() == io::GimbalMode::SMALL_BUFF || mode.load() == io::GimbalMode::BIG_BUFF) {
       buff_solver.set_R_gimbal2world(q);
 
+      cv::Mat img;
+      io::demosaic(raw_img, pattern, img);
       auto power_runes = buff_detector.detect(img);
 
       buff_solver.solve(power_runes);
@@ -141,5 +178,6 @@ int main(int argc, char * argv[])
   if (plan_thread.joinable()) plan_thread.join();
   gimbal.send(false, false, 0, 0, 0, 0, 0, 0);
 
+  camera.report();
   return 0;
 }
\ No newline at end of file
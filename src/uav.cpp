@@ -44,7 +44,7 @@ int main(int argc, char * argv[])
   io::Camera camera(config_path);
   io::CBoard cboard(config_path);
 
-  auto_aim::Detector detector(config_path);
+  auto_aim::Detector detector(config_path, false);
   auto_aim::Solver solver(config_path);
   // auto_aim::YOLO yolo(config_path);
   auto_aim::Tracker tracker(config_path, solver);
@@ -65,7 +65,7 @@ int main(int argc, char * argv[])
   auto last_mode = io::Mode::idle;
 
   while (!exiter.exit()) {
-    camera.read(img, t);
+    if (!camera.read(img, t)) break;
     q = cboard.imu_at(t - 1ms);
     mode = cboard.mode;
     // recorder.record(img, q, t);
@@ -116,5 +116,6 @@ int main(int argc, char * argv[])
       continue;
   }
 
+  camera.report();
   return 0;
 }
\ No newline at end of file
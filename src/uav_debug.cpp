@@ -43,6 +43,7 @@ int main(int argc, char * argv[])
   auto_aim::Solver solver(config_path);
   auto_aim::YOLO yolo(config_path);
   auto_aim::Tracker tracker(config_path, solver);
+  tracker.set_ekf_diagnostics(true);
   auto_aim::Aimer aimer(config_path);
   auto_aim::Shooter shooter(config_path);
 
@@ -56,7 +57,7 @@ int main(int argc, char * argv[])
   auto t0 = std::chrono::steady_clock::now();
 
   while (!exiter.exit()) {
-    camera.read(img, t);
+    if (!camera.read(img, t)) break;
     q = cboard.imu_at(t - 1ms);
     mode = cboard.mode;
     // recorder.record(img, q, t);
@@ -71,6 +72,8 @@ int main(int argc, char * argv[])
     Eigen::Vector3d ypr = tools::eulers(solver.R_gimbal2world(), 2, 1, 0);
 
     auto armors = detector.detect(img);
+    cv::imshow("binary_img", detector.debug_binary_img());
+    cv::imshow("detection", detector.debug_img());
 
     auto targets = tracker.track(armors, t);
 
@@ -141,15 +144,16 @@ int main(int argc, char * argv[])
       data["last_id"] = target.last_id;
 
       // 卡方检验数据
-      data["residual_yaw"] = target.ekf().data.at("residual_yaw");
-      data["residual_pitch"] = target.ekf().data.at("residual_pitch");
-      data["residual_distance"] = target.ekf().data.at("residual_distance");
-      data["residual_angle"] = target.ekf().data.at("residual_angle");
-      data["nis"] = target.ekf().data.at("nis");
-      data["nees"] = target.ekf().data.at("nees");
-      data["nis_fail"] = target.ekf().data.at("nis_fail");
-      data["nees_fail"] = target.ekf().data.at("nees_fail");
-      data["recent_nis_failures"] = target.ekf().data.at("recent_nis_failures");
+      const auto & diagnostics = target.ekf().diagnostics;
+      data["residual_yaw"] = diagnostics.residual[0];
+      data["residual_pitch"] = diagnostics.residual[1];
+      data["residual_distance"] = diagnostics.residual[2];
+      data["residual_angle"] = diagnostics.residual[3];
+      data["nis"] = diagnostics.nis;
+      data["nees"] = diagnostics.nees;
+      data["nis_fail"] = diagnostics.nis_fail ? 1 : 0;
+      data["nees_fail"] = diagnostics.nees_fail ? 1 : 0;
+      data["nis_fail_rate"] = diagnostics.nis_fail_rate;
     }
 
     // 云台响应情况
@@ -169,5 +173,6 @@ int main(int argc, char * argv[])
     if (key == 'q') break;
   }
 
+  camera.report();
   return 0;
 }
\ No newline at end of file
@@ -11,6 +11,8 @@
 
 namespace auto_aim
 {
+constexpr size_t MIN_LATENCY_SAMPLES = 50;
+
 Aimer::Aimer(const std::string & config_path)
 : left_yaw_offset_(std::nullopt), right_yaw_offset_(std::nullopt)
 {
@@ -39,6 +41,8 @@ io::Command Aimer::aim(
   auto ekf = target.ekf();
   double delay_time =
     target.ekf_x()[7] > decision_speed_ ? high_speed_delay_time_ : low_speed_delay_time_;
+  if (command_latency_ && command_latency_->count() >= MIN_LATENCY_SAMPLES)
+    delay_time += command_latency_->percentile(0.5);
 
   if (bullet_speed < 14) bullet_speed = 23;
 
@@ -79,15 +83,10 @@ io::Command Aimer::aim(
   bool converged = false;
   double prev_fly_time = trajectory0.fly_time;
   tools::Trajectory current_traj = trajectory0;
-  std::vector<Target> iteration_target(10, target);  // 创建10个目标副本用于迭代预测
 
   for (int iter = 0; iter < 10; ++iter) {
-    // 预测目标在 future + prev_fly_time 时刻的位置
-    auto predict_time = future + std::chrono::microseconds(static_cast<int>(prev_fly_time * 1e6));
-    iteration_target[iter].predict(predict_time);
-
-    // 计算瞄准点
-    auto aim_point = choose_aim_point(iteration_target[iter]);
+    // 计算目标在 future + prev_fly_time 时刻的瞄准点, 只外推状态, 无需复制目标
+    auto aim_point = choose_aim_point(target, prev_fly_time);
     debug_aim_point = aim_point;
     if (!aim_point.valid) {
       return {false, false, 0, 0};
@@ -141,11 +140,17 @@ io::Command Aimer::aim(
   return command;
 }
 
-AimPoint Aimer::choose_aim_point(const Target & target)
+void Aimer::use_measured_latency(const tools::LatencyHistogram * command_latency)
+{
+  command_latency_ = command_latency;
+}
+
+AimPoint Aimer::choose_aim_point(const Target & target, double dt)
 {
-  Eigen::VectorXd ekf_x = target.ekf_x();
-  std::vector<Eigen::Vector4d> armor_xyza_list = target.armor_xyza_list();
-  auto armor_num = armor_xyza_list.size();
+  Target::State ekf_x = target.predicted_state(dt);
+  auto armor_num = target.armor_num();
+  std::vector<Eigen::Vector4d> armor_xyza_list;
+  for (int i = 0; i < armor_num; i++) armor_xyza_list.push_back(target.armor_xyza(ekf_x, i));
   // 如果装甲板未发生过跳变，则只有当前装甲板的位置已知
   if (!target.jumped) return {true, armor_xyza_list[0]};
 
@@ -160,7 +165,7 @@ AimPoint Aimer::choose_aim_point(const Target & target)
   }
 
   // 不考虑小陀螺
-  if (std::abs(target.ekf_x()[8]) <= 2 && target.name != ArmorName::outpost) {
+  if (std::abs(ekf_x[8]) <= 2 && target.name != ArmorName::outpost) {
     // 选择在可射击范围内的装甲板
     std::vector<int> id_list;
     for (int i = 0; i < armor_num; i++) {
@@ -8,6 +8,7 @@
 #include "io/cboard.hpp"
 #include "io/command.hpp"
 #include "target.hpp"
+#include "tools/latency_histogram.hpp"
 
 namespace auto_aim
 {
@@ -31,6 +32,10 @@ public:
     std::list<Target> targets, std::chrono::steady_clock::time_point timestamp, double bullet_speed,
     io::ShootMode shoot_mode, bool to_now = true);
 
+  // 接入实测的命令延迟(如Gimbal::command_latency()), 样本足够时叠加在*_delay_time上
+  // 传入nullptr(下位机未启用command_echo)时不叠加
+  void use_measured_latency(const tools::LatencyHistogram * command_latency);
+
 private:
   double yaw_offset_;
   std::optional<double> left_yaw_offset_, right_yaw_offset_;
@@ -41,8 +46,10 @@ private:
   double high_speed_delay_time_;
   double low_speed_delay_time_;
   double decision_speed_;
+  const tools::LatencyHistogram * command_latency_ = nullptr;
 
-  AimPoint choose_aim_point(const Target & target);
+  // 在target外推dt秒后的状态上选择瞄准点, 不修改target
+  AimPoint choose_aim_point(const Target & target, double dt = 0);
 };
 
 }  // namespace auto_aim
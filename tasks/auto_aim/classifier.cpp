@@ -9,9 +9,11 @@ Classifier::Classifier(const std::string & config_path)
   auto yaml = YAML::LoadFile(config_path);
   auto model = yaml["classify_model"].as<std::string>();
   net_ = cv::dnn::readNetFromONNX(model);
-  auto ovmodel = core_.read_model(model);
-  compiled_model_ = core_.compile_model(
-    ovmodel, "AUTO", ov::hint::performance_mode(ov::hint::PerformanceMode::LATENCY));
+  model_ = InferenceEngine::instance().load({model, "AUTO"});
+
+  // 预热: cv::dnn在第一次forward时才分配内存、初始化后端
+  net_.setInput(cv::dnn::blobFromImage(cv::Mat::zeros(32, 32, CV_8UC1), 1.0 / 255.0));
+  net_.forward();
 }
 
 void Classifier::classify(Armor & armor)
@@ -58,6 +60,72 @@ void Classifier::classify(Armor & armor)
   armor.name = static_cast<ArmorName>(label_id);
 }
 
+void Classifier::classify(std::vector<Armor> & armors)
+{
+  auto capacity = static_cast<int>(armors.size()) * 32;
+  if (slots_.rows < capacity) {
+    slots_.create(capacity, 32, CV_8UC1);
+    blob_.create(capacity, 32, CV_32F);
+  }
+
+  batch_.clear();
+  for (auto & armor : armors) {
+    auto i = static_cast<int>(batch_.size());
+    auto slot = slots_.rowRange(i * 32, (i + 1) * 32);
+    if (!fill(armor.pattern, slot)) {
+      armor.name = ArmorName::not_armor;
+      continue;
+    }
+    batch_.push_back(&armor);
+  }
+  if (batch_.empty()) return;
+
+  // 槽位连续存放, 整体归一化后即为NCHW的输入
+  auto n = static_cast<int>(batch_.size());
+  auto blob = blob_.rowRange(0, n * 32);
+  slots_.rowRange(0, n * 32).convertTo(blob, CV_32F, 1.0 / 255.0);
+
+  int shape[] = {n, 1, 32, 32};
+  net_.setInput(cv::Mat(4, shape, CV_32F, blob.data));
+  cv::Mat outputs = net_.forward();
+  outputs = outputs.reshape(1, n);
+
+  for (int i = 0; i < n; i++) {
+    cv::Mat output = outputs.row(i);
+
+    // softmax
+    float max = *std::max_element(output.begin<float>(), output.end<float>());
+    cv::exp(output - max, output);
+    float sum = cv::sum(output)[0];
+    output /= sum;
+
+    double confidence;
+    cv::Point label_point;
+    cv::minMaxLoc(output, nullptr, &confidence, nullptr, &label_point);
+
+    batch_[i]->confidence = confidence;
+    batch_[i]->name = static_cast<ArmorName>(label_point.x);
+  }
+}
+
+bool Classifier::fill(const cv::Mat & pattern, cv::Mat & slot)
+{
+  if (pattern.empty()) return false;
+
+  cv::cvtColor(pattern, gray_, cv::COLOR_BGR2GRAY);
+
+  auto x_scale = static_cast<double>(32) / gray_.cols;
+  auto y_scale = static_cast<double>(32) / gray_.rows;
+  auto scale = std::min(x_scale, y_scale);
+  auto h = static_cast<int>(gray_.rows * scale);
+  auto w = static_cast<int>(gray_.cols * scale);
+  if (h == 0 || w == 0) return false;
+
+  slot.setTo(0);
+  cv::resize(gray_, slot(cv::Rect(0, 0, w, h)), {w, h});
+  return true;
+}
+
 void Classifier::ovclassify(Armor & armor)
 {
   if (armor.pattern.empty()) {
@@ -83,16 +151,16 @@ void Classifier::ovclassify(Armor & armor)
 
   auto roi = cv::Rect(0, 0, w, h);
   cv::resize(gray, input(roi), {w, h});
-  // Normalize the input image to [0, 1] range
-  input.convertTo(input, CV_32F, 1.0 / 255.0);
 
-  ov::Tensor input_tensor(ov::element::f32, {1, 1, 32, 32}, input.data);
+  // Normalize the input image to [0, 1] range, 直接写入推理请求预先分配的输入张量
+  auto infer_request = model_->acquire();
+  auto input_tensor = infer_request->get_input_tensor();
+  cv::Mat blob(32, 32, CV_32F, input_tensor.data());
+  input.convertTo(blob, CV_32F, 1.0 / 255.0);
 
-  ov::InferRequest infer_request = compiled_model_.create_infer_request();
-  infer_request.set_input_tensor(input_tensor);
-  infer_request.infer();
+  infer_request->infer();
 
-  auto output_tensor = infer_request.get_output_tensor();
+  auto output_tensor = infer_request->get_output_tensor();
   auto output_shape = output_tensor.get_shape();
   cv::Mat outputs(1, 9, CV_32F, output_tensor.data());
 
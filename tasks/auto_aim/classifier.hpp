@@ -4,8 +4,10 @@
 #include <opencv2/opencv.hpp>
 #include <openvino/openvino.hpp>
 #include <string>
+#include <vector>
 
 #include "armor.hpp"
+#include "inference_engine.hpp"
 
 namespace auto_aim
 {
@@ -16,12 +18,21 @@ public:
 
   void classify(Armor & armor);
 
+  // 一次forward分类所有装甲板, 结果与逐个classify()相同
+  void classify(std::vector<Armor> & armors);
+
   void ovclassify(Armor & armor);
 
 private:
   cv::dnn::Net net_;
-  ov::Core core_;
-  ov::CompiledModel compiled_model_;
+  std::shared_ptr<InferenceEngine::Model> model_;
+
+  // 批量分类的输入: 每个装甲板占一个32x32的槽位, 按需增长, 帧间复用
+  cv::Mat gray_, slots_, blob_;
+  std::vector<Armor *> batch_;
+
+  // 把图案缩放到32x32的槽位左上角, 其余补0; 图案为空时返回false
+  bool fill(const cv::Mat & pattern, cv::Mat & slot);
 };
 
 }  // namespace auto_aim
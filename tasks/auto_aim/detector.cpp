@@ -3,6 +3,7 @@
 #include <fmt/chrono.h>
 #include <yaml-cpp/yaml.h>
 
+#include <algorithm>
 #include <filesystem>
 
 #include "tools/img_tools.hpp"
@@ -26,61 +27,90 @@ Detector::Detector(const std::string & config_path, bool debug)
   min_confidence_ = yaml["min_confidence"].as<double>();
   max_rectangular_error_ = yaml["max_rectangular_error"].as<double>() / 57.3;  // degree to rad
 
+  save_patterns_ = yaml["save_patterns"] ? yaml["save_patterns"].as<bool>() : debug_;
   save_path_ = "patterns";
-  std::filesystem::create_directory(save_path_);
+  if (save_patterns_) std::filesystem::create_directory(save_path_);
 }
 
 std::list<Armor> Detector::detect(const cv::Mat & bgr_img, int frame_count)
 {
-  // 彩色图转灰度图
-  cv::Mat gray_img;
-  cv::cvtColor(bgr_img, gray_img, cv::COLOR_BGR2GRAY);
-
-  // 进行二值化
-  cv::Mat binary_img;
-  cv::threshold(gray_img, binary_img, threshold_, 255, cv::THRESH_BINARY);
-  cv::imshow("binary_img", binary_img);
+  // 彩色图转灰度图并二值化: 按行分块并行, 每块的灰度图在缓存中就被二值化
+  // 同一遍中对亮像素累计红减蓝, 灯条颜色只需沿轮廓读red_blue_img_, 不再回到bgr_img取像素
+  gray_img_.create(bgr_img.size(), CV_8UC1);
+  binary_img_.create(bgr_img.size(), CV_8UC1);
+  red_blue_img_.create(bgr_img.size(), CV_16SC1);
+  cv::parallel_for_(
+    cv::Range(0, bgr_img.rows),
+    [&](const cv::Range & rows) {
+      auto gray = gray_img_.rowRange(rows.start, rows.end);
+      auto binary = binary_img_.rowRange(rows.start, rows.end);
+      cv::cvtColor(bgr_img.rowRange(rows.start, rows.end), gray, cv::COLOR_BGR2GRAY);
+      cv::threshold(gray, binary, threshold_, 255, cv::THRESH_BINARY);
+
+      // 轮廓点都是亮像素, 暗像素处不必写入
+      for (int y = rows.start; y < rows.end; y++) {
+        auto bgr = bgr_img.ptr<uchar>(y);
+        auto bright = binary_img_.ptr<uchar>(y);
+        auto red_blue = red_blue_img_.ptr<short>(y);
+        for (int x = 0; x < bgr_img.cols; x++) {
+          if (bright[x]) red_blue[x] = short(bgr[x * 3 + 2]) - bgr[x * 3];
+        }
+      }
+    },
+    bgr_img.rows / 16.0);
 
   // 获取轮廓点
-  std::vector<std::vector<cv::Point>> contours;
-  cv::findContours(binary_img, contours, cv::RETR_EXTERNAL, cv::CHAIN_APPROX_NONE);
+  cv::findContours(binary_img_, contours_, cv::RETR_EXTERNAL, cv::CHAIN_APPROX_NONE);
 
   // 获取灯条
   std::size_t lightbar_id = 0;
-  std::list<Lightbar> lightbars;
-  for (const auto & contour : contours) {
+  auto max_lightbar_length = 0.0;
+  lightbars_.clear();
+  for (const auto & contour : contours_) {
     auto rotated_rect = cv::minAreaRect(contour);
     auto lightbar = Lightbar(rotated_rect, lightbar_id);
 
     if (!check_geometry(lightbar)) continue;
 
-    lightbar.color = get_color(bgr_img, contour);
-    lightbars.emplace_back(lightbar);
+    lightbar.color = get_color(contour);
+    max_lightbar_length = std::max(max_lightbar_length, lightbar.length);
+    lightbars_.emplace_back(std::move(lightbar));
     lightbar_id += 1;
   }
 
   // 将灯条从左到右排序
-  lightbars.sort([](const Lightbar & a, const Lightbar & b) { return a.center.x < b.center.x; });
-
-  // 获取装甲板
-  std::list<Armor> armors;
-  for (auto left = lightbars.begin(); left != lightbars.end(); left++) {
-    for (auto right = std::next(left); right != lightbars.end(); right++) {
+  std::sort(lightbars_.begin(), lightbars_.end(), [](const Lightbar & a, const Lightbar & b) {
+    return a.center.x < b.center.x;
+  });
+
+  // 获取装甲板: 先收集几何上合理的灯条对, 再一次性分类
+  // 灯条中心距 < max_armor_ratio * 较长灯条长度, 横向距离超出时右侧的灯条都不可能配对
+  auto max_pair_distance = max_armor_ratio_ * max_lightbar_length;
+  candidates_.clear();
+  for (auto left = lightbars_.begin(); left != lightbars_.end(); left++) {
+    for (auto right = std::next(left); right != lightbars_.end(); right++) {
+      if (right->center.x - left->center.x > max_pair_distance) break;
       if (left->color != right->color) continue;
 
       auto armor = Armor(*left, *right);
       if (!check_geometry(armor)) continue;
 
       armor.pattern = get_pattern(bgr_img, armor);
-      classifier_.classify(armor);
-      if (!check_name(armor)) continue;
+      candidates_.emplace_back(std::move(armor));
+    }
+  }
 
-      armor.type = get_type(armor);
-      if (!check_type(armor)) continue;
+  classifier_.classify(candidates_);
 
-      armor.center_norm = get_center_norm(bgr_img, armor.center);
-      armors.emplace_back(armor);
-    }
+  std::list<Armor> armors;
+  for (auto & armor : candidates_) {
+    if (!check_name(armor)) continue;
+
+    armor.type = get_type(armor);
+    if (!check_type(armor)) continue;
+
+    armor.center_norm = get_center_norm(bgr_img, armor.center);
+    armors.emplace_back(std::move(armor));
   }
 
   // 检查装甲板是否存在共用灯条的情况
@@ -114,12 +144,39 @@ std::list<Armor> Detector::detect(const cv::Mat & bgr_img, int frame_count)
 
   armors.remove_if([&](const Armor & a) { return a.duplicated; });
 
-  if (debug_) show_result(binary_img, bgr_img, lightbars, armors, frame_count);
+  if (debug_) draw_result(binary_img_, bgr_img, lightbars_, armors, frame_count);
 
   return armors;
 }
 
 bool Detector::detect(Armor & armor, const cv::Mat & bgr_img)
+{
+  auto boundingBox = refine_region(armor);
+  // 检查boundingBox是否超出图像边界
+  if ((boundingBox & cv::Rect(0, 0, bgr_img.cols, bgr_img.rows)) != boundingBox) return false;
+
+  // 在图像上裁剪出这个矩形区域（ROI）
+  return refine(armor, bgr_img(boundingBox), boundingBox);
+}
+
+bool Detector::detect(Armor & armor, const cv::Mat & raw_img, io::BayerPattern pattern)
+{
+  if (pattern == io::BayerPattern::none) return detect(armor, raw_img);
+
+  auto boundingBox = refine_region(armor);
+  if ((boundingBox & cv::Rect(0, 0, raw_img.cols, raw_img.rows)) != boundingBox) return false;
+
+  // 只解马赛克这个矩形区域
+  cv::Mat armor_roi;
+  io::demosaic(raw_img, pattern, boundingBox, armor_roi);
+  return refine(armor, armor_roi, boundingBox);
+}
+
+const cv::Mat & Detector::debug_img() const { return debug_img_; }
+
+const cv::Mat & Detector::debug_binary_img() const { return debug_binary_img_; }
+
+cv::Rect Detector::refine_region(const Armor & armor) const
 {
   // 取得四个角点
   auto tl = armor.points[0];
@@ -142,20 +199,20 @@ bool Detector::detect(Armor & armor, const cv::Mat & bgr_img)
   // 构造新的四个角点
   std::vector<cv::Point> points = {tl2, tr2, br2, bl2};
   auto armor_rotaterect = cv::minAreaRect(points);
-  cv::Rect boundingBox = armor_rotaterect.boundingRect();
-  // 检查boundingBox是否超出图像边界
-  if (
-    boundingBox.x < 0 || boundingBox.y < 0 || boundingBox.x + boundingBox.width > bgr_img.cols ||
-    boundingBox.y + boundingBox.height > bgr_img.rows) {
-    return false;
-  }
+  return armor_rotaterect.boundingRect();
+}
 
-  // 在图像上裁剪出这个矩形区域（ROI）
-  cv::Mat armor_roi = bgr_img(boundingBox);
+bool Detector::refine(Armor & armor, const cv::Mat & armor_roi, const cv::Rect & boundingBox)
+{
   if (armor_roi.empty()) {
     return false;
   }
 
+  auto tl = armor.points[0];
+  auto tr = armor.points[1];
+  auto br = armor.points[2];
+  auto bl = armor.points[3];
+
   // 彩色图转灰度图
   cv::Mat gray_img;
   cv::cvtColor(armor_roi, gray_img, cv::COLOR_BGR2GRAY);
@@ -175,7 +232,7 @@ bool Detector::detect(Armor & armor, const cv::Mat & bgr_img)
 
     if (!check_geometry(lightbar)) continue;
 
-    lightbar.color = get_color(bgr_img, contour);
+    lightbar.color = get_color(armor_roi, contour);
     // lightbar_points_corrector(lightbar, gray_img); //关闭PCA
     lightbars.emplace_back(lightbar);
     lightbar_id += 1;
@@ -281,13 +338,23 @@ Color Detector::get_color(const cv::Mat & bgr_img, const std::vector<cv::Point>
   int red_sum = 0, blue_sum = 0;
 
   for (const auto & point : contour) {
-    red_sum += bgr_img.at<cv::Vec3b>(point)[2];
-    blue_sum += bgr_img.at<cv::Vec3b>(point)[0];
+    auto pixel = bgr_img.ptr<uchar>(point.y) + point.x * 3;
+    red_sum += pixel[2];
+    blue_sum += pixel[0];
   }
 
   return blue_sum > red_sum ? Color::blue : Color::red;
 }
 
+Color Detector::get_color(const std::vector<cv::Point> & contour) const
+{
+  int red_minus_blue = 0;
+
+  for (const auto & point : contour) red_minus_blue += red_blue_img_.at<short>(point);
+
+  return red_minus_blue < 0 ? Color::blue : Color::red;
+}
+
 cv::Mat Detector::get_pattern(const cv::Mat & bgr_img, const Armor & armor) const
 {
   // 延长灯条获得装甲板角点
@@ -346,14 +413,16 @@ cv::Point2f Detector::get_center_norm(const cv::Mat & bgr_img, const cv::Point2f
 
 void Detector::save(const Armor & armor) const
 {
+  if (!save_patterns_) return;
+
   auto file_name = fmt::format("{:%Y-%m-%d_%H-%M-%S}", std::chrono::system_clock::now());
   auto img_path = fmt::format("{}/{}_{}.jpg", save_path_, armor.name, file_name);
   cv::imwrite(img_path, armor.pattern);
 }
 
-void Detector::show_result(
-  const cv::Mat & binary_img, const cv::Mat & bgr_img, const std::list<Lightbar> & lightbars,
-  const std::list<Armor> & armors, int frame_count) const
+void Detector::draw_result(
+  const cv::Mat & binary_img, const cv::Mat & bgr_img, const std::vector<Lightbar> & lightbars,
+  const std::list<Armor> & armors, int frame_count)
 {
   auto detection = bgr_img.clone();
   tools::draw_text(detection, fmt::format("[{}]", frame_count), {10, 30}, {255, 255, 255});
@@ -375,12 +444,8 @@ void Detector::show_result(
     tools::draw_text(detection, info, armor.left.bottom, {0, 255, 0});
   }
 
-  cv::Mat binary_img2;
-  cv::resize(binary_img, binary_img2, {}, 0.5, 0.5);  // 显示时缩小图片尺寸
-  cv::resize(detection, detection, {}, 0.5, 0.5);     // 显示时缩小图片尺寸
-
-  // cv::imshow("threshold", binary_img2);
-  cv::imshow("detection", detection);
+  cv::resize(binary_img, debug_binary_img_, {}, 0.5, 0.5);  // 显示时缩小图片尺寸
+  cv::resize(detection, debug_img_, {}, 0.5, 0.5);          // 显示时缩小图片尺寸
 }
 
 void Detector::lightbar_points_corrector(Lightbar & lightbar, const cv::Mat & gray_img) const
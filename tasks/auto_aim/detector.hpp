@@ -8,10 +8,14 @@
 
 #include "armor.hpp"
 #include "classifier.hpp"
+#include "io/bayer.hpp"
 
 namespace auto_aim
 {
 
+// 传统视觉装甲板检测
+// 从不调用HighGUI; debug为true时额外绘制调试图像, 由调用者决定是否显示
+// debug为false时不保存图案(除非配置save_patterns), 每帧的中间结果都存放在复用的成员中
 class Detector
 {
 public:
@@ -19,13 +23,29 @@ public:
 
   std::list<Armor> detect(const cv::Mat & bgr_img, int frame_count = -1);
 
+  // 用传统方法在装甲板附近二次矫正角点
   bool detect(Armor & armor, const cv::Mat & bgr_img);
 
+  // 同上, 但输入为相机原始Bayer图像, 只解马赛克装甲板附近的区域
+  bool detect(Armor & armor, const cv::Mat & raw_img, io::BayerPattern pattern);
+
+  // debug为true时, 最近一次detect()的检测结果与二值图, 均为半分辨率
+  const cv::Mat & debug_img() const;
+  const cv::Mat & debug_binary_img() const;
+
   friend class YOLOV8;
 
 private:
   Classifier classifier_;
 
+  // 帧间复用的中间结果
+  cv::Mat gray_img_, binary_img_;
+  cv::Mat red_blue_img_;  // CV_16S, 亮于阈值的像素处为红减蓝, 其余像素无意义
+  cv::Mat debug_img_, debug_binary_img_;
+  std::vector<std::vector<cv::Point>> contours_;
+  std::vector<Lightbar> lightbars_;  // 按中心x坐标排序
+  std::vector<Armor> candidates_;    // 待分类的装甲板
+
   double threshold_;
   double max_angle_error_;
   double min_lightbar_ratio_, max_lightbar_ratio_;
@@ -36,25 +56,30 @@ private:
   double max_rectangular_error_;
 
   bool debug_;
+  bool save_patterns_;  // 保存不确定或异常的图案, 用于分类器的迭代
   std::string save_path_;
 
   // 利用PCA回归角点，参考自https://github.com/CSU-FYT-Vision/FYT2024_vision
   void lightbar_points_corrector(Lightbar & lightbar, const cv::Mat & gray_img) const;
 
+  cv::Rect refine_region(const Armor & armor) const;  // 二次矫正角点所用的区域
+  bool refine(Armor & armor, const cv::Mat & armor_roi, const cv::Rect & boundingBox);
+
   bool check_geometry(const Lightbar & lightbar) const;
   bool check_geometry(const Armor & armor) const;
   bool check_name(const Armor & armor) const;
   bool check_type(const Armor & armor) const;
 
   Color get_color(const cv::Mat & bgr_img, const std::vector<cv::Point> & contour) const;
+  Color get_color(const std::vector<cv::Point> & contour) const;  // 读red_blue_img_
   cv::Mat get_pattern(const cv::Mat & bgr_img, const Armor & armor) const;
   ArmorType get_type(const Armor & armor);
   cv::Point2f get_center_norm(const cv::Mat & bgr_img, const cv::Point2f & center) const;
 
   void save(const Armor & armor) const;
-  void show_result(
-    const cv::Mat & binary_img, const cv::Mat & bgr_img, const std::list<Lightbar> & lightbars,
-    const std::list<Armor> & armors, int frame_count) const;
+  void draw_result(
+    const cv::Mat & binary_img, const cv::Mat & bgr_img, const std::vector<Lightbar> & lightbars,
+    const std::list<Armor> & armors, int frame_count);
 };
 
 }  // namespace auto_aim
@@ -0,0 +1,206 @@
+#include "inference_engine.hpp"
+
+#include <fmt/core.h>
+
+#include <chrono>
+#include <cstring>
+
+#include "tools/logger.hpp"
+#include "tools/math_tools.hpp"
+
+namespace auto_aim
+{
+InferenceEngine::Model::Model(
+  ov::CompiledModel compiled_model, const ModelConfig & config, double scale)
+: compiled_model_(compiled_model), config_(config), scale_(scale)
+{
+}
+
+std::shared_ptr<ov::InferRequest> InferenceEngine::Model::acquire()
+{
+  ov::InferRequest request;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (idle_.empty()) {
+      request = compiled_model_.create_infer_request();
+      created_++;
+    } else {
+      request = std::move(idle_.back());
+      idle_.pop_back();
+    }
+  }
+
+  auto self = shared_from_this();
+  return std::shared_ptr<ov::InferRequest>(
+    new ov::InferRequest(std::move(request)), [self](ov::InferRequest * request) {
+      {
+        std::lock_guard<std::mutex> lock(self->mutex_);
+        self->idle_.push_back(std::move(*request));
+      }
+      delete request;
+    });
+}
+
+const ov::CompiledModel & InferenceEngine::Model::compiled_model() const { return compiled_model_; }
+
+const InferenceEngine::ModelConfig & InferenceEngine::Model::config() const { return config_; }
+
+double InferenceEngine::Model::scale() const { return scale_; }
+
+size_t InferenceEngine::Model::pool_size() const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  return created_;
+}
+
+double InferenceEngine::Model::warm_up()
+{
+  auto t0 = std::chrono::steady_clock::now();
+
+  auto request = acquire();
+  for (const auto & input : compiled_model_.inputs()) {
+    auto tensor = request->get_tensor(input);
+    std::memset(tensor.data(), 0, tensor.get_byte_size());
+  }
+  request->infer();
+
+  return tools::delta_time(std::chrono::steady_clock::now(), t0);
+}
+
+InferenceEngine::InferenceEngine() { set_cache_dir(DEFAULT_CACHE_DIR); }
+
+InferenceEngine & InferenceEngine::instance()
+{
+  static InferenceEngine engine;
+  return engine;
+}
+
+std::shared_ptr<InferenceEngine::Model> InferenceEngine::load(const ModelConfig & config)
+{
+  auto key = fmt::format(
+    "{}|{}|{}|{}|{}x{}|{}", config.path, config.device, static_cast<int>(config.mode),
+    config.input_size, config.image_width, config.image_height, config.batch);
+
+  // 编译期间不持有锁, 不同模型可以同时编译
+  std::promise<std::shared_ptr<Model>> promise;
+  std::shared_future<std::shared_ptr<Model>> loading;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = models_.find(key);
+    if (it != models_.end())
+      loading = it->second;
+    else
+      models_[key] = promise.get_future().share();
+  }
+  if (loading.valid()) return loading.get();
+
+  try {
+    auto model = compile(config);
+    promise.set_value(model);
+    return model;
+  } catch (...) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      models_.erase(key);
+    }
+    promise.set_exception(std::current_exception());
+    throw;
+  }
+}
+
+void InferenceEngine::set_cache_dir(const std::string & dir)
+{
+  core_.set_property(ov::cache_dir(dir));
+  if (!dir.empty()) tools::logger()->info("[InferenceEngine] Model cache: {}", dir);
+}
+
+void InferenceEngine::warm_up()
+{
+  std::vector<std::shared_future<std::shared_ptr<Model>>> models;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (const auto & [key, model] : models_) models.push_back(model);
+  }
+
+  for (auto & future : models) {
+    auto model = future.get();
+    auto seconds = model->warm_up();
+    tools::logger()->info(
+      "[InferenceEngine] Warmed up {} ({}) in {:.1f}ms.", model->config().path,
+      model->config().device, seconds * 1e3);
+  }
+}
+
+std::shared_ptr<InferenceEngine::Model> InferenceEngine::compile(const ModelConfig & config)
+{
+  auto t0 = std::chrono::steady_clock::now();
+  auto model = core_.read_model(config.path);
+
+  auto scale = 1.0;
+  if (config.input_size > 0 || config.input_size == NATIVE_INPUT_SIZE) {
+    auto shape = model->input().get_partial_shape();
+    auto letterbox = config.image_width > 0 && config.image_height > 0;
+    size_t size =
+      config.input_size > 0 ? config.input_size : static_cast<size_t>(shape[2].get_length());
+    size_t height = letterbox ? config.image_height : size;
+    size_t width = letterbox ? config.image_width : size;
+
+    // 全卷积的YOLO可以改变输入尺寸与batch, 锚点数随输入尺寸变化
+    ov::Dimension side(size), batch(config.batch);
+    if (
+      shape.rank().get_length() == 4 &&
+      (shape[0] != batch || shape[2] != side || shape[3] != side)) {
+      model->reshape(ov::PartialShape{batch, shape[1], side, side});
+    }
+
+    ov::preprocess::PrePostProcessor ppp(model);
+    auto & input = ppp.input();
+
+    input.tensor()
+      .set_element_type(ov::element::u8)
+      .set_shape({size_t(config.batch), height, width, 3})
+      .set_layout("NHWC")
+      .set_color_format(ov::preprocess::ColorFormat::BGR);
+
+    input.model().set_layout("NCHW");
+
+    input.preprocess()
+      .convert_element_type(ov::element::f32)
+      .convert_color(ov::preprocess::ColorFormat::RGB);
+
+    // 与CPU上的letterbox一致: 等比缩放后放在左上角, 右侧与下方补0
+    if (letterbox) {
+      scale = std::min(static_cast<double>(size) / height, static_cast<double>(size) / width);
+      auto h = static_cast<int>(height * scale);
+      auto w = static_cast<int>(width * scale);
+      input.preprocess()
+        .resize(ov::preprocess::ResizeAlgorithm::RESIZE_LINEAR, h, w)
+        .pad(
+          {0, 0, 0, 0}, {0, int(size) - h, int(size) - w, 0}, 0,
+          ov::preprocess::PaddingMode::CONSTANT);
+    }
+
+    input.preprocess().scale(255.0);
+
+    model = ppp.build();
+  }
+
+  auto compiled_model =
+    core_.compile_model(model, config.device, ov::hint::performance_mode(config.mode));
+  auto from_cache = compiled_model.get_property(ov::loaded_from_cache);
+  tools::logger()->info(
+    "[InferenceEngine] {} {} on {} in {:.0f}ms.", from_cache ? "Loaded cached" : "Compiled",
+    config.path, config.device, tools::delta_time(std::chrono::steady_clock::now(), t0) * 1e3);
+
+  return std::make_shared<Model>(compiled_model, config, scale);
+}
+
+ov::Tensor InferenceEngine::wrap(const cv::Mat & img)
+{
+  ov::Strides strides = {img.rows * img.step[0], img.step[0], img.step[1], img.elemSize1()};
+  return ov::Tensor(
+    ov::element::u8, {1, size_t(img.rows), size_t(img.cols), size_t(img.channels())}, img.data,
+    strides);
+}
+
+}  // namespace auto_aim
@@ -0,0 +1,98 @@
+#ifndef AUTO_AIM__INFERENCE_ENGINE_HPP
+#define AUTO_AIM__INFERENCE_ENGINE_HPP
+
+#include <future>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <opencv2/opencv.hpp>
+#include <openvino/openvino.hpp>
+#include <string>
+#include <vector>
+
+namespace auto_aim
+{
+// 进程内共享的OpenVINO推理服务
+// 所有检测器共用一个ov::Core; 配置相同的模型只读取、编译一次, 推理请求从池中复用
+// 编译结果缓存在磁盘上(按模型哈希、设备与性能提示区分), 再次启动时直接加载
+// 不同模型可以在多个线程中同时编译
+class InferenceEngine
+{
+public:
+  struct ModelConfig
+  {
+    std::string path;
+    std::string device = "CPU";
+    ov::hint::PerformanceMode mode = ov::hint::PerformanceMode::LATENCY;
+    // >0时加入YOLO预处理: 输入为input_size x input_size的BGR u8 NHWC图像
+    // 与模型原本的输入尺寸不同时会先reshape模型; 为NATIVE_INPUT_SIZE时使用模型原本的输入尺寸
+    int input_size = 0;
+
+    // >0时(需同时设置input_size)输入为该尺寸的原始BGR图像, letterbox缩放与填充在模型内完成
+    int image_width = 0, image_height = 0;
+
+    // >1时(需同时设置input_size)一次推理batch张图像, 输入输出的第0维为batch
+    int batch = 1;
+  };
+
+  class Model : public std::enable_shared_from_this<Model>
+  {
+  public:
+    Model(ov::CompiledModel compiled_model, const ModelConfig & config, double scale);
+
+    // 取出一个空闲的推理请求, 最后一个引用释放时自动归还; 输入输出张量随请求预先分配
+    std::shared_ptr<ov::InferRequest> acquire();
+
+    const ov::CompiledModel & compiled_model() const;
+    const ModelConfig & config() const;
+
+    // 模型内letterbox的缩放比例, 没有时为1
+    double scale() const;
+
+    // 已创建的推理请求数
+    size_t pool_size() const;
+
+    // 用全0输入同步推理一次, 使首帧不承担内存分配与内核初始化的开销, 返回耗时(s)
+    double warm_up();
+
+  private:
+    ov::CompiledModel compiled_model_;
+    const ModelConfig config_;
+    const double scale_;
+    mutable std::mutex mutex_;
+    std::vector<ov::InferRequest> idle_;
+    size_t created_ = 0;
+  };
+
+  static InferenceEngine & instance();
+
+  // 多个线程同时请求同一配置时只编译一次, 其余线程等待编译完成
+  std::shared_ptr<Model> load(const ModelConfig & config);
+
+  // 编译缓存目录, 为空时不缓存; 默认为DEFAULT_CACHE_DIR
+  void set_cache_dir(const std::string & dir);
+
+  // 对已加载的所有模型各推理一次, 应在主循环开始前调用
+  void warm_up();
+
+  // 把BGR图像(可以是ROI, 不要求连续)零拷贝包装为NHWC u8张量, 推理结束前img须保持有效
+  static ov::Tensor wrap(const cv::Mat & img);
+
+  static constexpr const char * DEFAULT_CACHE_DIR = "cache/openvino";
+
+  // ModelConfig::input_size取该值时加入YOLO预处理, 但不改变模型的输入尺寸
+  static constexpr int NATIVE_INPUT_SIZE = -1;
+
+private:
+  ov::Core core_;
+  std::mutex mutex_;
+  std::map<std::string, std::shared_future<std::shared_ptr<Model>>> models_;
+
+  InferenceEngine();
+
+  std::shared_ptr<Model> compile(const ModelConfig & config);
+};
+
+}  // namespace auto_aim
+
+#endif  // AUTO_AIM__INFERENCE_ENGINE_HPP
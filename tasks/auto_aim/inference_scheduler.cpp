@@ -0,0 +1,122 @@
+#include "inference_scheduler.hpp"
+
+#include <yaml-cpp/yaml.h>
+
+#include <algorithm>
+
+#include "tools/logger.hpp"
+#include "tools/math_tools.hpp"
+
+namespace auto_aim
+{
+constexpr const char * PRIORITY_NAMES[] = {"main", "omni"};
+constexpr double OMNI_INTERVAL_STEP = 1e-3;  // s, 主相机每按时完成一帧, 全向相机间隔缩短的量
+constexpr double LOG_INTERVAL = 5.0;         // s
+
+InferenceScheduler::InferenceScheduler(const std::string & config_path)
+{
+  auto yaml = YAML::LoadFile(config_path);
+  auto get = [&](const std::string & key, double default_value) {
+    return yaml[key] ? yaml[key].as<double>() : default_value;
+  };
+
+  slots_ = std::max(1, static_cast<int>(get("scheduler_slots", 1)));
+  budgets_[MAIN] = get("main_budget_ms", 10) * 1e-3;
+  budgets_[OMNI] = get("omni_budget_ms", 50) * 1e-3;
+  omni_min_interval_ = get("omni_min_interval_ms", 5) * 1e-3;
+  omni_max_interval_ = get("omni_max_interval_ms", 200) * 1e-3;
+  omni_interval_ = omni_min_interval_;
+
+  last_omni_time_ = last_log_time_ = std::chrono::steady_clock::now();
+  tools::logger()->info("[InferenceScheduler] {} slot(s)", slots_);
+}
+
+InferenceScheduler::Stats InferenceScheduler::stats(Priority priority) const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto stats = stats_[priority];
+  stats.wait_p50 = wait_latency_[priority].percentile(0.5);
+  stats.run_p50 = run_latency_[priority].percentile(0.5);
+  return stats;
+}
+
+double InferenceScheduler::omni_interval() const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  return omni_interval_;
+}
+
+bool InferenceScheduler::admit(Priority priority, std::chrono::steady_clock::time_point t)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  stats_[priority].requests++;
+
+  if (priority == MAIN) return true;
+
+  if (tools::delta_time(t, last_omni_time_) < omni_interval_) {
+    stats_[priority].skipped++;
+    return false;
+  }
+
+  last_omni_time_ = t;
+  return true;
+}
+
+void InferenceScheduler::acquire(Priority priority)
+{
+  std::unique_lock<std::mutex> lock(mutex_);
+  waiting_[priority]++;
+  condition_.wait(lock, [this, priority] {
+    if (running_ >= slots_) return false;
+    for (int p = 0; p < priority; p++) {
+      if (waiting_[p] > 0) return false;  // 更高优先级的请求先行
+    }
+    return true;
+  });
+  waiting_[priority]--;
+  running_++;
+}
+
+void InferenceScheduler::release(
+  Priority priority, std::chrono::steady_clock::time_point request_time,
+  std::chrono::steady_clock::time_point start_time)
+{
+  auto end_time = std::chrono::steady_clock::now();
+  auto wait = tools::delta_time(start_time, request_time);
+  auto run = tools::delta_time(end_time, start_time);
+  auto missed = wait + run > budgets_[priority];
+
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    running_--;
+
+    auto & stats = stats_[priority];
+    stats.completed++;
+    if (missed) stats.deadline_misses++;
+    wait_latency_[priority].add(wait);
+    run_latency_[priority].add(run);
+
+    // AIMD: 主相机超时说明算力不足, 全向相机立即退让; 按时完成则逐步收回余量
+    if (priority == MAIN) {
+      omni_interval_ = missed ? std::min(omni_interval_ * 2, omni_max_interval_)
+                              : std::max(omni_interval_ - OMNI_INTERVAL_STEP, omni_min_interval_);
+    }
+
+    if (tools::delta_time(end_time, last_log_time_) > LOG_INTERVAL) {
+      for (int p = 0; p < PRIORITY_NUM; p++) {
+        const auto & s = stats_[p];
+        tools::logger()->debug(
+          "[InferenceScheduler] {}: {} requests, {} skipped, {} deadline misses | wait p50 "
+          "{:.1f}ms, run p50 {:.1f}ms",
+          PRIORITY_NAMES[p], s.requests, s.skipped, s.deadline_misses,
+          wait_latency_[p].percentile(0.5) * 1e3, run_latency_[p].percentile(0.5) * 1e3);
+      }
+      tools::logger()->debug("[InferenceScheduler] omni interval {:.1f}ms", omni_interval_ * 1e3);
+      last_log_time_ = end_time;
+    }
+  }
+
+  condition_.notify_all();
+}
+
+}  // namespace auto_aim
@@ -0,0 +1,91 @@
+#ifndef AUTO_AIM__INFERENCE_SCHEDULER_HPP
+#define AUTO_AIM__INFERENCE_SCHEDULER_HPP
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <optional>
+#include <string>
+
+#include "tools/latency_histogram.hpp"
+
+namespace auto_aim
+{
+// 多路相机共享算力时的推理调度器, 推理在调用者线程中执行
+// 同时推理的请求数不超过slots, 等待中的主相机请求总是先于全向相机
+// 全向相机按omni_interval限频: 主相机超出时间预算时间隔加倍, 按时完成时逐步缩短, 以此利用剩余算力
+// slots默认为1: 各模型按LATENCY编译, 单个推理请求已占满设备的全部推理流
+// (OPTIMAL_NUMBER_OF_INFER_REQUESTS为1), 并行只会互相争抢, 主相机的优先级也随之失效
+// 改用THROUGHPUT编译或有多个推理设备时, 再按设备的最优请求数调大
+class InferenceScheduler
+{
+public:
+  enum Priority
+  {
+    MAIN,
+    OMNI,
+    PRIORITY_NUM
+  };
+
+  struct Stats
+  {
+    uint64_t requests = 0;
+    uint64_t skipped = 0;          // 被限频跳过
+    uint64_t completed = 0;
+    uint64_t deadline_misses = 0;  // 从请求到完成超出该类的时间预算
+    double wait_p50 = 0;           // s, 排队
+    double run_p50 = 0;            // s, 推理
+  };
+
+  explicit InferenceScheduler(const std::string & config_path);
+
+  // 轮到时在当前线程执行f并返回其结果; 全向相机被限频时不执行, 返回std::nullopt
+  template <typename F>
+  auto run(Priority priority, F && f) -> std::optional<decltype(f())>
+  {
+    auto request_time = std::chrono::steady_clock::now();
+    if (!admit(priority, request_time)) return std::nullopt;
+
+    acquire(priority);
+    Release release{this, priority, request_time, std::chrono::steady_clock::now()};
+    return f();
+  }
+
+  Stats stats(Priority priority) const;
+
+  // 当前全向相机两次推理的最小间隔, s
+  double omni_interval() const;
+
+private:
+  struct Release
+  {
+    InferenceScheduler * scheduler;
+    Priority priority;
+    std::chrono::steady_clock::time_point request_time, start_time;
+    ~Release() { scheduler->release(priority, request_time, start_time); }
+  };
+
+  int slots_;
+  double budgets_[PRIORITY_NUM];  // s
+  double omni_min_interval_, omni_max_interval_, omni_interval_;
+
+  mutable std::mutex mutex_;
+  std::condition_variable condition_;
+  int running_ = 0;
+  int waiting_[PRIORITY_NUM] = {};
+  std::chrono::steady_clock::time_point last_omni_time_;
+
+  Stats stats_[PRIORITY_NUM];
+  tools::LatencyHistogram wait_latency_[PRIORITY_NUM], run_latency_[PRIORITY_NUM];
+  std::chrono::steady_clock::time_point last_log_time_;
+
+  bool admit(Priority priority, std::chrono::steady_clock::time_point t);
+  void acquire(Priority priority);
+  void release(
+    Priority priority, std::chrono::steady_clock::time_point request_time,
+    std::chrono::steady_clock::time_point start_time);
+};
+
+}  // namespace auto_aim
+
+#endif  // AUTO_AIM__INFERENCE_SCHEDULER_HPP
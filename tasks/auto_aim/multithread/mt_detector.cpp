@@ -2,99 +2,208 @@
 
 #include <yaml-cpp/yaml.h>
 
+#include "tools/math_tools.hpp"
+
 namespace auto_aim
 {
 namespace multithread
 {
 
 MultiThreadDetector::MultiThreadDetector(const std::string & config_path, bool debug)
-: yolo_(config_path, debug)
+: yolo_(YOLO::postprocessor(config_path, debug))
 {
   auto yaml = YAML::LoadFile(config_path);
   auto yolo_name = yaml["yolo_name"].as<std::string>();
-  auto model_path = yaml[yolo_name + "_model_path"].as<std::string>();
+  model_path_ = yaml[yolo_name + "_model_path"].as<std::string>();
   device_ = yaml["device"].as<std::string>();
+  ov_preprocess_ = yaml["ov_preprocess"] && yaml["ov_preprocess"].as<bool>();
+
+  mode_ = Mode::THROUGHPUT;
+  if (yaml["detector_mode"]) {
+    auto mode = yaml["detector_mode"].as<std::string>();
+    if (mode == "latency")
+      mode_ = Mode::LATENCY;
+    else if (mode != "throughput")
+      throw std::runtime_error("Unknown detector_mode: " + mode + "!");
+  }
+  performance_mode_ = (mode_ == Mode::LATENCY) ? ov::hint::PerformanceMode::LATENCY
+                                                : ov::hint::PerformanceMode::THROUGHPUT;
+
+  model_ = InferenceEngine::instance().load({model_path_, device_, performance_mode_, 640});
+
+  if (mode_ == Mode::LATENCY)
+    max_in_flight_ = 1;
+  else if (yaml["max_in_flight"])
+    max_in_flight_ = yaml["max_in_flight"].as<int>();
+  else
+    max_in_flight_ = model_->compiled_model().get_property(ov::optimal_number_of_infer_requests);
+  max_in_flight_ = std::max<size_t>(max_in_flight_, 1);
+
+  last_log_time_ = std::chrono::steady_clock::now();
+
+  tools::logger()->info(
+    "[MultiThreadDetector] initialized, {} mode, {} in flight!",
+    mode_ == Mode::LATENCY ? "latency" : "throughput", max_in_flight_);
+}
 
-  auto model = core_.read_model(model_path);
-  ov::preprocess::PrePostProcessor ppp(model);
-  auto & input = ppp.input();
-
-  input.tensor()
-    .set_element_type(ov::element::u8)
-    .set_shape({1, 640, 640, 3})  // TODO
-    .set_layout("NHWC")
-    .set_color_format(ov::preprocess::ColorFormat::BGR);
-
-  input.model().set_layout("NCHW");
-
-  input.preprocess()
-    .convert_element_type(ov::element::f32)
-    .convert_color(ov::preprocess::ColorFormat::RGB)
-    // .resize(ov::preprocess::ResizeAlgorithm::RESIZE_LINEAR)
-    .scale(255.0);
-
-  model = ppp.build();
-  compiled_model_ = core_.compile_model(
-    model, device_, ov::hint::performance_mode(ov::hint::PerformanceMode::THROUGHPUT));
+void MultiThreadDetector::prepare(const cv::Size & img_size)
+{
+  if (!ov_preprocess_) return;
 
-  tools::logger()->info("[MultiThreadDetector] initialized !");
+  auto model = InferenceEngine::instance().load(
+    {model_path_, device_, performance_mode_, 640, img_size.width, img_size.height});
+  std::lock_guard<std::mutex> lock(mutex_);
+  letterbox_model_ = model;
 }
 
 void MultiThreadDetector::push(cv::Mat img, std::chrono::steady_clock::time_point t)
 {
-  auto x_scale = static_cast<double>(640) / img.rows;
-  auto y_scale = static_cast<double>(640) / img.cols;
-  auto scale = std::min(x_scale, y_scale);
-  auto h = static_cast<int>(img.rows * scale);
-  auto w = static_cast<int>(img.cols * scale);
+  Frame frame;
+  frame.img = img.clone();
+  frame.t = t;
+  frame.timing.enqueue = std::chrono::steady_clock::now();
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (running_ < max_in_flight_) {
+    start(frame);
+    in_flight_.push_back(std::move(frame));
+    not_empty_.notify_one();
+    return;
+  }
+
+  // 流水线已满: 只保留最新的一帧, 等有推理完成时再开始
+  if (pending_) dropped_++;
+  pending_ = std::move(frame);
+}
 
-  // preproces
-  auto input = cv::Mat(640, 640, CV_8UC3, cv::Scalar(0, 0, 0));
-  auto roi = cv::Rect(0, 0, w, h);
-  cv::resize(img, input(roi), {w, h});
+void MultiThreadDetector::close()
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    closed_ = true;
+  }
+  not_empty_.notify_all();
+}
 
-  auto input_port = compiled_model_.input();
-  auto infer_request = compiled_model_.create_infer_request();
-  ov::Tensor input_tensor(ov::element::u8, {1, 640, 640, 3}, input.data);
+std::tuple<std::list<Armor>, std::chrono::steady_clock::time_point> MultiThreadDetector::pop()
+{
+  auto [img, armors, t] = wait_front();
+  return {std::move(armors), t};
+}
 
-  infer_request.set_input_tensor(input_tensor);
-  infer_request.start_async();
-  queue_.push({img.clone(), t, std::move(infer_request)});
+std::tuple<cv::Mat, std::list<Armor>, std::chrono::steady_clock::time_point>
+MultiThreadDetector::debug_pop()
+{
+  return wait_front();
 }
 
-std::tuple<std::list<Armor>, std::chrono::steady_clock::time_point> MultiThreadDetector::pop()
+MultiThreadDetector::FrameTiming MultiThreadDetector::last_timing() const
 {
-  auto [img, t, infer_request] = queue_.pop();
-  infer_request.wait();
+  std::lock_guard<std::mutex> lock(mutex_);
+  return last_timing_;
+}
 
-  // postprocess
-  auto output_tensor = infer_request.get_output_tensor();
-  auto output_shape = output_tensor.get_shape();
-  cv::Mat output(output_shape[1], output_shape[2], CV_32F, output_tensor.data());
-  auto x_scale = static_cast<double>(640) / img.rows;
-  auto y_scale = static_cast<double>(640) / img.cols;
-  auto scale = std::min(x_scale, y_scale);
-  auto armors = yolo_.postprocess(scale, output, img, 0);  //暂不支持ROI
+uint64_t MultiThreadDetector::dropped() const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  return dropped_;
+}
 
-  return {std::move(armors), t};
+// 调用时须持有mutex_
+void MultiThreadDetector::start(Frame & frame)
+{
+  auto & img = frame.img;
+
+  if (ov_preprocess_) {
+    // 缩放与填充在模型内完成, 帧中保存的图像零拷贝作为输入
+    if (!letterbox_model_ || letterbox_model_->config().image_width != img.cols ||
+        letterbox_model_->config().image_height != img.rows) {
+      letterbox_model_ = InferenceEngine::instance().load(
+        {model_path_, device_, performance_mode_, 640, img.cols, img.rows});
+    }
+    frame.infer_request = letterbox_model_->acquire();
+    frame.infer_request->set_input_tensor(InferenceEngine::wrap(img));
+  } else {
+    auto x_scale = static_cast<double>(640) / img.rows;
+    auto y_scale = static_cast<double>(640) / img.cols;
+    auto scale = std::min(x_scale, y_scale);
+    auto h = static_cast<int>(img.rows * scale);
+    auto w = static_cast<int>(img.cols * scale);
+
+    // preproces: 直接写入推理请求预先分配的输入张量
+    frame.infer_request = model_->acquire();
+    auto input_tensor = frame.infer_request->get_input_tensor();
+    auto input = cv::Mat(640, 640, CV_8UC3, input_tensor.data());
+    input.setTo(cv::Scalar(0, 0, 0));
+    auto roi = cv::Rect(0, 0, w, h);
+    cv::resize(img, input(roi), {w, h});
+  }
+
+  frame.done = std::make_shared<std::atomic<std::chrono::steady_clock::time_point>>(
+    std::chrono::steady_clock::time_point());
+  frame.infer_request->set_callback(
+    [done = frame.done](std::exception_ptr) { done->store(std::chrono::steady_clock::now()); });
+
+  frame.timing.start = std::chrono::steady_clock::now();
+  frame.infer_request->start_async();
+  running_++;
 }
 
 std::tuple<cv::Mat, std::list<Armor>, std::chrono::steady_clock::time_point>
-MultiThreadDetector::debug_pop()
+MultiThreadDetector::wait_front()
 {
-  auto [img, t, infer_request] = queue_.pop();
-  infer_request.wait();
+  std::unique_lock<std::mutex> lock(mutex_);
+  not_empty_.wait(lock, [this] { return !in_flight_.empty() || closed_; });
+  if (in_flight_.empty()) return {};
+
+  auto frame = std::move(in_flight_.front());
+  in_flight_.pop_front();
+  lock.unlock();
+
+  frame.infer_request->wait();
+  frame.timing.pop = std::chrono::steady_clock::now();
+  frame.timing.done = frame.done->load();
+  if (frame.timing.done == std::chrono::steady_clock::time_point()) {
+    frame.timing.done = frame.timing.pop;  // 回调尚未执行
+  }
+
+  // 空出一个推理请求, 立即开始等待中的帧, 与下面的后处理并行
+  lock.lock();
+  running_--;
+  if (pending_) {
+    start(*pending_);
+    in_flight_.push_back(std::move(*pending_));
+    pending_.reset();
+  }
+  last_timing_ = frame.timing;
+  auto dropped = dropped_;
+  lock.unlock();
+
+  const auto & timing = frame.timing;
+  queue_latency_.add(tools::delta_time(timing.start, timing.enqueue));
+  infer_latency_.add(tools::delta_time(timing.done, timing.start));
+  pop_latency_.add(tools::delta_time(timing.pop, timing.done));
+  total_latency_.add(tools::delta_time(timing.pop, timing.enqueue));
+
+  if (tools::delta_time(timing.pop, last_log_time_) > 5.0) {
+    tools::logger()->debug(
+      "[MultiThreadDetector] p50 queue {:.1f}ms | infer {:.1f}ms | pop {:.1f}ms | total {:.1f}ms "
+      "| dropped {}",
+      queue_latency_.percentile(0.5) * 1e3, infer_latency_.percentile(0.5) * 1e3,
+      pop_latency_.percentile(0.5) * 1e3, total_latency_.percentile(0.5) * 1e3, dropped);
+    last_log_time_ = timing.pop;
+  }
 
   // postprocess
-  auto output_tensor = infer_request.get_output_tensor();
+  auto output_tensor = frame.infer_request->get_output_tensor();
   auto output_shape = output_tensor.get_shape();
   cv::Mat output(output_shape[1], output_shape[2], CV_32F, output_tensor.data());
-  auto x_scale = static_cast<double>(640) / img.rows;
-  auto y_scale = static_cast<double>(640) / img.cols;
+  auto x_scale = static_cast<double>(640) / frame.img.rows;
+  auto y_scale = static_cast<double>(640) / frame.img.cols;
   auto scale = std::min(x_scale, y_scale);
-  auto armors = yolo_.postprocess(scale, output, img, 0);  //暂不支持ROI
+  auto armors = yolo_.postprocess(scale, output, frame.img, 0);  //暂不支持ROI
 
-  return {img, std::move(armors), t};
+  return {frame.img, std::move(armors), frame.t};
 }
 
 }  // namespace multithread
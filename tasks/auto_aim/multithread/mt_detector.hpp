@@ -1,40 +1,102 @@
 #ifndef AUTO_AIM__MT_DETECTOR_HPP
 #define AUTO_AIM__MT_DETECTOR_HPP
 
+#include <atomic>
 #include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
 #include <opencv2/opencv.hpp>
 #include <openvino/openvino.hpp>
+#include <optional>
 #include <tuple>
 
+#include "tasks/auto_aim/inference_engine.hpp"
 #include "tasks/auto_aim/yolos/yolov5.hpp"
+#include "tools/latency_histogram.hpp"
 #include "tools/logger.hpp"
-#include "tools/thread_safe_queue.hpp"
 
 namespace auto_aim
 {
 namespace multithread
 {
-
+// 异步检测流水线: push()在采图线程中启动推理, pop()在处理线程中按顺序取出结果
+// 同时推理的帧数不超过max_in_flight; 已满时新帧替换等待中的帧(丢弃最旧的未开始帧)
+// 已开始的推理不会被丢弃
+//   latency:    1帧推理中, 下一帧总是最新的图像, 延迟最低
+//   throughput: max_in_flight帧并行(默认为设备建议的推理请求数), 按顺序完成, 吞吐量最高
 class MultiThreadDetector
 {
 public:
+  enum class Mode
+  {
+    LATENCY,
+    THROUGHPUT
+  };
+
+  // 一帧在流水线中各阶段的时刻
+  struct FrameTiming
+  {
+    std::chrono::steady_clock::time_point enqueue;  // push()
+    std::chrono::steady_clock::time_point start;    // 开始推理
+    std::chrono::steady_clock::time_point done;     // 推理完成
+    std::chrono::steady_clock::time_point pop;      // pop()取出
+  };
+
   MultiThreadDetector(const std::string & config_path, bool debug = false);
 
+  // ov_preprocess时按相机图像尺寸提前编译模型内letterbox, 应在InferenceEngine::warm_up()前调用
+  void prepare(const cv::Size & img_size);
+
   void push(cv::Mat img, std::chrono::steady_clock::time_point t);
 
   std::tuple<std::list<Armor>, std::chrono::steady_clock::time_point> pop();  //暂时不支持yolov8
 
   std::tuple<cv::Mat, std::list<Armor>, std::chrono::steady_clock::time_point> debug_pop();
 
+  // 不会再push()新帧(如回放结束): 已推理的帧取完后debug_pop()不再阻塞, 返回空图像
+  void close();
+
+  // 最近一次pop()取出的帧
+  FrameTiming last_timing() const;
+
+  // 因流水线已满而未推理的帧数
+  uint64_t dropped() const;
+
 private:
-  ov::Core core_;
-  ov::CompiledModel compiled_model_;
-  std::string device_;
-  YOLO yolo_;
-
-  tools::ThreadSafeQueue<
-    std::tuple<cv::Mat, std::chrono::steady_clock::time_point, ov::InferRequest>>
-    queue_{16, [] { tools::logger()->debug("[MultiThreadDetector] queue is full!"); }};
+  struct Frame
+  {
+    cv::Mat img;
+    std::chrono::steady_clock::time_point t;
+    std::shared_ptr<ov::InferRequest> infer_request;
+    FrameTiming timing;
+    std::shared_ptr<std::atomic<std::chrono::steady_clock::time_point>> done;  // 由推理回调写入
+  };
+
+  std::shared_ptr<InferenceEngine::Model> model_;
+  std::shared_ptr<InferenceEngine::Model> letterbox_model_;  // ov_preprocess时按图像尺寸编译
+  std::string model_path_, device_;
+  bool ov_preprocess_;
+  Mode mode_;
+  ov::hint::PerformanceMode performance_mode_;
+  size_t max_in_flight_;
+  YOLO yolo_;  // 只用于postprocess(), 不编译模型
+
+  mutable std::mutex mutex_;
+  std::condition_variable not_empty_;
+  std::deque<Frame> in_flight_;   // 已开始推理、尚未取出的帧
+  std::optional<Frame> pending_;  // 等待空闲推理请求的最新一帧
+  size_t running_ = 0;            // 已开始且尚未在pop()中等待完成的推理数
+  uint64_t dropped_ = 0;
+  bool closed_ = false;
+  FrameTiming last_timing_;
+
+  // 排队, 推理, 取出前的等待, 端到端
+  tools::LatencyHistogram queue_latency_, infer_latency_, pop_latency_, total_latency_;
+  std::chrono::steady_clock::time_point last_log_time_;
+
+  void start(Frame & frame);
+  std::tuple<cv::Mat, std::list<Armor>, std::chrono::steady_clock::time_point> wait_front();
 };
 
 }  // namespace multithread
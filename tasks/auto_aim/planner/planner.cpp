@@ -10,6 +10,8 @@ using namespace std::chrono_literals;
 
 namespace auto_aim
 {
+constexpr size_t MIN_LATENCY_SAMPLES = 50;
+
 Planner::Planner(const std::string & config_path)
 {
   auto yaml = tools::load(config_path);
@@ -42,14 +44,14 @@ Plan Planner::plan(Target target, double bullet_speed)
     }
   }
   auto bullet_traj = tools::Trajectory(bullet_speed, min_dist, xyz.z());
-  target.predict(bullet_traj.fly_time);
+  auto fly_time = bullet_traj.fly_time;
 
   // 2. Get trajectory
   double yaw0;
   Trajectory traj;
   try {
-    yaw0 = aim(target, bullet_speed)(0);
-    traj = get_trajectory(target, yaw0, bullet_speed);
+    yaw0 = aim(target, fly_time, bullet_speed)(0);
+    traj = get_trajectory(target, fly_time, yaw0, bullet_speed);
   } catch (const std::exception & e) {
     tools::logger()->warn("Unsolvable target {:.2f}", bullet_speed);
     return {false};
@@ -99,6 +101,8 @@ Plan Planner::plan(std::optional<Target> target, double bullet_speed)
 
   double delay_time =
     std::abs(target->ekf_x()[7]) > decision_speed_ ? high_speed_delay_time_ : low_speed_delay_time_;
+  if (command_latency_ && command_latency_->count() >= MIN_LATENCY_SAMPLES)
+    delay_time += command_latency_->percentile(0.5);
 
   auto future = std::chrono::steady_clock::now() + std::chrono::microseconds(int(delay_time * 1e6));
 
@@ -107,6 +111,11 @@ Plan Planner::plan(std::optional<Target> target, double bullet_speed)
   return plan(*target, bullet_speed);
 }
 
+void Planner::use_measured_latency(const tools::LatencyHistogram * command_latency)
+{
+  command_latency_ = command_latency;
+}
+
 void Planner::setup_yaw_solver(const std::string & config_path)
 {
   auto yaml = tools::load(config_path);
@@ -153,50 +162,67 @@ void Planner::setup_pitch_solver(const std::string & config_path)
   pitch_solver_->settings->max_iter = 10;
 }
 
-Eigen::Matrix<double, 2, 1> Planner::aim(const Target & target, double bullet_speed)
+Eigen::Matrix<double, 2, 1> Planner::aim(const Target & target, double dt, double bullet_speed)
 {
-  Eigen::Vector3d xyz;
-  double yaw;
+  Target::State x = target.predicted_state(dt);
+  Eigen::Vector4d xyza;
   auto min_dist = 1e10;
 
-  for (auto & xyza : target.armor_xyza_list()) {
-    auto dist = xyza.head<2>().norm();
+  for (int i = 0; i < target.armor_num(); i++) {
+    Eigen::Vector4d armor_xyza = target.armor_xyza(x, i);
+    auto dist = armor_xyza.head<2>().norm();
     if (dist < min_dist) {
       min_dist = dist;
-      xyz = xyza.head<3>();
-      yaw = xyza[3];
+      xyza = armor_xyza;
     }
   }
-  debug_xyza = Eigen::Vector4d(xyz.x(), xyz.y(), xyz.z(), yaw);
+  debug_xyza = xyza;
+
+  return aim(xyza.head<3>(), bullet_speed);
+}
 
+Eigen::Matrix<double, 2, 1> Planner::aim(const Eigen::Vector3d & xyz, double bullet_speed)
+{
   auto azim = std::atan2(xyz.y(), xyz.x());
-  auto bullet_traj = tools::Trajectory(bullet_speed, min_dist, xyz.z());
+  auto bullet_traj = tools::Trajectory(bullet_speed, xyz.head<2>().norm(), xyz.z());
   if (bullet_traj.unsolvable) throw std::runtime_error("Unsolvable bullet trajectory!");
 
   return {tools::limit_rad(azim + yaw_offset_), -bullet_traj.pitch - pitch_offset_};
 }
 
-Trajectory Planner::get_trajectory(Target & target, double yaw0, double bullet_speed)
+Trajectory Planner::get_trajectory(
+  const Target & target, double dt, double yaw0, double bullet_speed)
 {
-  Trajectory traj;
-
-  target.predict(-DT * (HALF_HORIZON + 1));
-  auto yaw_pitch_last = aim(target, bullet_speed);
+  constexpr int N = HORIZON + 2;
+  using Horizon = Eigen::Array<double, N, 1>;
+
+  // [0] = -(HALF_HORIZON + 1) * DT -> [HALF_HORIZON + 1] = 0 -> [N - 1] = HALF_HORIZON * DT
+  Horizon dts = Horizon::LinSpaced(N, -DT * (HALF_HORIZON + 1), DT * HALF_HORIZON) + dt;
+
+  // 各时刻距离最近的装甲板, 一次算完整个时域, 不再逐步predict
+  Eigen::Matrix<double, 4, N> nearest;
+  Horizon min_dist = Horizon::Constant(1e10);
+  for (int id = 0; id < target.armor_num(); id++) {
+    Eigen::Matrix<double, 4, N> xyza = target.armor_xyza_at(dts, id);
+    Horizon dist = xyza.topRows<2>().colwise().norm().transpose().array();
+    for (int i = 0; i < N; i++) {
+      if (dist[i] >= min_dist[i]) continue;
+      min_dist[i] = dist[i];
+      nearest.col(i) = xyza.col(i);
+    }
+  }
+  debug_xyza = nearest.col(N - 1);
 
-  target.predict(DT);  // [0] = -HALF_HORIZON * DT -> [HHALF_HORIZON] = 0
-  auto yaw_pitch = aim(target, bullet_speed);
+  Eigen::Matrix<double, 2, N> yaw_pitch;
+  for (int i = 0; i < N; i++) yaw_pitch.col(i) = aim(nearest.col(i).head<3>(), bullet_speed);
 
+  Trajectory traj;
   for (int i = 0; i < HORIZON; i++) {
-    target.predict(DT);
-    auto yaw_pitch_next = aim(target, bullet_speed);
-
-    auto yaw_vel = tools::limit_rad(yaw_pitch_next(0) - yaw_pitch_last(0)) / (2 * DT);
-    auto pitch_vel = (yaw_pitch_next(1) - yaw_pitch_last(1)) / (2 * DT);
-
-    traj.col(i) << tools::limit_rad(yaw_pitch(0) - yaw0), yaw_vel, yaw_pitch(1), pitch_vel;
+    auto yaw_vel = tools::limit_rad(yaw_pitch(0, i + 2) - yaw_pitch(0, i)) / (2 * DT);
+    auto pitch_vel = (yaw_pitch(1, i + 2) - yaw_pitch(1, i)) / (2 * DT);
 
-    yaw_pitch_last = yaw_pitch;
-    yaw_pitch = yaw_pitch_next;
+    traj.col(i) << tools::limit_rad(yaw_pitch(0, i + 1) - yaw0), yaw_vel, yaw_pitch(1, i + 1),
+      pitch_vel;
   }
 
   return traj;
@@ -7,6 +7,7 @@
 
 #include "tasks/auto_aim/target.hpp"
 #include "tinympc/tiny_api.hpp"
+#include "tools/latency_histogram.hpp"
 
 namespace auto_aim
 {
@@ -39,11 +40,16 @@ public:
   Plan plan(Target target, double bullet_speed);
   Plan plan(std::optional<Target> target, double bullet_speed);
 
+  // 接入实测的命令延迟(如Gimbal::command_latency()), 样本足够时叠加在*_delay_time上,
+  // 此时*_delay_time只需覆盖下位机执行与发弹的延迟; 传入nullptr(未启用command_echo)时不叠加
+  void use_measured_latency(const tools::LatencyHistogram * command_latency);
+
 private:
   double yaw_offset_;
   double pitch_offset_;
   double fire_thresh_;
   double low_speed_delay_time_, high_speed_delay_time_, decision_speed_;
+  const tools::LatencyHistogram * command_latency_ = nullptr;
 
   TinySolver * yaw_solver_;
   TinySolver * pitch_solver_;
@@ -51,8 +57,10 @@ private:
   void setup_yaw_solver(const std::string & config_path);
   void setup_pitch_solver(const std::string & config_path);
 
-  Eigen::Matrix<double, 2, 1> aim(const Target & target, double bullet_speed);
-  Trajectory get_trajectory(Target & target, double yaw0, double bullet_speed);
+  // dt秒后瞄准距离最近的装甲板
+  Eigen::Matrix<double, 2, 1> aim(const Target & target, double dt, double bullet_speed);
+  Eigen::Matrix<double, 2, 1> aim(const Eigen::Vector3d & xyz, double bullet_speed);
+  Trajectory get_trajectory(const Target & target, double dt, double yaw0, double bullet_speed);
 };
 
 }  // namespace auto_aim
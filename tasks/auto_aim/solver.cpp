@@ -2,8 +2,10 @@
 
 #include <yaml-cpp/yaml.h>
 
+#include <array>
 #include <vector>
 
+#include "tools/ippe.hpp"
 #include "tools/logger.hpp"
 #include "tools/math_tools.hpp"
 
@@ -24,7 +26,16 @@ const std::vector<cv::Point3f> SMALL_ARMOR_POINTS{
   {0, -SMALL_ARMOR_WIDTH / 2, -LIGHTBAR_LENGTH / 2},
   {0, SMALL_ARMOR_WIDTH / 2, -LIGHTBAR_LENGTH / 2}};
 
-Solver::Solver(const std::string & config_path) : R_gimbal2world_(Eigen::Matrix3d::Identity())
+namespace
+{
+constexpr int SOLVE_BATCH = 8;  // solve_all每组的装甲板数
+
+using Points = Eigen::Matrix<double, 2, 4>;
+
+}  // namespace
+
+Solver::Solver(const std::string & config_path)
+: camera_(config_path), R_gimbal2world_(Eigen::Matrix3d::Identity())
 {
   auto yaml = YAML::LoadFile(config_path);
 
@@ -34,13 +45,6 @@ Solver::Solver(const std::string & config_path) : R_gimbal2world_(Eigen::Matrix3
   R_gimbal2imubody_ = Eigen::Matrix<double, 3, 3, Eigen::RowMajor>(R_gimbal2imubody_data.data());
   R_camera2gimbal_ = Eigen::Matrix<double, 3, 3, Eigen::RowMajor>(R_camera2gimbal_data.data());
   t_camera2gimbal_ = Eigen::Matrix<double, 3, 1>(t_camera2gimbal_data.data());
-
-  auto camera_matrix_data = yaml["camera_matrix"].as<std::vector<double>>();
-  auto distort_coeffs_data = yaml["distort_coeffs"].as<std::vector<double>>();
-  Eigen::Matrix<double, 3, 3, Eigen::RowMajor> camera_matrix(camera_matrix_data.data());
-  Eigen::Matrix<double, 1, 5> distort_coeffs(distort_coeffs_data.data());
-  cv::eigen2cv(camera_matrix, camera_matrix_);
-  cv::eigen2cv(distort_coeffs, distort_coeffs_);
 }
 
 Eigen::Matrix3d Solver::R_gimbal2world() const { return R_gimbal2world_; }
@@ -52,39 +56,99 @@ void Solver::set_R_gimbal2world(const Eigen::Quaterniond & q)
 }
 
 //solvePnP（获得姿态）
-void Solver::solve(Armor & armor) const
+void Solver::solve(Armor & armor, bool refine_yaw) const
 {
   const auto & object_points =
     (armor.type == ArmorType::big) ? BIG_ARMOR_POINTS : SMALL_ARMOR_POINTS;
 
   cv::Vec3d rvec, tvec;
   cv::solvePnP(
-    object_points, armor.points, camera_matrix_, distort_coeffs_, rvec, tvec, false,
-    cv::SOLVEPNP_IPPE);
+    object_points, armor.points, camera_.camera_matrix(), camera_.distort_coeffs(), rvec, tvec,
+    false, cv::SOLVEPNP_IPPE);
 
   Eigen::Vector3d xyz_in_camera;
   cv::cv2eigen(tvec, xyz_in_camera);
-  armor.xyz_in_gimbal = R_camera2gimbal_ * xyz_in_camera + t_camera2gimbal_;
-  armor.xyz_in_world = R_gimbal2world_ * armor.xyz_in_gimbal;
 
   cv::Mat rmat;
   cv::Rodrigues(rvec, rmat);
   Eigen::Matrix3d R_armor2camera;
   cv::cv2eigen(rmat, R_armor2camera);
-  Eigen::Matrix3d R_armor2gimbal = R_camera2gimbal_ * R_armor2camera;
-  Eigen::Matrix3d R_armor2world = R_gimbal2world_ * R_armor2gimbal;
-  armor.ypr_in_gimbal = tools::eulers(R_armor2gimbal, 2, 1, 0);
-  armor.ypr_in_world = tools::eulers(R_armor2world, 2, 1, 0);
+
+  set_pose(armor, R_armor2camera, xyz_in_camera, R_gimbal2world_ * R_camera2gimbal_, refine_yaw);
+}
+
+void Solver::solve_all(
+  std::list<Armor> & armors, const std::function<bool(const Armor &)> & filter,
+  bool refine_yaw) const
+{
+  Eigen::Matrix3d R_camera2world = R_gimbal2world_ * R_camera2gimbal_;
+
+  Armor * batch[SOLVE_BATCH];
+  int n = 0;
+  for (auto & armor : armors) {
+    if (filter && !filter(armor)) continue;
+    batch[n++] = &armor;
+    if (n == SOLVE_BATCH) {
+      solve_batch(batch, n, R_camera2world, refine_yaw);
+      n = 0;
+    }
+  }
+  if (n > 0) solve_batch(batch, n, R_camera2world, refine_yaw);
+}
+
+void Solver::solve_batch(
+  Armor ** armors, int n, const Eigen::Matrix3d & R_camera2world, bool refine_yaw) const
+{
+  // 平面坐标系(u, v, n)即装甲板坐标系的(y, z, x)
+  Eigen::Matrix3d R_plane2armor;
+  R_plane2armor << 0, 0, 1, 1, 0, 0, 0, 1, 0;
+
+  // 一组的4n个角点一次去畸变, 容量固定, 不分配内存
+  Eigen::Matrix<double, 2, Eigen::Dynamic, 0, 2, 4 * SOLVE_BATCH> pixels(2, 4 * n), image(2, 4 * n);
+  for (int i = 0; i < n; i++) {
+    for (int j = 0; j < 4; j++) {
+      pixels.col(4 * i + j) << armors[i]->points[j].x, armors[i]->points[j].y;
+    }
+  }
+  camera_.undistort(pixels, image);
+
+  for (int i = 0; i < n; i++) {
+    auto & armor = *armors[i];
+    const auto & object_points =
+      (armor.type == ArmorType::big) ? BIG_ARMOR_POINTS : SMALL_ARMOR_POINTS;
+
+    Points plane;
+    for (int j = 0; j < 4; j++) plane.col(j) << object_points[j].y, object_points[j].z;
+
+    Eigen::Matrix3d R_plane2camera;
+    Eigen::Vector3d xyz_in_camera;
+    tools::ippe(plane, image.middleCols<4>(4 * i), R_plane2camera, xyz_in_camera);
+
+    set_pose(
+      armor, R_plane2camera * R_plane2armor.transpose(), xyz_in_camera, R_camera2world, refine_yaw);
+  }
+}
+
+void Solver::set_pose(
+  Armor & armor, const Eigen::Matrix3d & R_armor2camera, const Eigen::Vector3d & xyz_in_camera,
+  const Eigen::Matrix3d & R_camera2world, bool refine_yaw) const
+{
+  armor.xyz_in_gimbal = R_camera2gimbal_ * xyz_in_camera + t_camera2gimbal_;
+  armor.xyz_in_world = R_gimbal2world_ * armor.xyz_in_gimbal;
+
+  armor.ypr_in_gimbal = tools::eulers(R_camera2gimbal_ * R_armor2camera, 2, 1, 0);
+  armor.ypr_in_world = tools::eulers(R_camera2world * R_armor2camera, 2, 1, 0);
 
   armor.ypd_in_world = tools::xyz2ypd(armor.xyz_in_world);
+  armor.yaw_raw = armor.ypr_in_world[0];
 
   // 平衡不做yaw优化，因为pitch假设不成立
   auto is_balance = (armor.type == ArmorType::big) &&
                     (armor.name == ArmorName::three || armor.name == ArmorName::four ||
                      armor.name == ArmorName::five);
-  if (is_balance) return;
+  if (is_balance || !refine_yaw) return;
 
-  optimize_yaw(armor);
+  armor.ypr_in_world[0] = optimize_yaw(armor);
 }
 
 std::vector<cv::Point2f> Solver::reproject_armor(
@@ -112,17 +176,14 @@ std::vector<cv::Point2f> Solver::reproject_armor(
   Eigen::Vector3d t_armor2camera =
     R_camera2gimbal_.transpose() * (R_gimbal2world_.transpose() * t_armor2world - t_camera2gimbal_);
 
-  // get rvec tvec
-  cv::Vec3d rvec;
-  cv::Mat R_armor2camera_cv;
-  cv::eigen2cv(R_armor2camera, R_armor2camera_cv);
-  cv::Rodrigues(R_armor2camera_cv, rvec);
-  cv::Vec3d tvec(t_armor2camera[0], t_armor2camera[1], t_armor2camera[2]);
-
   // reproject
   std::vector<cv::Point2f> image_points;
   const auto & object_points = (type == ArmorType::big) ? BIG_ARMOR_POINTS : SMALL_ARMOR_POINTS;
-  cv::projectPoints(object_points, rvec, tvec, camera_matrix_, distort_coeffs_, image_points);
+  for (const auto & p : object_points) {
+    Eigen::Vector2d uv =
+      camera_.project(R_armor2camera * Eigen::Vector3d(p.x, p.y, p.z) + t_armor2camera);
+    image_points.emplace_back(uv.x(), uv.y());
+  }
   return image_points;
 }
 
@@ -134,8 +195,8 @@ double Solver::oupost_reprojection_error(Armor armor, const double & pitch)
 
   cv::Vec3d rvec, tvec;
   cv::solvePnP(
-    object_points, armor.points, camera_matrix_, distort_coeffs_, rvec, tvec, false,
-    cv::SOLVEPNP_IPPE);
+    object_points, armor.points, camera_.camera_matrix(), camera_.distort_coeffs(), rvec, tvec,
+    false, cv::SOLVEPNP_IPPE);
 
   Eigen::Vector3d xyz_in_camera;
   cv::cv2eigen(tvec, xyz_in_camera);
@@ -186,14 +247,120 @@ double Solver::oupost_reprojection_error(Armor armor, const double & pitch)
 
   // reproject
   std::vector<cv::Point2f> image_points;
-  cv::projectPoints(object_points, _rvec, _tvec, camera_matrix_, distort_coeffs_, image_points);
+  cv::projectPoints(
+    object_points, _rvec, _tvec, camera_.camera_matrix(), camera_.distort_coeffs(), image_points);
 
   auto error = 0.0;
   for (int i = 0; i < 4; i++) error += cv::norm(armor.points[i] - image_points[i]);
   return error;
 }
 
-void Solver::optimize_yaw(Armor & armor) const
+double Solver::optimize_yaw(const Armor & armor) const
+{
+  constexpr double SEARCH_RANGE = 140 * CV_PI / 180.0;  // rad
+  constexpr double COARSE_STEP = 5 * CV_PI / 180.0;     // rad
+  constexpr double TOLERANCE = 0.05 * CV_PI / 180.0;    // rad
+  constexpr double GOLDEN = 0.6180339887498949;
+
+  Eigen::Vector3d gimbal_ypr = tools::eulers(R_gimbal2world_, 2, 1, 0);
+
+  // 与yaw无关的部分: R_armor2camera = R_world2camera * Rz(yaw) * Ry(pitch)
+  Eigen::Matrix3d R_world2camera = R_camera2gimbal_.transpose() * R_gimbal2world_.transpose();
+  Eigen::Vector3d t_armor2camera =
+    R_camera2gimbal_.transpose() *
+    (R_gimbal2world_.transpose() * armor.xyz_in_world - t_camera2gimbal_);
+
+  auto pitch = (armor.name == ArmorName::outpost) ? -15.0 * CV_PI / 180.0 : 15.0 * CV_PI / 180.0;
+  Eigen::Matrix3d R_pitch = Eigen::AngleAxisd(pitch, Eigen::Vector3d::UnitY()).toRotationMatrix();
+
+  const auto & object_points =
+    (armor.type == ArmorType::big) ? BIG_ARMOR_POINTS : SMALL_ARMOR_POINTS;
+  Eigen::Vector3d points[4];
+  for (int i = 0; i < 4; i++) {
+    const auto & p = object_points[i];
+    points[i] = R_pitch * Eigen::Vector3d(p.x, p.y, p.z);
+  }
+
+  // offset为相对云台yaw的偏移
+  auto error = [&](double offset) {
+    Eigen::Matrix3d R_armor2camera =
+      R_world2camera * Eigen::AngleAxisd(gimbal_ypr[0] + offset, Eigen::Vector3d::UnitZ());
+    auto sum = 0.0;
+    for (int i = 0; i < 4; i++) {
+      Eigen::Vector2d uv = camera_.project(R_armor2camera * points[i] + t_armor2camera);
+      sum += std::hypot(armor.points[i].x - uv.x(), armor.points[i].y - uv.y());
+    }
+    return sum;
+  };
+
+  // 粗搜索, 范围与旧方法相同: [-70°, 69°]
+  constexpr int COARSE_NUM = 28;
+  constexpr double MIN_OFFSET = -SEARCH_RANGE / 2;
+  constexpr double MAX_OFFSET = SEARCH_RANGE / 2 - CV_PI / 180.0;
+  std::array<double, COARSE_NUM> errors;
+  for (int i = 0; i < COARSE_NUM; i++) errors[i] = error(MIN_OFFSET + i * COARSE_STEP);
+
+  // 误差可能有两个相近的谷(yaw的二义性), 取最小的两个局部极小值
+  int first = -1, second = -1;
+  for (int i = 0; i < COARSE_NUM; i++) {
+    auto is_min = (i == 0 || errors[i] <= errors[i - 1]) &&
+                  (i == COARSE_NUM - 1 || errors[i] < errors[i + 1]);
+    if (!is_min) continue;
+    if (first < 0 || errors[i] < errors[first]) {
+      second = first;
+      first = i;
+    } else if (second < 0 || errors[i] < errors[second]) {
+      second = i;
+    }
+  }
+
+  // 误差全为NaN(如投影失败)时没有极小值, 保留IPPE的结果
+  if (first < 0) return armor.yaw_raw;
+
+  auto best_offset = MIN_OFFSET + first * COARSE_STEP;
+  auto min_error = errors[first];
+
+  // 黄金分割细化, 误差在种子附近单峰
+  auto refine = [&](double seed) {
+    auto a = std::max(seed - COARSE_STEP, MIN_OFFSET);
+    auto b = std::min(seed + COARSE_STEP, MAX_OFFSET);
+    auto c = b - GOLDEN * (b - a);
+    auto d = a + GOLDEN * (b - a);
+    auto ec = error(c);
+    auto ed = error(d);
+    while (b - a > TOLERANCE) {
+      if (ec < ed) {
+        b = d, d = c, ed = ec;
+        c = b - GOLDEN * (b - a);
+        ec = error(c);
+      } else {
+        a = c, c = d, ec = ed;
+        d = a + GOLDEN * (b - a);
+        ed = error(d);
+      }
+    }
+
+    auto offset = (a + b) / 2;
+    auto e = error(offset);
+    if (e < min_error) {
+      min_error = e;
+      best_offset = offset;
+    }
+  };
+
+  auto coarse_offset = best_offset;
+  refine(coarse_offset);
+  if (second >= 0) refine(MIN_OFFSET + second * COARSE_STEP);
+
+  // IPPE的yaw离粗搜索结果较远时, 也在它附近细化一次
+  auto ippe_offset = tools::limit_rad(armor.yaw_raw - gimbal_ypr[0]);
+  auto ippe_in_range = ippe_offset >= MIN_OFFSET && ippe_offset <= MAX_OFFSET;
+  if (ippe_in_range && std::abs(ippe_offset - coarse_offset) > COARSE_STEP) refine(ippe_offset);
+
+  return tools::limit_rad(gimbal_ypr[0] + best_offset);
+}
+
+double Solver::optimize_yaw_brute_force(const Armor & armor) const
 {
   Eigen::Vector3d gimbal_ypr = tools::eulers(R_gimbal2world_, 2, 1, 0);
 
@@ -213,8 +380,7 @@ void Solver::optimize_yaw(Armor & armor) const
     }
   }
 
-  armor.yaw_raw = armor.ypr_in_world[0];
-  armor.ypr_in_world[0] = best_yaw;
+  return best_yaw;
 }
 
 double Solver::SJTU_cost(
@@ -268,26 +434,17 @@ std::vector<cv::Point2f> Solver::world2pixel(const std::vector<cv::Point3f> & wo
   Eigen::Matrix3d R_world2camera = R_camera2gimbal_.transpose() * R_gimbal2world_.transpose();
   Eigen::Vector3d t_world2camera = -R_camera2gimbal_.transpose() * t_camera2gimbal_;
 
-  cv::Mat rvec;
-  cv::Mat tvec;
-  cv::eigen2cv(R_world2camera, rvec);
-  cv::eigen2cv(t_world2camera, tvec);
-
-  std::vector<cv::Point3f> valid_world_points;
+  // 只投影相机前方的点, 没有有效点时返回空vector
+  std::vector<cv::Point2f> pixelPoints;
   for (const auto & world_point : worldPoints) {
     Eigen::Vector3d world_point_eigen(world_point.x, world_point.y, world_point.z);
     Eigen::Vector3d camera_point = R_world2camera * world_point_eigen + t_world2camera;
 
     if (camera_point.z() > 0) {
-      valid_world_points.push_back(world_point);
+      Eigen::Vector2d uv = camera_.project(camera_point);
+      pixelPoints.emplace_back(uv.x(), uv.y());
     }
   }
-  // 如果没有有效点，返回空vector
-  if (valid_world_points.empty()) {
-    return std::vector<cv::Point2f>();
-  }
-  std::vector<cv::Point2f> pixelPoints;
-  cv::projectPoints(valid_world_points, rvec, tvec, camera_matrix_, distort_coeffs_, pixelPoints);
   return pixelPoints;
 }
 }  // namespace auto_aim
\ No newline at end of file
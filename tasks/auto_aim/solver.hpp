@@ -5,7 +5,12 @@
 #include <Eigen/Geometry>
 #include <opencv2/core/eigen.hpp>
 
+#include <functional>
+#include <list>
+#include <vector>
+
 #include "armor.hpp"
+#include "tools/camera_model.hpp"
 
 namespace auto_aim
 {
@@ -18,7 +23,15 @@ public:
 
   void set_R_gimbal2world(const Eigen::Quaterniond & q);
 
-  void solve(Armor & armor) const;
+  // cv::solvePnP(IPPE), 作为solve_all的参照
+  // refine_yaw为false时只做PnP, 不调用optimize_yaw
+  void solve(Armor & armor, bool refine_yaw = true) const;
+
+  // 角点查表去畸变, 再在Eigen中用固定尺寸的单应矩阵做IPPE, 不分配内存
+  // 与逐个solve()结果一致, 每帧的旋转矩阵乘积只计算一次; filter不为空时只解算满足条件的装甲板
+  void solve_all(
+    std::list<Armor> & armors, const std::function<bool(const Armor &)> & filter = nullptr,
+    bool refine_yaw = true) const;
 
   std::vector<cv::Point2f> reproject_armor(
     const Eigen::Vector3d & xyz_in_world, double yaw, ArmorType type, ArmorName name) const;
@@ -27,15 +40,28 @@ public:
 
   std::vector<cv::Point2f> world2pixel(const std::vector<cv::Point3f> & worldPoints);
 
+  // 在云台yaw±70°内搜索重投影误差最小的世界系yaw, armor需已经过solve()
+  // 先以5°为步长粗搜索, 再以粗搜索的局部极小值与IPPE的yaw为种子黄金分割细化
+  double optimize_yaw(const Armor & armor) const;
+
+  // 以1°为步长逐一计算的旧方法, 用于对比
+  double optimize_yaw_brute_force(const Armor & armor) const;
+
 private:
-  cv::Mat camera_matrix_;
-  cv::Mat distort_coeffs_;
+  tools::CameraModel camera_;
   Eigen::Matrix3d R_gimbal2imubody_;
   Eigen::Matrix3d R_camera2gimbal_;
   Eigen::Vector3d t_camera2gimbal_;
   Eigen::Matrix3d R_gimbal2world_;
 
-  void optimize_yaw(Armor & armor) const;
+  // solve_all中的一组, 同一帧的n(<=SOLVE_BATCH)个装甲板, 4n个角点一次去畸变后逐个IPPE
+  void solve_batch(
+    Armor ** armors, int n, const Eigen::Matrix3d & R_camera2world, bool refine_yaw) const;
+
+  // 由PnP得到的相机系位姿填写装甲板的位置与姿态, refine_yaw时再优化yaw
+  void set_pose(
+    Armor & armor, const Eigen::Matrix3d & R_armor2camera, const Eigen::Vector3d & xyz_in_camera,
+    const Eigen::Matrix3d & R_camera2world, bool refine_yaw) const;
 
   double armor_reprojection_error(const Armor & armor, double yaw, const double & inclined) const;
   double SJTU_cost(
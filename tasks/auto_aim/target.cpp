@@ -23,8 +23,8 @@ Target::Target(
 {
   auto r = radius;
   priority = armor.priority;
-  const Eigen::VectorXd & xyz = armor.xyz_in_world;
-  const Eigen::VectorXd & ypr = armor.ypr_in_world;
+  const Eigen::Vector3d & xyz = armor.xyz_in_world;
+  const Eigen::Vector3d & ypr = armor.ypr_in_world;
 
   // 旋转中心的坐标
   auto center_x = xyz[0] + r * std::cos(ypr[0]);
@@ -36,33 +36,25 @@ Target::Target(
   // w: angular velocity
   // l: r2 - r1
   // h: z2 - z1
-  Eigen::VectorXd x0{{center_x, 0, center_y, 0, center_z, 0, ypr[0], 0, r, 0, 0}};  //初始化预测量
-  Eigen::MatrixXd P0 = P0_dig.asDiagonal();
+  State x0{{center_x, 0, center_y, 0, center_z, 0, ypr[0], 0, r, 0, 0}};  //初始化预测量
+  EKF::MatrixX P0 = P0_dig.asDiagonal();
 
-  // 防止夹角求和出现异常值
-  auto x_add = [](const Eigen::VectorXd & a, const Eigen::VectorXd & b) -> Eigen::VectorXd {
-    Eigen::VectorXd c = a + b;
-    c[6] = tools::limit_rad(c[6]);
-    return c;
-  };
-
-  ekf_ = tools::ExtendedKalmanFilter(x0, P0, x_add);  //初始化滤波器（预测量、预测量协方差）
+  ekf_ = EKF(x0, P0);  //初始化滤波器（预测量、预测量协方差）
 }
 
 Target::Target(double x, double vyaw, double radius, double h) : armor_num_(4)
 {
-  Eigen::VectorXd x0{{x, 0, 0, 0, 0, 0, 0, vyaw, radius, 0, h}};
-  Eigen::VectorXd P0_dig{{0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0}};
-  Eigen::MatrixXd P0 = P0_dig.asDiagonal();
+  State x0{{x, 0, 0, 0, 0, 0, 0, vyaw, radius, 0, h}};
+  EKF::MatrixX P0 = EKF::MatrixX::Zero();
 
-  // 防止夹角求和出现异常值
-  auto x_add = [](const Eigen::VectorXd & a, const Eigen::VectorXd & b) -> Eigen::VectorXd {
-    Eigen::VectorXd c = a + b;
-    c[6] = tools::limit_rad(c[6]);
-    return c;
-  };
+  ekf_ = EKF(x0, P0);  //初始化滤波器（预测量、预测量协方差）
+}
 
-  ekf_ = tools::ExtendedKalmanFilter(x0, P0, x_add);  //初始化滤波器（预测量、预测量协方差）
+Target::State Target::StateAdd::operator()(const State & a, const State & b) const
+{
+  State c = a + b;
+  c[6] = tools::limit_rad(c[6]);
+  return c;
 }
 
 void Target::predict(std::chrono::steady_clock::time_point t)
@@ -76,7 +68,7 @@ void Target::predict(double dt)
 {
   // 状态转移矩阵
   // clang-format off
-  Eigen::MatrixXd F{
+  EKF::MatrixX F{
     {1, dt,  0,  0,  0,  0,  0,  0,  0,  0,  0},
     {0,  1,  0,  0,  0,  0,  0,  0,  0,  0,  0},
     {0,  0,  1, dt,  0,  0,  0,  0,  0,  0,  0},
@@ -106,7 +98,7 @@ void Target::predict(double dt)
   auto c = dt * dt;
   // 预测过程噪声偏差的方差
   // clang-format off
-  Eigen::MatrixXd Q{
+  EKF::MatrixX Q{
     {a * v1, b * v1,      0,      0,      0,      0,      0,      0, 0, 0, 0},
     {b * v1, c * v1,      0,      0,      0,      0,      0,      0, 0, 0, 0},
     {     0,      0, a * v1, b * v1,      0,      0,      0,      0, 0, 0, 0},
@@ -122,8 +114,8 @@ void Target::predict(double dt)
   // clang-format on
 
   // 防止夹角求和出现异常值
-  auto f = [&](const Eigen::VectorXd & x) -> Eigen::VectorXd {
-    Eigen::VectorXd x_prior = F * x;
+  auto f = [&](const State & x) -> State {
+    State x_prior = F * x;
     x_prior[6] = tools::limit_rad(x_prior[6]);
     return x_prior;
   };
@@ -187,57 +179,77 @@ void Target::update(const Armor & armor)
 void Target::update_ypda(const Armor & armor, int id)
 {
   //观测jacobi
-  Eigen::MatrixXd H = h_jacobian(ekf_.x, id);
+  Eigen::Matrix<double, 4, 11> H = h_jacobian(ekf_.x, id);
   // Eigen::VectorXd R_dig{{4e-3, 4e-3, 1, 9e-2}};
   auto center_yaw = std::atan2(armor.xyz_in_world[1], armor.xyz_in_world[0]);
   auto delta_angle = tools::limit_rad(armor.ypr_in_world[0] - center_yaw);
-  Eigen::VectorXd R_dig{
+  Eigen::Vector4d R_dig{
     {4e-3, 4e-3, log(std::abs(delta_angle) + 1) + 1,
      log(std::abs(armor.ypd_in_world[2]) + 1) / 200 + 9e-2}};
 
   //测量过程噪声偏差的方差
-  Eigen::MatrixXd R = R_dig.asDiagonal();
+  Eigen::Matrix4d R = R_dig.asDiagonal();
 
   // 定义非线性转换函数h: x -> z
-  auto h = [&](const Eigen::VectorXd & x) -> Eigen::Vector4d {
-    Eigen::VectorXd xyz = h_armor_xyz(x, id);
-    Eigen::VectorXd ypd = tools::xyz2ypd(xyz);
+  auto h = [&](const State & x) -> Eigen::Vector4d {
+    Eigen::Vector3d xyz = h_armor_xyz(x, id);
+    Eigen::Vector3d ypd = tools::xyz2ypd(xyz);
     auto angle = tools::limit_rad(x[6] + id * 2 * CV_PI / armor_num_);
     return {ypd[0], ypd[1], ypd[2], angle};
   };
 
   // 防止夹角求差出现异常值
-  auto z_subtract = [](const Eigen::VectorXd & a, const Eigen::VectorXd & b) -> Eigen::VectorXd {
-    Eigen::VectorXd c = a - b;
+  auto z_subtract = [](const Eigen::Vector4d & a, const Eigen::Vector4d & b) -> Eigen::Vector4d {
+    Eigen::Vector4d c = a - b;
     c[0] = tools::limit_rad(c[0]);
     c[1] = tools::limit_rad(c[1]);
     c[3] = tools::limit_rad(c[3]);
     return c;
   };
 
-  const Eigen::VectorXd & ypd = armor.ypd_in_world;
-  const Eigen::VectorXd & ypr = armor.ypr_in_world;
-  Eigen::VectorXd z{{ypd[0], ypd[1], ypd[2], ypr[0]}};  //获得观测量
+  const Eigen::Vector3d & ypd = armor.ypd_in_world;
+  const Eigen::Vector3d & ypr = armor.ypr_in_world;
+  Eigen::Vector4d z{{ypd[0], ypd[1], ypd[2], ypr[0]}};  //获得观测量
 
   ekf_.update(z, H, R, h, z_subtract);
 }
 
 Eigen::VectorXd Target::ekf_x() const { return ekf_.x; }
 
-const tools::ExtendedKalmanFilter & Target::ekf() const { return ekf_; }
+const Target::EKF & Target::ekf() const { return ekf_; }
+
+void Target::set_ekf_diagnostics(bool enable) { ekf_.diagnose = enable; }
 
 std::vector<Eigen::Vector4d> Target::armor_xyza_list() const
 {
   std::vector<Eigen::Vector4d> _armor_xyza_list;
 
   for (int i = 0; i < armor_num_; i++) {
-    auto angle = tools::limit_rad(ekf_.x[6] + i * 2 * CV_PI / armor_num_);
-    Eigen::Vector3d xyz = h_armor_xyz(ekf_.x, i);
-    _armor_xyza_list.push_back({xyz[0], xyz[1], xyz[2], angle});
+    _armor_xyza_list.push_back(armor_xyza(ekf_.x, i));
   }
   return _armor_xyza_list;
 }
 
+int Target::armor_num() const { return armor_num_; }
+
+Target::State Target::predicted_state(double dt) const
+{
+  State x = ekf_.x;
+  x[7] = predicted_w();
+  x[0] += x[1] * dt;
+  x[2] += x[3] * dt;
+  x[4] += x[5] * dt;
+  x[6] = tools::limit_rad(x[6] + x[7] * dt);
+  return x;
+}
+
+Eigen::Vector4d Target::armor_xyza(const State & x, int id) const
+{
+  auto angle = tools::limit_rad(x[6] + id * 2 * CV_PI / armor_num_);
+  Eigen::Vector3d xyz = h_armor_xyz(x, id);
+  return {xyz[0], xyz[1], xyz[2], angle};
+}
+
 bool Target::diverged() const
 {
   auto r_ok = ekf_.x[8] > 0.05 && ekf_.x[8] < 0.5;
@@ -263,8 +275,19 @@ bool Target::convergened()
   return is_converged_;
 }
 
+double Target::predicted_w() const
+{
+  auto w = ekf_.x[7];
+  if (this->name != ArmorName::outpost || std::abs(w) <= 2) return w;
+
+  // 与convergened()的判断相同, 但不修改is_converged_
+  auto converged = is_converged_ || (update_count_ > 10 && !this->diverged());
+  if (!converged) return w;
+  return w > 0 ? 2.51 : -2.51;
+}
+
 // 计算出装甲板中心的坐标（考虑长短轴）
-Eigen::Vector3d Target::h_armor_xyz(const Eigen::VectorXd & x, int id) const
+Eigen::Vector3d Target::h_armor_xyz(const State & x, int id) const
 {
   auto angle = tools::limit_rad(x[6] + id * 2 * CV_PI / armor_num_);
   auto use_l_h = (armor_num_ == 4) && (id == 1 || id == 3);
@@ -277,7 +300,7 @@ Eigen::Vector3d Target::h_armor_xyz(const Eigen::VectorXd & x, int id) const
   return {armor_x, armor_y, armor_z};
 }
 
-Eigen::MatrixXd Target::h_jacobian(const Eigen::VectorXd & x, int id) const
+Eigen::Matrix<double, 4, 11> Target::h_jacobian(const State & x, int id) const
 {
   auto angle = tools::limit_rad(x[6] + id * 2 * CV_PI / armor_num_);
   auto use_l_h = (armor_num_ == 4) && (id == 1 || id == 3);
@@ -294,7 +317,7 @@ Eigen::MatrixXd Target::h_jacobian(const Eigen::VectorXd & x, int id) const
   auto dz_dh = (use_l_h) ? 1.0 : 0.0;
 
   // clang-format off
-  Eigen::MatrixXd H_armor_xyza{
+  Eigen::Matrix<double, 4, 11> H_armor_xyza{
     {1, 0, 0, 0, 0, 0, dx_da, 0, dx_dr, dx_dl,     0},
     {0, 0, 1, 0, 0, 0, dy_da, 0, dy_dr, dy_dl,     0},
     {0, 0, 0, 0, 1, 0,     0, 0,     0,     0, dz_dh},
@@ -302,10 +325,10 @@ Eigen::MatrixXd Target::h_jacobian(const Eigen::VectorXd & x, int id) const
   };
   // clang-format on
 
-  Eigen::VectorXd armor_xyz = h_armor_xyz(x, id);
-  Eigen::MatrixXd H_armor_ypd = tools::xyz2ypd_jacobian(armor_xyz);
+  Eigen::Vector3d armor_xyz = h_armor_xyz(x, id);
+  Eigen::Matrix3d H_armor_ypd = tools::xyz2ypd_jacobian(armor_xyz);
   // clang-format off
-  Eigen::MatrixXd H_armor_ypda{
+  Eigen::Matrix4d H_armor_ypda{
     {H_armor_ypd(0, 0), H_armor_ypd(0, 1), H_armor_ypd(0, 2), 0},
     {H_armor_ypd(1, 0), H_armor_ypd(1, 1), H_armor_ypd(1, 2), 0},
     {H_armor_ypd(2, 0), H_armor_ypd(2, 1), H_armor_ypd(2, 2), 0},
@@ -17,6 +17,18 @@ namespace auto_aim
 class Target
 {
 public:
+  // x vx y vy z vz a w r l h
+  using State = Eigen::Matrix<double, 11, 1>;
+
+  // 防止夹角求和出现异常值
+  struct StateAdd
+  {
+    State operator()(const State & a, const State & b) const;
+  };
+
+  // 观测为装甲板的yaw pitch distance angle
+  using EKF = tools::ExtendedKalmanFilter<11, 4, StateAdd>;
+
   ArmorName name;
   ArmorType armor_type;
   ArmorPriority priority;
@@ -34,11 +46,26 @@ public:
   void update(const Armor & armor);
 
   Eigen::VectorXd ekf_x() const;
-  const tools::ExtendedKalmanFilter & ekf() const;
+  const EKF & ekf() const;
   std::vector<Eigen::Vector4d> armor_xyza_list() const;
+  int armor_num() const;
+
+  // 只外推状态的闭式预测, 不传播协方差也不修改Target, 供规划、迭代求解飞行时间使用
+  // dt秒后的状态, 与predict(dt)后的ekf().x相同
+  State predicted_state(double dt) const;
+
+  // 状态x下第id块装甲板的xyza
+  Eigen::Vector4d armor_xyza(const State & x, int id) const;
+
+  // dts各时刻第id块装甲板的xyza, 每列对应一个时刻, 逐元素计算便于向量化且不分配内存
+  template <int N>
+  Eigen::Matrix<double, 4, N> armor_xyza_at(const Eigen::Array<double, N, 1> & dts, int id) const;
 
   bool diverged() const;
 
+  // 卡方检验数据默认不计算, 调试时开启
+  void set_ekf_diagnostics(bool enable);
+
   bool convergened();
 
   bool isinit = false;
@@ -52,15 +79,39 @@ private:
 
   bool is_switch_, is_converged_;
 
-  tools::ExtendedKalmanFilter ekf_;
+  EKF ekf_;
   std::chrono::steady_clock::time_point t_;
 
   void update_ypda(const Armor & armor, int id);  // yaw pitch distance angle
 
-  Eigen::Vector3d h_armor_xyz(const Eigen::VectorXd & x, int id) const;
-  Eigen::MatrixXd h_jacobian(const Eigen::VectorXd & x, int id) const;
+  Eigen::Vector3d h_armor_xyz(const State & x, int id) const;
+  Eigen::Matrix<double, 4, 11> h_jacobian(const State & x, int id) const;
+
+  // 预测时使用的角速度, 含前哨站转速特判
+  double predicted_w() const;
 };
 
+template <int N>
+Eigen::Matrix<double, 4, N> Target::armor_xyza_at(
+  const Eigen::Array<double, N, 1> & dts, int id) const
+{
+  const State & x = ekf_.x;
+  auto use_l_h = (armor_num_ == 4) && (id == 1 || id == 3);
+  auto r = (use_l_h) ? x[8] + x[9] : x[8];
+  auto z = (use_l_h) ? x[4] + x[10] : x[4];
+
+  Eigen::Array<double, N, 1> angle = x[6] + id * 2 * CV_PI / armor_num_ + predicted_w() * dts;
+
+  Eigen::Matrix<double, 4, N> xyza;
+  xyza.row(0) = (x[0] + x[1] * dts - r * angle.cos()).transpose().matrix();
+  xyza.row(1) = (x[2] + x[3] * dts - r * angle.sin()).transpose().matrix();
+  xyza.row(2) = (z + x[5] * dts).transpose().matrix();
+  // 与tools::limit_rad相同, 限制在(-pi, pi]
+  xyza.row(3) =
+    (angle - 2 * CV_PI * ((angle - CV_PI) / (2 * CV_PI)).ceil()).transpose().matrix();
+  return xyza;
+}
+
 }  // namespace auto_aim
 
 #endif  // AUTO_AIM__TARGET_HPP
\ No newline at end of file
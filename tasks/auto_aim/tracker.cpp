@@ -28,6 +28,29 @@ Tracker::Tracker(const std::string & config_path, Solver & solver)
 
 std::string Tracker::state() const { return state_; }
 
+void Tracker::set_ekf_diagnostics(bool enable) { ekf_diagnostics_ = enable; }
+
+std::optional<cv::Rect> Tracker::roi(std::chrono::steady_clock::time_point t) const
+{
+  if (state_ != "tracking") return std::nullopt;
+
+  // 两帧间的平移与旋转都体现在预测前后装甲板位置的差异中
+  // 只需预测状态, 不复制Target、不传播协方差
+  auto dt = tools::delta_time(t, last_timestamp_);
+
+  std::vector<cv::Point2f> points;
+  for (const Target::State & x : {Target::State(target_.ekf().x), target_.predicted_state(dt)}) {
+    for (int id = 0; id < target_.armor_num(); id++) {
+      Eigen::Vector4d xyza = target_.armor_xyza(x, id);
+      auto image_points =
+        solver_.reproject_armor(xyza.head(3), xyza[3], target_.armor_type, target_.name);
+      points.insert(points.end(), image_points.begin(), image_points.end());
+    }
+  }
+
+  return cv::boundingRect(points);
+}
+
 std::list<Target> Tracker::track(
   std::list<Armor> & armors, std::chrono::steady_clock::time_point t, bool use_enemy_color)
 {
@@ -80,10 +103,7 @@ std::list<Target> Tracker::track(
   }
 
   // 收敛效果检测：
-  if (
-    std::accumulate(
-      target_.ekf().recent_nis_failures.begin(), target_.ekf().recent_nis_failures.end(), 0) >=
-    (0.4 * target_.ekf().window_size)) {
+  if (target_.ekf().nis_fail_count() >= 0.4 * Target::EKF::WINDOW_SIZE) {
     tools::logger()->debug("[Target] Bad Converge Found!");
     state_ = "lost";
     return {};
@@ -260,6 +280,7 @@ bool Tracker::set_target(std::list<Armor> & armors, std::chrono::steady_clock::t
     target_ = Target(armor, t, 0.2, 4, P0_dig);
   }
 
+  target_.set_ekf_diagnostics(ekf_diagnostics_);
   return true;
 }
 
@@ -267,25 +288,26 @@ bool Tracker::update_target(std::list<Armor> & armors, std::chrono::steady_clock
 {
   target_.predict(t);
 
+  auto is_target = [this](const Armor & armor) {
+    return armor.name == target_.name && armor.type == target_.armor_type;
+    //  && armor.center.x == min_x
+  };
+
   int found_count = 0;
   double min_x = 1e10;  // 画面最左侧
   for (const auto & armor : armors) {
-    if (armor.name != target_.name || armor.type != target_.armor_type) continue;
+    if (!is_target(armor)) continue;
     found_count++;
     min_x = armor.center.x < min_x ? armor.center.x : min_x;
   }
 
   if (found_count == 0) return false;
 
-  for (auto & armor : armors) {
-    if (
-      armor.name != target_.name || armor.type != target_.armor_type
-      //  || armor.center.x != min_x
-    )
-      continue;
-
-    solver_.solve(armor);
+  // 同一帧的目标装甲板一起解算
+  solver_.solve_all(armors, is_target);
 
+  for (const auto & armor : armors) {
+    if (!is_target(armor)) continue;
     target_.update(armor);
   }
 
@@ -4,6 +4,7 @@
 #include <Eigen/Dense>
 #include <chrono>
 #include <list>
+#include <optional>
 #include <string>
 
 #include "armor.hpp"
@@ -21,6 +22,13 @@ public:
 
   std::string state() const;
 
+  // 之后创建的Target计算卡方检验数据, 供调试程序绘图
+  void set_ekf_diagnostics(bool enable);
+
+  // 目标在图像中的区域: 上一帧与预测到t时刻的全部装甲板重投影后的外接矩形, 用于动态ROI
+  // 须在solver.set_R_gimbal2world()之后调用; 不在tracking状态时为空
+  std::optional<cv::Rect> roi(std::chrono::steady_clock::time_point t) const;
+
   std::list<Target> track(
     std::list<Armor> & armors, std::chrono::steady_clock::time_point t,
     bool use_enemy_color = true);
@@ -42,6 +50,7 @@ private:
   Target target_;
   std::chrono::steady_clock::time_point last_timestamp_;
   ArmorPriority omni_target_priority_;
+  bool ekf_diagnostics_ = false;
 
   void state_machine(bool found);
 
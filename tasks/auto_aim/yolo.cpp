@@ -2,32 +2,58 @@
 
 #include <yaml-cpp/yaml.h>
 
+#include <algorithm>
+
+#include "tools/logger.hpp"
+#include "tools/math_tools.hpp"
 #include "yolos/yolo11.hpp"
 #include "yolos/yolov5.hpp"
 #include "yolos/yolov8.hpp"
 
 namespace auto_aim
 {
-YOLO::YOLO(const std::string & config_path, bool debug)
+YOLO::YOLO(const std::string & config_path, bool debug) : YOLO(config_path, debug, true) {}
+
+YOLO YOLO::postprocessor(const std::string & config_path, bool debug)
+{
+  return YOLO(config_path, debug, false);
+}
+
+YOLO::YOLO(const std::string & config_path, bool debug, bool load_model)
 {
   auto yaml = YAML::LoadFile(config_path);
   auto yolo_name = yaml["yolo_name"].as<std::string>();
 
   if (yolo_name == "yolov8") {
-    yolo_ = std::make_unique<YOLOV8>(config_path, debug);
+    yolo_ = std::make_unique<YOLOV8>(config_path, debug, load_model);
   }
 
   else if (yolo_name == "yolo11") {
-    yolo_ = std::make_unique<YOLO11>(config_path, debug);
+    yolo_ = std::make_unique<YOLO11>(config_path, debug, load_model);
   }
 
   else if (yolo_name == "yolov5") {
-    yolo_ = std::make_unique<YOLOV5>(config_path, debug);
+    yolo_ = std::make_unique<YOLOV5>(config_path, debug, load_model);
   }
 
   else {
     throw std::runtime_error("Unknown yolo name: " + yolo_name + "!");
   }
+
+  if (yaml["dynamic_roi"] && load_model) dynamic_roi_ = yaml["dynamic_roi"].as<bool>();
+  if (yaml["roi_input_size"]) roi_input_size_ = yaml["roi_input_size"].as<int>();
+  if (yaml["roi_margin"]) roi_margin_ = yaml["roi_margin"].as<double>();
+  if (yaml["roi_full_interval"]) roi_full_interval_ = yaml["roi_full_interval"].as<int>();
+  last_log_time_ = std::chrono::steady_clock::now();
+
+  // 加载时确认模型能以roi_input_size推理, 而不是在第一次进入ROI时才失败
+  if (dynamic_roi_ && !yolo_->load_roi_model(roi_input_size_)) {
+    tools::logger()->warn(
+      "[YOLO] {} model does not support roi_input_size {}, dynamic_roi disabled. Set "
+      "dynamic_roi: false in {}.",
+      yolo_name, roi_input_size_, config_path);
+    dynamic_roi_ = false;
+  }
 }
 
 std::list<Armor> YOLO::detect(const cv::Mat & img, int frame_count)
@@ -35,10 +61,120 @@ std::list<Armor> YOLO::detect(const cv::Mat & img, int frame_count)
   return yolo_->detect(img, frame_count);
 }
 
+bool YOLOBase::load_roi_model(int input_size)
+{
+  if (input_size == model_->config().input_size) return true;
+
+  try {
+    roi_model_ = InferenceEngine::instance().load(
+      {model_path_, device_, ov::hint::PerformanceMode::LATENCY, input_size});
+  } catch (const std::exception & e) {
+    tools::logger()->warn(
+      "[YOLO] Unable to reshape {} to {}x{}: {}", model_path_, input_size, input_size, e.what());
+    return false;
+  }
+  return true;
+}
+
+std::list<Armor> YOLOBase::detect_raw(
+  const cv::Mat & raw_img, io::BayerPattern pattern, const cv::Rect & roi, int input_size,
+  int frame_count)
+{
+  if (pattern == io::BayerPattern::none)
+    return roi.empty() ? detect(raw_img, frame_count)
+                       : detect(raw_img, roi, input_size, frame_count);
+
+  if (roi.empty()) {
+    io::demosaic(raw_img, pattern, demosaiced_);
+    return detect(demosaiced_, frame_count);
+  }
+
+  // roi以外保留旧的内容, 推理只读取roi内的像素
+  demosaiced_.create(raw_img.size(), CV_8UC3);
+  cv::Mat bgr_roi;
+  io::demosaic(raw_img, pattern, roi, bgr_roi);
+  bgr_roi.copyTo(demosaiced_(roi));
+  return detect(demosaiced_, roi, input_size, frame_count);
+}
+
+std::list<Armor> YOLO::detect(
+  const cv::Mat & img, const std::optional<cv::Rect> & hint, int frame_count)
+{
+  return detect(img, io::BayerPattern::none, hint, frame_count);
+}
+
+std::list<Armor> YOLO::detect(
+  const cv::Mat & img, io::BayerPattern pattern, const std::optional<cv::Rect> & hint,
+  int frame_count)
+{
+  cv::Rect roi;
+  if (dynamic_roi_ && hint.has_value() && !img.empty() && frames_since_full_ < roi_full_interval_)
+    roi = expand(*hint, img.size());
+
+  if (roi.empty()) return detect_full(img, pattern, frame_count);
+
+  frames_since_full_++;
+  roi_stats_.roi_frames++;
+  auto armors = yolo_->detect_raw(img, pattern, roi, roi_input_size_, frame_count);
+  if (!armors.empty()) roi_stats_.roi_hits++;
+
+  auto now = std::chrono::steady_clock::now();
+  if (tools::delta_time(now, last_log_time_) > 5.0) {
+    tools::logger()->debug(
+      "[YOLO] roi hit rate {:.1f}% ({}/{}), full frames {}", roi_stats_.hit_rate() * 100,
+      roi_stats_.roi_hits, roi_stats_.roi_frames, roi_stats_.full_frames);
+    last_log_time_ = now;
+  }
+
+  // ROI内未检出: 目标可能已跑出ROI, 下一帧在整幅图像上推理
+  // 不在本帧重新推理, 避免一帧内推理两次
+  if (armors.empty()) frames_since_full_ = roi_full_interval_;
+
+  return armors;
+}
+
 std::list<Armor> YOLO::postprocess(
-  double scale, cv::Mat & output, const cv::Mat & bgr_img, int frame_count)
+  double scale, cv::Mat & output, const cv::Mat & bgr_img, int frame_count,
+  const cv::Point2f & offset)
+{
+  return yolo_->postprocess(scale, output, bgr_img, offset, frame_count);
+}
+
+void YOLO::prepare(const cv::Size & img_size, io::BayerPattern pattern)
 {
-  return yolo_->postprocess(scale, output, bgr_img, frame_count);
+  yolo_->load_letterbox_model(img_size, pattern);
+}
+
+YOLO::RoiStats YOLO::roi_stats() const { return roi_stats_; }
+
+std::list<Armor> YOLO::detect_full(
+  const cv::Mat & img, io::BayerPattern pattern, int frame_count)
+{
+  frames_since_full_ = 0;
+  roi_stats_.full_frames++;
+  return yolo_->detect_raw(img, pattern, {}, 0, frame_count);
+}
+
+cv::Rect YOLO::expand(const cv::Rect & hint, const cv::Size & img_size) const
+{
+  if ((hint & cv::Rect(cv::Point(0, 0), img_size)).empty()) return {};
+
+  // 每侧外扩roi_margin倍后补成正方形, letterbox时不浪费网络输入
+  // 边长不小于roi_input_size, 保证ROI内不会放大图像
+  auto side = static_cast<int>(std::max(hint.width, hint.height) * (1 + 2 * roi_margin_));
+  side = std::max(side, roi_input_size_);
+  auto w = std::min(side, img_size.width);
+  auto h = std::min(side, img_size.height);
+
+  // 已接近整幅图像时ROI没有收益
+  if (w * h > 0.8 * img_size.area()) return {};
+
+  // 以hint为中心, 平移到图像内
+  auto x = std::clamp(hint.x + hint.width / 2 - w / 2, 0, img_size.width - w);
+  auto y = std::clamp(hint.y + hint.height / 2 - h / 2, 0, img_size.height - h);
+
+  // 起点取偶数坐标, 裁剪Bayer图像时排列方式不变
+  return {x & ~1, y & ~1, w, h};
 }
 
 }  // namespace auto_aim
\ No newline at end of file
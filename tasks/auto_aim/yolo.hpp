@@ -1,9 +1,13 @@
 #ifndef AUTO_AIM__YOLO_HPP
 #define AUTO_AIM__YOLO_HPP
 
+#include <chrono>
 #include <opencv2/opencv.hpp>
+#include <optional>
 
 #include "armor.hpp"
+#include "inference_engine.hpp"
+#include "io/bayer.hpp"
 
 namespace auto_aim
 {
@@ -12,22 +16,96 @@ class YOLOBase
 public:
   virtual std::list<Armor> detect(const cv::Mat & img, int frame_count) = 0;
 
+  // 只在roi内推理, 网络输入为input_size x input_size; 返回的装甲板坐标仍在整幅图像中
+  virtual std::list<Armor> detect(
+    const cv::Mat & img, const cv::Rect & roi, int input_size, int frame_count) = 0;
+
+  // 由相机原始Bayer图像推理, roi为空时在整幅图像上推理
+  // 默认只解马赛克需要推理的区域, 再按BGR图像处理; 子类可直接由Bayer图像生成网络输入
+  virtual std::list<Armor> detect_raw(
+    const cv::Mat & raw_img, io::BayerPattern pattern, const cv::Rect & roi, int input_size,
+    int frame_count);
+
+  // 编译动态ROI所用输入尺寸的模型
+  // 模型不能reshape到该尺寸(如anchor网格被导出为常量)时返回false
+  bool load_roi_model(int input_size);
+
+  // ov_preprocess时按图像尺寸编译模型内letterbox, 未启用或该格式的图像不经过letterbox时什么也不做
+  virtual void load_letterbox_model(const cv::Size & img_size, io::BayerPattern pattern) = 0;
+
+  // offset为推理区域左上角在bgr_img中的坐标
   virtual std::list<Armor> postprocess(
-    double scale, cv::Mat & output, const cv::Mat & bgr_img, int frame_count) = 0;
+    double scale, cv::Mat & output, const cv::Mat & bgr_img, const cv::Point2f & offset,
+    int frame_count) = 0;
+
+  virtual ~YOLOBase() = default;
+
+protected:
+  std::string device_, model_path_;
+  std::shared_ptr<InferenceEngine::Model> model_;
+  std::shared_ptr<InferenceEngine::Model> roi_model_;  // 动态ROI使用的较小输入尺寸
+
+private:
+  cv::Mat demosaiced_;  // detect_raw()默认实现的输出, 帧间复用
 };
 
 class YOLO
 {
 public:
+  struct RoiStats
+  {
+    uint64_t roi_frames = 0;   // 在ROI内推理的帧数
+    uint64_t roi_hits = 0;     // 其中检出装甲板的帧数, 其余帧的下一帧回退到整幅图像
+    uint64_t full_frames = 0;  // 在整幅图像上推理的帧数, 含回退
+
+    double hit_rate() const { return roi_frames == 0 ? 0 : double(roi_hits) / roi_frames; }
+  };
+
   YOLO(const std::string & config_path, bool debug = true);
 
+  // 不编译检测模型, 只能调用postprocess()
+  // 供自行组织推理的调用者(如MultiThreadDetector, omniperception::BatchDetector)解码网络输出
+  static YOLO postprocessor(const std::string & config_path, bool debug = false);
+
   std::list<Armor> detect(const cv::Mat & img, int frame_count = -1);
 
+  // hint为Tracker::roi()给出的目标区域; 启用dynamic_roi时只在其附近以较小的网络输入推理
+  // 没有hint、每隔roi_full_interval帧、或上一帧ROI内未检出时, 在整幅图像上推理
+  // 模型不能reshape到roi_input_size时, 加载时关闭dynamic_roi
+  std::list<Armor> detect(
+    const cv::Mat & img, const std::optional<cv::Rect> & hint, int frame_count = -1);
+
+  // 同上, 但输入为io::Camera::read_raw()得到的原始图像, 不产生全分辨率BGR
+  std::list<Armor> detect(
+    const cv::Mat & raw_img, io::BayerPattern pattern, const std::optional<cv::Rect> & hint,
+    int frame_count = -1);
+
+  // 网络输入为bgr_img中以offset为左上角的区域时, 返回的装甲板坐标仍在整幅bgr_img中
   std::list<Armor> postprocess(
-    double scale, cv::Mat & output, const cv::Mat & bgr_img, int frame_count);
+    double scale, cv::Mat & output, const cv::Mat & bgr_img, int frame_count,
+    const cv::Point2f & offset = {0, 0});
+
+  // 按相机图像的尺寸与格式提前编译推理时才会用到的模型, 应在InferenceEngine::warm_up()前调用
+  void prepare(const cv::Size & img_size, io::BayerPattern pattern = io::BayerPattern::none);
+
+  RoiStats roi_stats() const;
 
 private:
   std::unique_ptr<YOLOBase> yolo_;
+
+  YOLO(const std::string & config_path, bool debug, bool load_model);
+
+  bool dynamic_roi_ = false;
+  int roi_input_size_ = 320;
+  double roi_margin_ = 0.5;
+  int roi_full_interval_ = 10;
+
+  int frames_since_full_ = 0;
+  RoiStats roi_stats_;
+  std::chrono::steady_clock::time_point last_log_time_;
+
+  std::list<Armor> detect_full(const cv::Mat & img, io::BayerPattern pattern, int frame_count);
+  cv::Rect expand(const cv::Rect & hint, const cv::Size & img_size) const;
 };
 
 }  // namespace auto_aim
@@ -10,7 +10,7 @@
 
 namespace auto_aim
 {
-YOLO11::YOLO11(const std::string & config_path, bool debug)
+YOLO11::YOLO11(const std::string & config_path, bool debug, bool load_model)
 : debug_(debug), detector_(config_path, false)
 {
   auto yaml = YAML::LoadFile(config_path);
@@ -25,32 +25,15 @@ YOLO11::YOLO11(const std::string & config_path, bool debug)
   width = yaml["roi"]["width"].as<int>();
   height = yaml["roi"]["height"].as<int>();
   use_roi_ = yaml["use_roi"].as<bool>();
+  ov_preprocess_ = yaml["ov_preprocess"] && yaml["ov_preprocess"].as<bool>();
   roi_ = cv::Rect(x, y, width, height);
-  offset_ = cv::Point2f(x, y);
 
   save_path_ = "imgs";
   std::filesystem::create_directory(save_path_);
-  auto model = core_.read_model(model_path_);
-  ov::preprocess::PrePostProcessor ppp(model);
-  auto & input = ppp.input();
-
-  input.tensor()
-    .set_element_type(ov::element::u8)
-    .set_shape({1, 640, 640, 3})
-    .set_layout("NHWC")
-    .set_color_format(ov::preprocess::ColorFormat::BGR);
-
-  input.model().set_layout("NCHW");
-
-  input.preprocess()
-    .convert_element_type(ov::element::f32)
-    .convert_color(ov::preprocess::ColorFormat::RGB)
-    .scale(255.0);
-
-  // TODO: ov::hint::performance_mode(ov::hint::PerformanceMode::LATENCY)
-  model = ppp.build();
-  compiled_model_ = core_.compile_model(
-    model, device_, ov::hint::performance_mode(ov::hint::PerformanceMode::LATENCY));
+  if (load_model) {
+    model_ = InferenceEngine::instance().load(
+      {model_path_, device_, ov::hint::PerformanceMode::LATENCY, 640});
+  }
 }
 
 std::list<Armor> YOLO11::detect(const cv::Mat & raw_img, int frame_count)
@@ -60,39 +43,97 @@ std::list<Armor> YOLO11::detect(const cv::Mat & raw_img, int frame_count)
     return std::list<Armor>();
   }
 
-  cv::Mat bgr_img;
-  tmp_img_ = raw_img;
+  auto roi = full_roi(raw_img.size());
+  return infer(raw_img, roi, 640, ov_preprocess_, frame_count);
+}
+
+std::list<Armor> YOLO11::detect(
+  const cv::Mat & raw_img, const cv::Rect & roi, int input_size, int frame_count)
+{
+  if (raw_img.empty()) {
+    tools::logger()->warn("Empty img!, camera drop!");
+    return std::list<Armor>();
+  }
+
+  // 动态ROI的尺寸每帧不同, 不为其编译模型内letterbox
+  return infer(raw_img, roi, input_size, false, frame_count);
+}
+
+void YOLO11::load_letterbox_model(const cv::Size & img_size, io::BayerPattern)
+{
+  // Bayer图像由YOLOBase::detect_raw()解马赛克后同样经过letterbox
+  if (!ov_preprocess_) return;
+
+  auto roi = full_roi(img_size);
+  letterbox_model_ = InferenceEngine::instance().load(
+    {model_path_, device_, ov::hint::PerformanceMode::LATENCY, 640, roi.width, roi.height});
+}
+
+cv::Rect YOLO11::full_roi(const cv::Size & img_size)
+{
+  auto roi = cv::Rect(0, 0, img_size.width, img_size.height);
   if (use_roi_) {
     if (roi_.width == -1) {  // -1 表示该维度不裁切
-      roi_.width = raw_img.cols;
+      roi_.width = img_size.width;
     }
     if (roi_.height == -1) {  // -1 表示该维度不裁切
-      roi_.height = raw_img.rows;
+      roi_.height = img_size.height;
     }
-    bgr_img = raw_img(roi_);
-  } else {
-    bgr_img = raw_img;
+    roi = roi_;
   }
+  return roi;
+}
 
-  auto x_scale = static_cast<double>(640) / bgr_img.rows;
-  auto y_scale = static_cast<double>(640) / bgr_img.cols;
-  auto scale = std::min(x_scale, y_scale);
-  auto h = static_cast<int>(bgr_img.rows * scale);
-  auto w = static_cast<int>(bgr_img.cols * scale);
-
-  // preproces
-  auto input = cv::Mat(640, 640, CV_8UC3, cv::Scalar(0, 0, 0));
-  auto roi = cv::Rect(0, 0, w, h);
-  cv::resize(bgr_img, input(roi), {w, h});
-  ov::Tensor input_tensor(ov::element::u8, {1, 640, 640, 3}, input.data);
+std::list<Armor> YOLO11::infer(
+  const cv::Mat & raw_img, const cv::Rect & roi, int input_size, bool letterbox, int frame_count)
+{
+  tmp_img_ = raw_img;
+  infer_roi_ = roi;
+  offset_ = roi.tl();
+  cv::Mat bgr_img = raw_img(roi);
+
+  std::shared_ptr<ov::InferRequest> infer_request;
+  double scale;
+  if (letterbox) {
+    // 缩放与填充在模型内完成, 图像(或ROI)零拷贝作为输入
+    if (!letterbox_model_ || letterbox_model_->config().input_size != input_size ||
+        letterbox_model_->config().image_width != bgr_img.cols ||
+        letterbox_model_->config().image_height != bgr_img.rows) {
+      letterbox_model_ = InferenceEngine::instance().load(
+        {model_path_, device_, ov::hint::PerformanceMode::LATENCY, input_size, bgr_img.cols,
+         bgr_img.rows});
+    }
+    scale = letterbox_model_->scale();
+    infer_request = letterbox_model_->acquire();
+    infer_request->set_input_tensor(InferenceEngine::wrap(bgr_img));
+  } else {
+    auto x_scale = static_cast<double>(input_size) / bgr_img.rows;
+    auto y_scale = static_cast<double>(input_size) / bgr_img.cols;
+    scale = std::min(x_scale, y_scale);
+    auto h = static_cast<int>(bgr_img.rows * scale);
+    auto w = static_cast<int>(bgr_img.cols * scale);
+
+    // preproces: 直接写入推理请求预先分配的输入张量
+    if (
+      input_size != model_->config().input_size &&
+      (!roi_model_ || roi_model_->config().input_size != input_size)) {
+      roi_model_ = InferenceEngine::instance().load(
+        {model_path_, device_, ov::hint::PerformanceMode::LATENCY, input_size});
+    }
+    auto & model = input_size == model_->config().input_size ? model_ : roi_model_;
+    infer_request = model->acquire();
+    auto input_tensor = infer_request->get_input_tensor();
+    auto input = cv::Mat(input_size, input_size, CV_8UC3, input_tensor.data());
+    input.setTo(cv::Scalar(0, 0, 0));
+    auto input_roi = cv::Rect(0, 0, w, h);
+    cv::resize(bgr_img, input(input_roi), {w, h});
+  }
 
-  /// infer
-  auto infer_request = compiled_model_.create_infer_request();
-  infer_request.set_input_tensor(input_tensor);
-  infer_request.infer();
+  // infer
+  infer_request->infer();
 
   // postprocess
-  auto output_tensor = infer_request.get_output_tensor();
+  auto output_tensor = infer_request->get_output_tensor();
   auto output_shape = output_tensor.get_shape();
   cv::Mat output(output_shape[1], output_shape[2], CV_32F, output_tensor.data());
 
@@ -101,58 +142,19 @@ std::list<Armor> YOLO11::detect(const cv::Mat & raw_img, int frame_count)
 
 std::list<Armor> YOLO11::parse(
   double scale, cv::Mat & output, const cv::Mat & bgr_img, int frame_count)
-{  // for each row: xywh + classess
-  cv::transpose(output, output);
-
-  std::vector<int> ids;
-  std::vector<float> confidences;
-  std::vector<cv::Rect> boxes;
-  std::vector<std::vector<cv::Point2f>> armors_key_points;
-  for (int r = 0; r < output.rows; r++) {
-    auto xywh = output.row(r).colRange(0, 4);
-    auto scores = output.row(r).colRange(4, 4 + class_num_);
-    auto one_key_points = output.row(r).colRange(4 + class_num_, 50);
-
-    std::vector<cv::Point2f> armor_key_points;
-
-    double score;
-    cv::Point max_point;
-    cv::minMaxLoc(scores, nullptr, &score, nullptr, &max_point);
-
-    if (score < score_threshold_) continue;
-
-    auto x = xywh.at<float>(0);
-    auto y = xywh.at<float>(1);
-    auto w = xywh.at<float>(2);
-    auto h = xywh.at<float>(3);
-    auto left = static_cast<int>((x - 0.5 * w) / scale);
-    auto top = static_cast<int>((y - 0.5 * h) / scale);
-    auto width = static_cast<int>(w / scale);
-    auto height = static_cast<int>(h / scale);
-
-    for (int i = 0; i < 4; i++) {
-      float x = one_key_points.at<float>(0, i * 2 + 0) / scale;
-      float y = one_key_points.at<float>(0, i * 2 + 1) / scale;
-      cv::Point2f kp = {x, y};
-      armor_key_points.push_back(kp);
-    }
-    ids.emplace_back(max_point.x);
-    confidences.emplace_back(score);
-    boxes.emplace_back(left, top, width, height);
-    armors_key_points.emplace_back(armor_key_points);
-  }
+{
+  // output为[4 + class_num + 8, anchors]: xywh + 类别得分 + 4个关键点
+  decoder_.decode_channel_major(output, class_num_, 4, score_threshold_, scale);
 
   std::vector<int> indices;
-  cv::dnn::NMSBoxes(boxes, confidences, score_threshold_, nms_threshold_, indices);
+  cv::dnn::NMSBoxes(decoder_.boxes, decoder_.scores, score_threshold_, nms_threshold_, indices);
 
   std::list<Armor> armors;
   for (const auto & i : indices) {
-    sort_keypoints(armors_key_points[i]);
-    if (use_roi_) {
-      armors.emplace_back(ids[i], confidences[i], boxes[i], armors_key_points[i], offset_);
-    } else {
-      armors.emplace_back(ids[i], confidences[i], boxes[i], armors_key_points[i]);
-    }
+    auto & key_points = decoder_.key_points[i];
+    sort_keypoints(key_points);
+    armors.emplace_back(
+      decoder_.class_ids[i], decoder_.scores[i], decoder_.boxes[i], key_points, offset_);
   }
 
   for (auto it = armors.begin(); it != armors.end();) {
@@ -247,9 +249,9 @@ void YOLO11::draw_detections(
     tools::draw_text(detection, info, armor.center, {0, 255, 0});
   }
 
-  if (use_roi_) {
+  if (!infer_roi_.empty() && infer_roi_.size() != img.size()) {
     cv::Scalar green(0, 255, 0);
-    cv::rectangle(detection, roi_, green, 2);
+    cv::rectangle(detection, infer_roi_, green, 2);
   }
   cv::resize(detection, detection, {}, 0.5, 0.5);  // 显示时缩小图片尺寸
   cv::imshow("detection", detection);
@@ -263,8 +265,10 @@ void YOLO11::save(const Armor & armor) const
 }
 
 std::list<Armor> YOLO11::postprocess(
-  double scale, cv::Mat & output, const cv::Mat & bgr_img, int frame_count)
+  double scale, cv::Mat & output, const cv::Mat & bgr_img, const cv::Point2f & offset,
+  int frame_count)
 {
+  offset_ = offset;
   return parse(scale, output, bgr_img, frame_count);
 }
 
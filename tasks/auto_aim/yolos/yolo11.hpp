@@ -9,34 +9,43 @@
 
 #include "tasks/auto_aim/armor.hpp"
 #include "tasks/auto_aim/detector.hpp"
+#include "tasks/auto_aim/inference_engine.hpp"
 #include "tasks/auto_aim/yolo.hpp"
+#include "tasks/auto_aim/yolos/yolo_decoder.hpp"
 
 namespace auto_aim
 {
 class YOLO11 : public YOLOBase
 {
 public:
-  YOLO11(const std::string & config_path, bool debug);
+  // load_model为false时不编译检测模型, 只能调用postprocess()
+  YOLO11(const std::string & config_path, bool debug, bool load_model = true);
 
   std::list<Armor> detect(const cv::Mat & bgr_img, int frame_count) override;
 
+  std::list<Armor> detect(
+    const cv::Mat & bgr_img, const cv::Rect & roi, int input_size, int frame_count) override;
+
+  void load_letterbox_model(const cv::Size & img_size, io::BayerPattern pattern) override;
+
   std::list<Armor> postprocess(
-    double scale, cv::Mat & output, const cv::Mat & bgr_img, int frame_count) override;
+    double scale, cv::Mat & output, const cv::Mat & bgr_img, const cv::Point2f & offset,
+    int frame_count) override;
 
 private:
-  std::string device_, model_path_;
   std::string save_path_, debug_path_;
-  bool debug_, use_roi_;
+  bool debug_, use_roi_, ov_preprocess_;
 
   const int class_num_ = 38;
   const float nms_threshold_ = 0.3;
   const float score_threshold_ = 0.7;
   double min_confidence_, binary_threshold_;
 
-  ov::Core core_;
-  ov::CompiledModel compiled_model_;
+  std::shared_ptr<InferenceEngine::Model> letterbox_model_;  // ov_preprocess时按图像尺寸编译
+  YOLODecoder decoder_;
 
   cv::Rect roi_;
+  cv::Rect infer_roi_;  // 最近一次推理所用的区域
   cv::Point2f offset_;
   cv::Mat tmp_img_;
 
@@ -47,6 +56,10 @@ private:
 
   cv::Point2f get_center_norm(const cv::Mat & bgr_img, const cv::Point2f & center) const;
 
+  cv::Rect full_roi(const cv::Size & img_size);
+
+  std::list<Armor> infer(
+    const cv::Mat & raw_img, const cv::Rect & roi, int input_size, bool letterbox, int frame_count);
   std::list<Armor> parse(double scale, cv::Mat & output, const cv::Mat & bgr_img, int frame_count);
 
   void save(const Armor & armor) const;
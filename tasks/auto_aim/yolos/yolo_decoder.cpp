@@ -0,0 +1,88 @@
+#include "yolo_decoder.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace auto_aim
+{
+const std::vector<YOLODecoder::Candidate> & YOLODecoder::select_channel_major(
+  const float * output, int anchors, int score_begin, int class_num, float threshold)
+{
+  best_score_.assign(output + score_begin * anchors, output + (score_begin + 1) * anchors);
+
+  // 逐通道更新所有锚点的最大得分: 内层循环连续访存、没有分支, Release下编译为SIMD的max指令
+  auto best_score = best_score_.data();
+  for (int c = 1; c < class_num; c++) {
+    const float * row = output + (score_begin + c) * anchors;
+    for (int a = 0; a < anchors; a++) best_score[a] = std::max(best_score[a], row[a]);
+  }
+
+  // 只对通过阈值的少数锚点找出得分最大的类别
+  candidates_.clear();
+  for (int a = 0; a < anchors; a++) {
+    if (!(best_score[a] >= threshold)) continue;  // 同时排除NaN
+    int class_id = 0;
+    while (class_id < class_num - 1 &&
+           output[(score_begin + class_id) * anchors + a] != best_score[a])
+      class_id++;
+    candidates_.push_back({a, class_id, best_score[a]});
+  }
+
+  return candidates_;
+}
+
+const std::vector<YOLODecoder::Candidate> & YOLODecoder::select_anchor_major(
+  const float * output, int anchors, int stride, int score_index, float threshold)
+{
+  // sigmoid单调, 直接与阈值的logit比较, 只对候选计算sigmoid
+  auto logit_threshold = std::log(threshold / (1 - threshold));
+
+  candidates_.clear();
+  const float * score = output + score_index;
+  for (int a = 0; a < anchors; a++, score += stride) {
+    if (*score < logit_threshold) continue;
+    candidates_.push_back({a, 0, static_cast<float>(1 / (1 + std::exp(-*score)))});
+  }
+
+  return candidates_;
+}
+
+void YOLODecoder::decode_channel_major(
+  const cv::Mat & output, int class_num, int point_num, float threshold, double scale)
+{
+  auto data = output.ptr<float>();
+  auto anchors = output.cols;
+  select_channel_major(data, anchors, 4, class_num, threshold);
+  resize_results(candidates_.size(), point_num);
+
+  auto channel = [&](int c, int a) { return data[c * anchors + a]; };
+  for (size_t i = 0; i < candidates_.size(); i++) {
+    auto a = candidates_[i].anchor;
+    auto x = channel(0, a);
+    auto y = channel(1, a);
+    auto w = channel(2, a);
+    auto h = channel(3, a);
+    boxes[i] = cv::Rect(
+      static_cast<int>((x - 0.5 * w) / scale), static_cast<int>((y - 0.5 * h) / scale),
+      static_cast<int>(w / scale), static_cast<int>(h / scale));
+
+    for (int j = 0; j < point_num; j++) {
+      key_points[i][j].x = channel(4 + class_num + j * 2 + 0, a) / scale;
+      key_points[i][j].y = channel(4 + class_num + j * 2 + 1, a) / scale;
+    }
+
+    class_ids[i] = candidates_[i].class_id;
+    scores[i] = candidates_[i].score;
+  }
+}
+
+void YOLODecoder::resize_results(size_t n, int point_num)
+{
+  class_ids.resize(n);
+  scores.resize(n);
+  boxes.resize(n);
+  key_points.resize(n);
+  for (auto & points : key_points) points.resize(point_num);
+}
+
+}  // namespace auto_aim
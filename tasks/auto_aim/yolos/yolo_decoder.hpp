@@ -0,0 +1,53 @@
+#ifndef AUTO_AIM__YOLO_DECODER_HPP
+#define AUTO_AIM__YOLO_DECODER_HPP
+
+#include <opencv2/opencv.hpp>
+#include <vector>
+
+namespace auto_aim
+{
+// YOLO输出解码, 直接在推理输出上工作, 不转置、不为每个锚点创建cv::Mat视图
+// 先对所有锚点做一遍(可被编译器向量化的)最大得分计算, 压缩出超过阈值的少数候选,
+// 再只对候选解码框与关键点; 所有缓冲区在多次调用间复用
+class YOLODecoder
+{
+public:
+  struct Candidate
+  {
+    int anchor;
+    int class_id;
+    float score;
+  };
+
+  // 解码结果, 下标与candidates()一致
+  std::vector<int> class_ids;
+  std::vector<float> scores;
+  std::vector<cv::Rect> boxes;
+  std::vector<std::vector<cv::Point2f>> key_points;
+
+  // 通道优先的输出[channels, anchors]: 第score_begin起的class_num个通道为各类得分
+  // 返回得分最大值不低于threshold的锚点, 得分相同时取靠前的类别(与cv::minMaxLoc一致)
+  const std::vector<Candidate> & select_channel_major(
+    const float * output, int anchors, int score_begin, int class_num, float threshold);
+
+  // 锚点优先的输出[anchors, stride]: 第score_index列为objectness的logit, 按sigmoid后的值筛选
+  const std::vector<Candidate> & select_anchor_major(
+    const float * output, int anchors, int stride, int score_index, float threshold);
+
+  // YOLOv8/YOLO11: output为[4 + class_num + 2 * point_num, anchors]的xywh + 类别得分 + 关键点,
+  // 坐标除以scale还原到输入图像
+  void decode_channel_major(
+    const cv::Mat & output, int class_num, int point_num, float threshold, double scale);
+
+  const std::vector<Candidate> & candidates() const { return candidates_; }
+
+private:
+  std::vector<float> best_score_;
+  std::vector<Candidate> candidates_;
+
+  void resize_results(size_t n, int point_num);
+};
+
+}  // namespace auto_aim
+
+#endif  // AUTO_AIM__YOLO_DECODER_HPP
@@ -3,6 +3,7 @@
 #include <fmt/chrono.h>
 #include <yaml-cpp/yaml.h>
 
+#include <algorithm>
 #include <filesystem>
 
 #include "tools/img_tools.hpp"
@@ -10,7 +11,7 @@
 
 namespace auto_aim
 {
-YOLOV5::YOLOV5(const std::string & config_path, bool debug)
+YOLOV5::YOLOV5(const std::string & config_path, bool debug, bool load_model)
 : debug_(debug), detector_(config_path, false)
 {
   auto yaml = YAML::LoadFile(config_path);
@@ -25,33 +26,16 @@ YOLOV5::YOLOV5(const std::string & config_path, bool debug)
   width = yaml["roi"]["width"].as<int>();
   height = yaml["roi"]["height"].as<int>();
   use_roi_ = yaml["use_roi"].as<bool>();
+  ov_preprocess_ = yaml["ov_preprocess"] && yaml["ov_preprocess"].as<bool>();
   use_traditional_ = yaml["use_traditional"].as<bool>();
   roi_ = cv::Rect(x, y, width, height);
-  offset_ = cv::Point2f(x, y);
 
   save_path_ = "imgs";
   std::filesystem::create_directory(save_path_);
-  auto model = core_.read_model(model_path_);
-  ov::preprocess::PrePostProcessor ppp(model);
-  auto & input = ppp.input();
-
-  input.tensor()
-    .set_element_type(ov::element::u8)
-    .set_shape({1, 640, 640, 3})
-    .set_layout("NHWC")
-    .set_color_format(ov::preprocess::ColorFormat::BGR);
-
-  input.model().set_layout("NCHW");
-
-  input.preprocess()
-    .convert_element_type(ov::element::f32)
-    .convert_color(ov::preprocess::ColorFormat::RGB)
-    .scale(255.0);
-
-  // TODO: ov::hint::performance_mode(ov::hint::PerformanceMode::LATENCY)
-  model = ppp.build();
-  compiled_model_ = core_.compile_model(
-    model, device_, ov::hint::performance_mode(ov::hint::PerformanceMode::LATENCY));
+  if (load_model) {
+    model_ = InferenceEngine::instance().load(
+      {model_path_, device_, ov::hint::PerformanceMode::LATENCY, 640});
+  }
 }
 
 std::list<Armor> YOLOV5::detect(const cv::Mat & raw_img, int frame_count)
@@ -61,115 +45,170 @@ std::list<Armor> YOLOV5::detect(const cv::Mat & raw_img, int frame_count)
     return std::list<Armor>();
   }
 
-  cv::Mat bgr_img;
+  auto roi = full_roi(raw_img.size());
+  return infer(raw_img, io::BayerPattern::none, roi, 640, ov_preprocess_, frame_count);
+}
+
+std::list<Armor> YOLOV5::detect(
+  const cv::Mat & raw_img, const cv::Rect & roi, int input_size, int frame_count)
+{
+  if (raw_img.empty()) {
+    tools::logger()->warn("Empty img!, camera drop!");
+    return std::list<Armor>();
+  }
+
+  // 动态ROI的尺寸每帧不同, 不为其编译模型内letterbox
+  return infer(raw_img, io::BayerPattern::none, roi, input_size, false, frame_count);
+}
+
+std::list<Armor> YOLOV5::detect_raw(
+  const cv::Mat & raw_img, io::BayerPattern pattern, const cv::Rect & roi, int input_size,
+  int frame_count)
+{
+  if (pattern == io::BayerPattern::none)
+    return YOLOBase::detect_raw(raw_img, pattern, roi, input_size, frame_count);
+
+  if (raw_img.empty()) {
+    tools::logger()->warn("Empty img!, camera drop!");
+    return std::list<Armor>();
+  }
+
+  // 起点取偶数坐标, 裁剪后Bayer排列不变
+  auto infer_roi = roi.empty() ? full_roi(raw_img.size()) : roi;
+  infer_roi.x &= ~1;
+  infer_roi.y &= ~1;
+
+  // 模型内letterbox的输入为BGR, Bayer图像总是在CPU上预处理
+  if (roi.empty()) return infer(raw_img, pattern, infer_roi, 640, false, frame_count);
+  return infer(raw_img, pattern, infer_roi, input_size, false, frame_count);
+}
+
+cv::Rect YOLOV5::full_roi(const cv::Size & img_size)
+{
+  auto roi = cv::Rect(0, 0, img_size.width, img_size.height);
   if (use_roi_) {
     if (roi_.width == -1) {  // -1 表示该维度不裁切
-      roi_.width = raw_img.cols;
+      roi_.width = img_size.width;
     }
     if (roi_.height == -1) {  // -1 表示该维度不裁切
-      roi_.height = raw_img.rows;
+      roi_.height = img_size.height;
     }
-    bgr_img = raw_img(roi_);
-  } else {
-    bgr_img = raw_img;
+    roi = roi_;
   }
+  return roi;
+}
 
-  auto x_scale = static_cast<double>(640) / bgr_img.rows;
-  auto y_scale = static_cast<double>(640) / bgr_img.cols;
-  auto scale = std::min(x_scale, y_scale);
-  auto h = static_cast<int>(bgr_img.rows * scale);
-  auto w = static_cast<int>(bgr_img.cols * scale);
+void YOLOV5::load_letterbox_model(const cv::Size & img_size, io::BayerPattern pattern)
+{
+  // Bayer图像总是在CPU上预处理, 见detect_raw()
+  if (!ov_preprocess_ || pattern != io::BayerPattern::none) return;
+
+  auto roi = full_roi(img_size);
+  letterbox_model_ = InferenceEngine::instance().load(
+    {model_path_, device_, ov::hint::PerformanceMode::LATENCY, 640, roi.width, roi.height});
+}
 
-  // preproces
-  auto input = cv::Mat(640, 640, CV_8UC3, cv::Scalar(0, 0, 0));
-  auto roi = cv::Rect(0, 0, w, h);
-  cv::resize(bgr_img, input(roi), {w, h});
-  ov::Tensor input_tensor(ov::element::u8, {1, 640, 640, 3}, input.data);
+std::list<Armor> YOLOV5::infer(
+  const cv::Mat & raw_img, io::BayerPattern pattern, const cv::Rect & roi, int input_size,
+  bool letterbox, int frame_count)
+{
+  infer_roi_ = roi;
+  offset_ = roi.tl();
+  cv::Mat bgr_img = raw_img(roi);
+
+  std::shared_ptr<ov::InferRequest> infer_request;
+  double scale;
+  if (letterbox) {
+    // 缩放与填充在模型内完成, 图像(或ROI)零拷贝作为输入
+    if (!letterbox_model_ || letterbox_model_->config().input_size != input_size ||
+        letterbox_model_->config().image_width != bgr_img.cols ||
+        letterbox_model_->config().image_height != bgr_img.rows) {
+      letterbox_model_ = InferenceEngine::instance().load(
+        {model_path_, device_, ov::hint::PerformanceMode::LATENCY, input_size, bgr_img.cols,
+         bgr_img.rows});
+    }
+    scale = letterbox_model_->scale();
+    infer_request = letterbox_model_->acquire();
+    infer_request->set_input_tensor(InferenceEngine::wrap(bgr_img));
+  } else {
+    // preproces: 直接写入推理请求预先分配的输入张量
+    if (
+      input_size != model_->config().input_size &&
+      (!roi_model_ || roi_model_->config().input_size != input_size)) {
+      roi_model_ = InferenceEngine::instance().load(
+        {model_path_, device_, ov::hint::PerformanceMode::LATENCY, input_size});
+    }
+    auto & model = input_size == model_->config().input_size ? model_ : roi_model_;
+    infer_request = model->acquire();
+    auto input_tensor = infer_request->get_input_tensor();
+    auto input = cv::Mat(input_size, input_size, CV_8UC3, input_tensor.data());
+    scale = io::demosaic_resize(bgr_img, pattern, {input_size, input_size}, input);
+  }
 
   // infer
-  auto infer_request = compiled_model_.create_infer_request();
-  infer_request.set_input_tensor(input_tensor);
-  infer_request.infer();
+  infer_request->infer();
 
   // postprocess
-  auto output_tensor = infer_request.get_output_tensor();
+  auto output_tensor = infer_request->get_output_tensor();
   auto output_shape = output_tensor.get_shape();
   cv::Mat output(output_shape[1], output_shape[2], CV_32F, output_tensor.data());
 
-  return parse(scale, output, raw_img, frame_count);
+  return parse(scale, output, raw_img, pattern, frame_count);
 }
 
 std::list<Armor> YOLOV5::parse(
-  double scale, cv::Mat & output, const cv::Mat & bgr_img, int frame_count)
+  double scale, cv::Mat & output, const cv::Mat & img, io::BayerPattern pattern, int frame_count)
 {
-  // for each row: xywh + classess
-  std::vector<int> color_ids, num_ids;
-  std::vector<float> confidences;
-  std::vector<cv::Rect> boxes;
-  std::vector<std::vector<cv::Point2f>> armors_key_points;
-  for (int r = 0; r < output.rows; r++) {
-    double score = output.at<float>(r, 8);
-    score = sigmoid(score);
-
-    if (score < score_threshold_) continue;
-
-    std::vector<cv::Point2f> armor_key_points;
+  // output为[anchors, 22]: 4个关键点 + objectness + 4个颜色得分 + 9个类别得分
+  auto & candidates = decoder_.select_anchor_major(
+    output.ptr<float>(), output.rows, output.cols, 8, score_threshold_);
+
+  color_ids_.resize(candidates.size());
+  num_ids_.resize(candidates.size());
+  confidences_.resize(candidates.size());
+  boxes_.resize(candidates.size());
+  armors_key_points_.resize(candidates.size());
+  for (size_t i = 0; i < candidates.size(); i++) {
+    const float * row = output.ptr<float>(candidates[i].anchor);
 
     //颜色和类别独热向量
-    cv::Mat color_scores = output.row(r).colRange(9, 13);     //color
-    cv::Mat classes_scores = output.row(r).colRange(13, 22);  //num
-    cv::Point class_id, color_id;
-    int _class_id, _color_id;
-    double score_color, score_num;
-    cv::minMaxLoc(classes_scores, NULL, &score_num, NULL, &class_id);
-    cv::minMaxLoc(color_scores, NULL, &score_color, NULL, &color_id);
-    _class_id = class_id.x;
-    _color_id = color_id.x;
-
-    armor_key_points.push_back(
-      cv::Point2f(output.at<float>(r, 0) / scale, output.at<float>(r, 1) / scale));
-    armor_key_points.push_back(
-      cv::Point2f(output.at<float>(r, 6) / scale, output.at<float>(r, 7) / scale));
-    armor_key_points.push_back(
-      cv::Point2f(output.at<float>(r, 4) / scale, output.at<float>(r, 5) / scale));
-    armor_key_points.push_back(
-      cv::Point2f(output.at<float>(r, 2) / scale, output.at<float>(r, 3) / scale));
+    color_ids_[i] = std::max_element(row + 9, row + 13) - (row + 9);    //color
+    num_ids_[i] = std::max_element(row + 13, row + 22) - (row + 13);  //num
+
+    auto & armor_key_points = armors_key_points_[i];
+    armor_key_points.resize(4);
+    armor_key_points[0] = cv::Point2f(row[0] / scale, row[1] / scale);
+    armor_key_points[1] = cv::Point2f(row[6] / scale, row[7] / scale);
+    armor_key_points[2] = cv::Point2f(row[4] / scale, row[5] / scale);
+    armor_key_points[3] = cv::Point2f(row[2] / scale, row[3] / scale);
 
     float min_x = armor_key_points[0].x;
     float max_x = armor_key_points[0].x;
     float min_y = armor_key_points[0].y;
     float max_y = armor_key_points[0].y;
 
-    for (int i = 1; i < armor_key_points.size(); i++) {
-      if (armor_key_points[i].x < min_x) min_x = armor_key_points[i].x;
-      if (armor_key_points[i].x > max_x) max_x = armor_key_points[i].x;
-      if (armor_key_points[i].y < min_y) min_y = armor_key_points[i].y;
-      if (armor_key_points[i].y > max_y) max_y = armor_key_points[i].y;
+    for (int j = 1; j < armor_key_points.size(); j++) {
+      if (armor_key_points[j].x < min_x) min_x = armor_key_points[j].x;
+      if (armor_key_points[j].x > max_x) max_x = armor_key_points[j].x;
+      if (armor_key_points[j].y < min_y) min_y = armor_key_points[j].y;
+      if (armor_key_points[j].y > max_y) max_y = armor_key_points[j].y;
     }
 
-    cv::Rect rect(min_x, min_y, max_x - min_x, max_y - min_y);
-
-    color_ids.emplace_back(_color_id);
-    num_ids.emplace_back(_class_id);
-    boxes.emplace_back(rect);
-    confidences.emplace_back(score);
-    armors_key_points.emplace_back(armor_key_points);
+    boxes_[i] = cv::Rect(min_x, min_y, max_x - min_x, max_y - min_y);
+    confidences_[i] = candidates[i].score;
   }
 
   std::vector<int> indices;
-  cv::dnn::NMSBoxes(boxes, confidences, score_threshold_, nms_threshold_, indices);
+  cv::dnn::NMSBoxes(boxes_, confidences_, score_threshold_, nms_threshold_, indices);
 
   std::list<Armor> armors;
   for (const auto & i : indices) {
-    if (use_roi_) {
-      armors.emplace_back(
-        color_ids[i], num_ids[i], confidences[i], boxes[i], armors_key_points[i], offset_);
-    } else {
-      armors.emplace_back(color_ids[i], num_ids[i], confidences[i], boxes[i], armors_key_points[i]);
-    }
+    armors.emplace_back(
+      color_ids_[i], num_ids_[i], confidences_[i], boxes_[i], armors_key_points_[i], offset_);
   }
 
-  tmp_img_ = bgr_img;
+  tmp_img_ = img;
+  tmp_pattern_ = pattern;
   for (auto it = armors.begin(); it != armors.end();) {
     if (!check_name(*it)) {
       it = armors.erase(it);
@@ -181,13 +220,17 @@ std::list<Armor> YOLOV5::parse(
       continue;
     }
     // 使用传统方法二次矫正角点
-    if (use_traditional_) detector_.detect(*it, bgr_img);
+    if (use_traditional_) detector_.detect(*it, img, pattern);
 
-    it->center_norm = get_center_norm(bgr_img, it->center);
+    it->center_norm = get_center_norm(img, it->center);
     ++it;
   }
 
-  if (debug_) draw_detections(bgr_img, armors, frame_count);
+  if (debug_) {
+    cv::Mat bgr_img;
+    io::demosaic(img, pattern, bgr_img);
+    draw_detections(bgr_img, armors, frame_count);
+  }
 
   return armors;
 }
@@ -236,9 +279,9 @@ void YOLOV5::draw_detections(
     tools::draw_text(detection, info, armor.center, {0, 255, 0});
   }
 
-  if (use_roi_) {
+  if (!infer_roi_.empty() && infer_roi_.size() != img.size()) {
     cv::Scalar green(0, 255, 0);
-    cv::rectangle(detection, roi_, green, 2);
+    cv::rectangle(detection, infer_roi_, green, 2);
   }
   cv::resize(detection, detection, {}, 0.5, 0.5);  // 显示时缩小图片尺寸
   cv::imshow("detection", detection);
@@ -248,21 +291,17 @@ void YOLOV5::save(const Armor & armor) const
 {
   auto file_name = fmt::format("{:%Y-%m-%d_%H-%M-%S}", std::chrono::system_clock::now());
   auto img_path = fmt::format("{}/{}_{}.jpg", save_path_, armor.name, file_name);
-  cv::imwrite(img_path, tmp_img_);
-}
-
-double YOLOV5::sigmoid(double x)
-{
-  if (x > 0)
-    return 1.0 / (1.0 + exp(-x));
-  else
-    return exp(x) / (1.0 + exp(x));
+  cv::Mat bgr_img;
+  io::demosaic(tmp_img_, tmp_pattern_, bgr_img);
+  cv::imwrite(img_path, bgr_img);
 }
 
 std::list<Armor> YOLOV5::postprocess(
-  double scale, cv::Mat & output, const cv::Mat & bgr_img, int frame_count)
+  double scale, cv::Mat & output, const cv::Mat & bgr_img, const cv::Point2f & offset,
+  int frame_count)
 {
-  return parse(scale, output, bgr_img, frame_count);
+  offset_ = offset;
+  return parse(scale, output, bgr_img, io::BayerPattern::none, frame_count);
 }
 
 }  // namespace auto_aim
\ No newline at end of file
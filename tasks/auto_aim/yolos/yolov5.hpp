@@ -9,36 +9,57 @@
 
 #include "tasks/auto_aim/armor.hpp"
 #include "tasks/auto_aim/detector.hpp"
+#include "tasks/auto_aim/inference_engine.hpp"
 #include "tasks/auto_aim/yolo.hpp"
+#include "tasks/auto_aim/yolos/yolo_decoder.hpp"
 
 namespace auto_aim
 {
 class YOLOV5 : public YOLOBase
 {
 public:
-  YOLOV5(const std::string & config_path, bool debug);
+  // load_model为false时不编译检测模型, 只能调用postprocess()
+  YOLOV5(const std::string & config_path, bool debug, bool load_model = true);
 
   std::list<Armor> detect(const cv::Mat & bgr_img, int frame_count) override;
 
+  std::list<Armor> detect(
+    const cv::Mat & bgr_img, const cv::Rect & roi, int input_size, int frame_count) override;
+
+  // 网络输入由io::demosaic_resize直接写入, 只在需要时解马赛克装甲板附近或整幅图像
+  std::list<Armor> detect_raw(
+    const cv::Mat & raw_img, io::BayerPattern pattern, const cv::Rect & roi, int input_size,
+    int frame_count) override;
+
+  void load_letterbox_model(const cv::Size & img_size, io::BayerPattern pattern) override;
+
   std::list<Armor> postprocess(
-    double scale, cv::Mat & output, const cv::Mat & bgr_img, int frame_count) override;
+    double scale, cv::Mat & output, const cv::Mat & bgr_img, const cv::Point2f & offset,
+    int frame_count) override;
 
 private:
-  std::string device_, model_path_;
   std::string save_path_, debug_path_;
-  bool debug_, use_roi_, use_traditional_;
+  bool debug_, use_roi_, ov_preprocess_, use_traditional_;
 
   const int class_num_ = 13;
   const float nms_threshold_ = 0.3;
   const float score_threshold_ = 0.7;
   double min_confidence_, binary_threshold_;
 
-  ov::Core core_;
-  ov::CompiledModel compiled_model_;
+  std::shared_ptr<InferenceEngine::Model> letterbox_model_;  // ov_preprocess时按图像尺寸编译
+
+  // 解码缓冲区, 多帧间复用
+  YOLODecoder decoder_;
+  std::vector<int> color_ids_, num_ids_;
+  std::vector<float> confidences_;
+  std::vector<cv::Rect> boxes_;
+  std::vector<std::vector<cv::Point2f>> armors_key_points_;
 
   cv::Rect roi_;
+  cv::Rect infer_roi_;  // 最近一次推理所用的区域
   cv::Point2f offset_;
   cv::Mat tmp_img_;
+  io::BayerPattern tmp_pattern_ = io::BayerPattern::none;
 
   Detector detector_;
   friend class MultiThreadDetector;
@@ -48,11 +69,17 @@ private:
 
   cv::Point2f get_center_norm(const cv::Mat & bgr_img, const cv::Point2f & center) const;
 
-  std::list<Armor> parse(double scale, cv::Mat & output, const cv::Mat & bgr_img, int frame_count);
+  cv::Rect full_roi(const cv::Size & img_size);
+
+  std::list<Armor> infer(
+    const cv::Mat & raw_img, io::BayerPattern pattern, const cv::Rect & roi, int input_size,
+    bool letterbox, int frame_count);
+  std::list<Armor> parse(
+    double scale, cv::Mat & output, const cv::Mat & img, io::BayerPattern pattern,
+    int frame_count);
 
   void save(const Armor & armor) const;
   void draw_detections(const cv::Mat & img, const std::list<Armor> & armors, int frame_count) const;
-  double sigmoid(double x);
 };
 
 }  // namespace auto_aim
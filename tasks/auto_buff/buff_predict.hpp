@@ -22,13 +22,6 @@ public:
   virtual bool is_unsolve() const = 0;                    // 纯虚函数
   virtual Eigen::VectorXd getX_best() const = 0;          // 纯虚函数
 protected:
-  Eigen::VectorXd x0;
-  Eigen::MatrixXd P0;
-  Eigen::MatrixXd A;
-  Eigen::MatrixXd Q;
-  Eigen::MatrixXd H;
-  Eigen::MatrixXd R;
-  tools::ExtendedKalmanFilter ekf;
   Eigen::VectorXd X_best;
   double lastangle = 0;
   double lasttime = 0;
@@ -40,16 +33,8 @@ protected:
 class Small_Predictor : public Predictor
 {
 public:
-  Small_Predictor()
-  : Predictor()  //, x0(Eigen::VectorXd(1)), P0(1, 1), A(1, 1), Q(1, 1), H(1, 1), R(1, 1)
+  Small_Predictor() : Predictor()
   {
-    // 初始状态协方差矩阵
-    x0.resize(1);
-    P0.resize(1, 1);
-    A.resize(1, 1);
-    Q.resize(1, 1);
-    H.resize(1, 1);
-    R.resize(1, 1);
     // 初始状态
     x0 << 0.0;  // 初始角度为 0，初始角速度为 1
     // 初始状态协方差矩阵
@@ -63,7 +48,7 @@ public:
     // 测量噪声协方差矩阵                            //// 调整
     R << 0.05;
     // 创建扩展卡尔曼滤波器对象
-    ekf = tools::ExtendedKalmanFilter(x0, P0);
+    ekf = EKF(x0, P0);
   }
 
   virtual void update(double angle, double nowtime) override
@@ -102,12 +87,13 @@ public:
     // 预测下一个状态
     double deltatime = nowtime - lasttime;
     A << 1.0;
-    Eigen::VectorXd B(1);
+    EKF::VectorX B;
     B << SMALL_W * (cw_ccw > 0 ? 1 : -1);
-    ekf.predict(A, Q, [&](const Eigen::VectorXd & x) { return A * x + deltatime * B; });
+    ekf.predict(
+      A, Q, [&](const EKF::VectorX & x) -> EKF::VectorX { return A * x + deltatime * B; });
 
     // 更新状态，假设测量到的角度为当前状态的第一个元素
-    Eigen::VectorXd z(1);
+    Eigen::Matrix<double, 1, 1> z;
     z << angle;
     X_best = ekf.update(z, H, R);
 
@@ -135,13 +121,24 @@ public:
   virtual bool is_unsolve() const { return unsolvable; }
 
   virtual Eigen::VectorXd getX_best() const { return X_best; }
+
+private:
+  // [angle]
+  using EKF = tools::ExtendedKalmanFilter<1, 1>;
+
+  EKF::VectorX x0;
+  EKF::MatrixX P0;
+  EKF::MatrixX A;
+  EKF::MatrixX Q;
+  Eigen::Matrix<double, 1, 1> H;
+  Eigen::Matrix<double, 1, 1> R;
+  EKF ekf;
 };
 
 class Big_Predictor : public Predictor
 {
 public:
-  Big_Predictor()
-  : Predictor()  //,  x0(Eigen::VectorXd(5)), P0(5, 5), A(5, 5), Q(5, 5), H(1, 5), R(1, 1)
+  Big_Predictor() : Predictor()
   {
     // [angle
     //  spd
@@ -149,14 +146,6 @@ public:
     //  w       1.884-2.000
     //  sita ]
 
-    // 初始状态协方差矩阵
-    x0.resize(5);
-    P0.resize(5, 5);
-    A.resize(5, 5);
-    Q.resize(5, 5);
-    H.resize(1, 5);
-    R.resize(1, 1);
-
     // 初始状态
     x0 << 0.0, 1.1775, 0.9125, 1.942, 0.0;  // 初始角度为 0，初始角速度为 1,a:0,w:0
     // x0 << 0.0, 1.32, 0.78, 1.884, 0.0; // 初始角度为 0，初始角速度为 1,a:0,w:0
@@ -185,7 +174,7 @@ public:
     // 测量噪声协方差矩阵                            //// 调整
     R << 0.05;
     // 创建扩展卡尔曼滤波器对象
-    ekf = tools::ExtendedKalmanFilter(x0, P0);
+    ekf = EKF(x0, P0);
   }
 
   virtual void update(double angle, double nowtime) override
@@ -232,8 +221,8 @@ public:
       sin(sita + w * deltatime) - 1, deltatime * a * cos(sita + w * deltatime),
       a * cos(sita + w * deltatime), 0.0, 0.0, 1.0, 0.0, 0.0, 0.0, 0.0, 0.0, 1.0, 0.0, 0.0, 0.0,
       0.0, deltatime, 1.0;
-    ekf.predict(A, Q, [&](const Eigen::VectorXd & x) {
-      Eigen::VectorXd m(5);  //a w sita
+    ekf.predict(A, Q, [&](const EKF::VectorX & x) {
+      EKF::VectorX m;  //a w sita
       m << x[0] + (cw_ccw > 0 ? 1 : -1) * (-a / w * cos(sita + w * deltatime) + a / w * cos(sita) +
                                            (2.09 - a) * deltatime),
         a * sin(sita + w * deltatime) + 2.09 - a, a, w, sita + w * deltatime;
@@ -241,7 +230,7 @@ public:
     });
 
     // 更新状态
-    Eigen::VectorXd z(1);
+    Eigen::Matrix<double, 1, 1> z;
     z << angle;
     X_best = ekf.update(z, H, R);
 
@@ -274,26 +263,34 @@ public:
   virtual bool is_unsolve() const { return unsolvable; }
 
   virtual Eigen::VectorXd getX_best() const { return X_best; }
+
+private:
+  // [angle spd a w sita]
+  using EKF = tools::ExtendedKalmanFilter<5, 1>;
+
+  EKF::VectorX x0;
+  EKF::MatrixX P0;
+  EKF::MatrixX A;
+  EKF::MatrixX Q;
+  Eigen::Matrix<double, 1, 5> H;
+  Eigen::Matrix<double, 1, 1> R;
+  EKF ekf;
 };
 
 class XYZ_predictor
 {
 public:
-  Eigen::VectorXd x0;
-  Eigen::MatrixXd P0;
-  Eigen::MatrixXd A;
-  Eigen::MatrixXd Q;
-  Eigen::MatrixXd H;
-  Eigen::MatrixXd R;
-  tools::ExtendedKalmanFilter ekf;
+  using EKF = tools::ExtendedKalmanFilter<3, 3>;
+
+  EKF::VectorX x0;
+  EKF::MatrixX P0;
+  EKF::MatrixX A;
+  EKF::MatrixX Q;
+  Eigen::Matrix3d H;
+  Eigen::Matrix3d R;
+  EKF ekf;
   Eigen::VectorXd X_best;
   XYZ_predictor()
-  : x0(Eigen::VectorXd(3)),
-    P0(Eigen::MatrixXd(3, 3)),
-    A(Eigen::MatrixXd(3, 3)),
-    Q(Eigen::MatrixXd(3, 3)),
-    H(Eigen::MatrixXd(3, 3)),
-    R(Eigen::MatrixXd(3, 3))
   {
     // 初始状态
     x0 << 0.0, 0.0, 7.0;  // 初始x为 0，初始角y为 0, 初始角z为 7m
@@ -308,7 +305,7 @@ public:
     // 测量噪声协方差矩阵                            //// 调整
     R << 1.0, 0.0, 0.0, 0.0, 1.0, 0.0, 0.0, 0.0, 1.0;
     // 创建扩展卡尔曼滤波器对象
-    ekf = tools::ExtendedKalmanFilter(x0, P0);
+    ekf = EKF(x0, P0);
   }
 
   void kalman(Eigen::Vector3d & XYZ)
@@ -324,7 +321,7 @@ public:
     ekf.predict(A, Q);  // 预测的角度和角速度
 
     // 更新状态
-    Eigen::VectorXd z(3);
+    Eigen::Vector3d z;
     z << XYZ[0], XYZ[1], XYZ[2];
     X_best = ekf.update(z, H, R);
 
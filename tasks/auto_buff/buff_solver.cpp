@@ -1,4 +1,6 @@
 #include "buff_solver.hpp"
+
+#include "tools/ippe.hpp"
 namespace auto_buff
 {
 cv::Matx33f Solver::rotation_matrix(double angle) const
@@ -25,7 +27,11 @@ void Solver::compute_rotated_points(std::vector<std::vector<cv::Point3f>> & obje
 }
 
 // 初始化参数
-Solver::Solver(const std::string & config_path) : R_gimbal2world_(Eigen::Matrix3d::Identity())// 将 R_gimbal2world_初始化为单位矩阵
+Solver::Solver(const std::string & config_path)
+: camera_(config_path),
+  R_gimbal2world_(Eigen::Matrix3d::Identity()),  // 将 R_gimbal2world_初始化为单位矩阵
+  R_buff2camera_(Eigen::Matrix3d::Identity()),
+  t_buff2camera_(Eigen::Vector3d::Zero())
 {
   auto yaml = YAML::LoadFile(config_path);
 
@@ -36,13 +42,6 @@ Solver::Solver(const std::string & config_path) : R_gimbal2world_(Eigen::Matrix3
   R_camera2gimbal_ = Eigen::Matrix<double, 3, 3, Eigen::RowMajor>(R_camera2gimbal_data.data());
   t_camera2gimbal_ = Eigen::Matrix<double, 3, 1>(t_camera2gimbal_data.data());
 
-  auto camera_matrix_data = yaml["camera_matrix"].as<std::vector<double>>();
-  auto distort_coeffs_data = yaml["distort_coeffs"].as<std::vector<double>>();
-  Eigen::Matrix<double, 3, 3, Eigen::RowMajor> camera_matrix(camera_matrix_data.data());
-  Eigen::Matrix<double, 1, 5> distort_coeffs(distort_coeffs_data.data());
-  cv::eigen2cv(camera_matrix, camera_matrix_);
-  cv::eigen2cv(distort_coeffs, distort_coeffs_);
-
   // compute_rotated_points(OBJECT_POINTS);
 }
 
@@ -75,19 +74,23 @@ void Solver::solve(std::optional<PowerRune> & ps) const
   // image_points.emplace_back(p.target().center);
   image_points.emplace_back(p.r_center);
 
-  std::vector<cv::Point2f> image_points_fourth(image_points.begin(), image_points.begin() + 4);
-  std::vector<cv::Point3f> OBJECT_POINTS_FOURTH(OBJECT_POINTS.begin(), OBJECT_POINTS.begin() + 4);
-  cv::solvePnP(
-    OBJECT_POINTS_FOURTH, image_points_fourth, camera_matrix_, distort_coeffs_, rvec_, tvec_, false,
-    cv::SOLVEPNP_IPPE);
+  // 前4个点都在x = 0的平面上, 平面坐标系(u, v, n)即buff坐标系的(y, z, x)
+  // 与auto_aim::Solver相同: 角点查表去畸变, 再做IPPE
+  Eigen::Matrix<double, 2, 4> plane, image;
+  for (int i = 0; i < 4; i++) {
+    plane.col(i) << OBJECT_POINTS[i].y, OBJECT_POINTS[i].z;
+    image.col(i) = camera_.undistort(image_points[i].x, image_points[i].y);
+  }
+  Eigen::Matrix3d R_plane2camera;
+  tools::ippe(plane, image, R_plane2camera, t_buff2camera_);
+
+  Eigen::Matrix3d R_plane2buff;
+  R_plane2buff << 0, 0, 1, 1, 0, 0, 0, 1, 0;
+  R_buff2camera_ = R_plane2camera * R_plane2buff.transpose();
 
   // buff -> camera
-  Eigen::Vector3d t_buff2camera;
-  cv::cv2eigen(tvec_, t_buff2camera);
-  cv::Mat rmat;
-  cv::Rodrigues(rvec_, rmat);
-  Eigen::Matrix3d R_buff2camera;
-  cv::cv2eigen(rmat, R_buff2camera);
+  const Eigen::Vector3d & t_buff2camera = t_buff2camera_;
+  const Eigen::Matrix3d & R_buff2camera = R_buff2camera_;
 
   Eigen::Vector3d blade_xyz_in_buff{{0, 0, 700e-3}};// 扇叶中心点
 
@@ -115,11 +118,9 @@ void Solver::solve(std::optional<PowerRune> & ps) const
 cv::Point2f Solver::point_buff2pixel(cv::Point3f x)
 {
   // buff坐标系(单位:m)到像素坐标系
-  std::vector<cv::Point3d> world_points;
-  std::vector<cv::Point2d> image_points;
-  world_points.push_back(x);
-  cv::projectPoints(world_points, rvec_, tvec_, camera_matrix_, distort_coeffs_, image_points);
-  return image_points.back();
+  Eigen::Vector2d uv =
+    camera_.project(R_buff2camera_ * Eigen::Vector3d(x.x, x.y, x.z) + t_buff2camera_);
+  return cv::Point2f(uv.x(), uv.y());
 }
 
 // xyz_in_world2xyz_in_pix
@@ -136,16 +137,13 @@ std::vector<cv::Point2f> Solver::reproject_buff(
   Eigen::Vector3d t_buff2camera =
     R_camera2gimbal_.transpose() * (R_gimbal2world_.transpose() * t_buff2world - t_camera2gimbal_);
 
-  // get rvec tvec
-  cv::Vec3d rvec;
-  cv::Mat R_buff2camera_cv;
-  cv::eigen2cv(R_buff2camera, R_buff2camera_cv);
-  cv::Rodrigues(R_buff2camera_cv, rvec);
-  cv::Vec3d tvec(t_buff2camera[0], t_buff2camera[1], t_buff2camera[2]);
-
   // reproject
   std::vector<cv::Point2f> image_points;
-  cv::projectPoints(OBJECT_POINTS, rvec, tvec, camera_matrix_, distort_coeffs_, image_points);
+  for (const auto & point : OBJECT_POINTS) {
+    Eigen::Vector2d uv =
+      camera_.project(R_buff2camera * Eigen::Vector3d(point.x, point.y, point.z) + t_buff2camera);
+    image_points.emplace_back(uv.x(), uv.y());
+  }
   return image_points;
 }
 }  // namespace auto_buff
\ No newline at end of file
@@ -8,6 +8,7 @@
 #include <optional>
 
 #include "buff_type.hpp"
+#include "tools/camera_model.hpp"
 #include "tools/math_tools.hpp"
 namespace auto_buff
 {
@@ -32,14 +33,15 @@ public:
     const Eigen::Vector3d & xyz_in_world, double yaw, double row) const;
 
 private:
-  cv::Mat camera_matrix_;
-  cv::Mat distort_coeffs_;
+  tools::CameraModel camera_;
   Eigen::Matrix3d R_gimbal2imubody_;
   Eigen::Matrix3d R_camera2gimbal_;
   Eigen::Vector3d t_camera2gimbal_;
   Eigen::Matrix3d R_gimbal2world_;
 
-  cv::Vec3d rvec_, tvec_;
+  // 最近一次solve()的结果, 供point_buff2pixel()使用
+  mutable Eigen::Matrix3d R_buff2camera_;
+  mutable Eigen::Vector3d t_buff2camera_;
 
   // std::vector<std::vector<cv::Point3f>> OBJECT_POINTS = {
   //   {cv::Point3f(0, 160e-3, 858.5e-3), cv::Point3f(0, -160e-3, 858.5e-3),
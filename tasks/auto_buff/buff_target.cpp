@@ -24,12 +24,13 @@ Target::Target() : first_in_(true), unsolvable_(true) {};
 Eigen::Vector3d Target::point_buff2world(const Eigen::Vector3d & point_in_buff) const
 {
   if (unsolvable_) return Eigen::Vector3d(0, 0, 0);
+  Eigen::Matrix<double, 6, 1> x = x_head();
   Eigen::Matrix3d R_buff2world =
-    tools::rotation_matrix(Eigen::Vector3d(ekf_.x[4], 0.0, ekf_.x[5]));  // pitch = 0
+    tools::rotation_matrix(Eigen::Vector3d(x[4], 0.0, x[5]));  // pitch = 0
 
-  auto R_yaw = ekf_.x[0];
-  auto R_pitch = ekf_.x[2];
-  auto R_dis = ekf_.x[3];
+  auto R_yaw = x[0];
+  auto R_pitch = x[2];
+  auto R_dis = x[3];
   Eigen::Vector3d point_in_world =
     R_buff2world * point_in_buff + Eigen::Vector3d(
                                      R_dis * std::cos(R_pitch) * std::cos(R_yaw),
@@ -40,12 +41,24 @@ Eigen::Vector3d Target::point_buff2world(const Eigen::Vector3d & point_in_buff)
 
 bool Target::is_unsolve() const { return unsolvable_; }
 
-Eigen::VectorXd Target::ekf_x() const { return ekf_.x; }
-
 /// SmallTarget
 
 SmallTarget::SmallTarget() : Target() {}
 
+Eigen::VectorXd SmallTarget::ekf_x() const { return ekf_.x; }
+
+Eigen::Matrix<double, 6, 1> SmallTarget::x_head() const { return ekf_.x.head<6>(); }
+
+SmallTarget::State SmallTarget::StateAdd::operator()(const State & a, const State & b) const
+{
+  State c = a + b;
+  c[0] = tools::limit_rad(c[0]);
+  c[2] = tools::limit_rad(c[2]);
+  c[4] = tools::limit_rad(c[4]);
+  c[5] = tools::limit_rad(c[5]);
+  return c;
+}
+
 void SmallTarget::get_target(
   const std::optional<PowerRune> & p, std::chrono::steady_clock::time_point & timestamp)
 {
@@ -114,8 +127,8 @@ void SmallTarget::predict(double dt)
            0.0,    0.0, 0.0, 0.0, 0.0, 0.0, 0.0,
            0.0,    0.0, 0.0, 0.0, 0.0, 0.0, 0.0;
   // clang-format on 
-  auto f = [&](const Eigen::VectorXd & x) -> Eigen::VectorXd {
-    Eigen::VectorXd x_prior = A_ * x;
+  auto f = [&](const State & x) -> State {
+    State x_prior = A_ * x;
     x_prior[0] = tools::limit_rad(x_prior[0]);
     x_prior[2] = tools::limit_rad(x_prior[2]);
     x_prior[4] = tools::limit_rad(x_prior[4]);
@@ -131,12 +144,8 @@ void SmallTarget::init(double nowtime, const PowerRune & p)
   lasttime_ = nowtime;
 
   // 初始状态协方差矩阵
-  x0_.resize(7);
-  P0_.resize(7, 7);
-  A_.resize(7, 7);
-  Q_.resize(7, 7);
-  H_.resize(7, 7);//z x
-  R_.resize(7, 7);//z z
+  State x0;
+  EKF::MatrixX P0;
   // [R_yaw]
   // [v_R_yaw]
   // [R_pitch]
@@ -147,39 +156,25 @@ void SmallTarget::init(double nowtime, const PowerRune & p)
 
   // clang-format off
   // 初始状态
-  x0_ << p.ypd_in_world[0], 0.0, p.ypd_in_world[1], p.ypd_in_world[2],
-         p.ypr_in_world[0], p.ypr_in_world[2], 
-         SMALL_W * voter.clockwise();
+  x0 << p.ypd_in_world[0], 0.0, p.ypd_in_world[1], p.ypd_in_world[2],
+        p.ypr_in_world[0], p.ypr_in_world[2], 
+        SMALL_W * voter.clockwise();
   // 初始状态协方差矩阵
-  P0_ << 10.0,  0.0,  0.0,  0.0,  0.0,  0.0,  0.0,
-          0.0, 10.0,  0.0,  0.0,  0.0,  0.0,  0.0,
-          0.0,  0.0, 10.0,  0.0,  0.0,  0.0,  0.0,
-          0.0,  0.0,  0.0, 10.0,  0.0,  0.0,  0.0,
-          0.0,  0.0,  0.0,  0.0, 10.0,  0.0,  0.0,
-          0.0,  0.0,  0.0,  0.0,  0.0, 10.0,  0.0,
-          0.0,  0.0,  0.0,  0.0,  0.0,  0.0,  1e-2;
+  P0 << 10.0,  0.0,  0.0,  0.0,  0.0,  0.0,  0.0,
+         0.0, 10.0,  0.0,  0.0,  0.0,  0.0,  0.0,
+         0.0,  0.0, 10.0,  0.0,  0.0,  0.0,  0.0,
+         0.0,  0.0,  0.0, 10.0,  0.0,  0.0,  0.0,
+         0.0,  0.0,  0.0,  0.0, 10.0,  0.0,  0.0,
+         0.0,  0.0,  0.0,  0.0,  0.0, 10.0,  0.0,
+         0.0,  0.0,  0.0,  0.0,  0.0,  0.0,  1e-2;
   // 状态转移矩阵
   // A_ 
   // 过程噪声协方差矩阵                            //// 调整
   // Q_ 
-  // 测量方程矩阵
-  // H_
-  // 测量噪声协方差矩阵                            //// 调整
-  // R_
 
   // clang-format on
 
-  // 防止夹角求和出现异常值
-  auto x_add = [](const Eigen::VectorXd & a, const Eigen::VectorXd & b) -> Eigen::VectorXd {
-    Eigen::VectorXd c = a + b;
-    c[0] = tools::limit_rad(c[0]);
-    c[2] = tools::limit_rad(c[2]);
-    c[4] = tools::limit_rad(c[4]);
-    c[5] = tools::limit_rad(c[5]);
-    return c;
-  };
-  // 创建扩展卡尔曼滤波器对象
-  ekf_ = tools::ExtendedKalmanFilter(x0_, P0_, x_add);
+  ekf_ = EKF(x0, P0);
 }
 
 void SmallTarget::update(double nowtime, const PowerRune & p)
@@ -191,9 +186,9 @@ void SmallTarget::update(double nowtime, const PowerRune & p)
   // [yaw]       angle4
   // [angle/row] angle5
   // [spd]   w=CV_PI/6
-  const Eigen::VectorXd & R_ypd = p.ypd_in_world;  // R
-  const Eigen::VectorXd & ypr = p.ypr_in_world;
-  const Eigen::VectorXd & B_ypd = p.blade_ypd_in_world;  // center of blade
+  const Eigen::Vector3d & R_ypd = p.ypd_in_world;  // R
+  const Eigen::Vector3d & ypr = p.ypr_in_world;
+  const Eigen::Vector3d & B_ypd = p.blade_ypd_in_world;  // center of blade
 
   // 处理扇叶跳变 angle/row
   if (abs(ypr[2] - ekf_.x[5]) > CV_PI / 12) {
@@ -229,14 +224,14 @@ void SmallTarget::update(double nowtime, const PowerRune & p)
   // [angle/row] angle3
 
   // clang-format off
-  Eigen::MatrixXd H1{
+  Eigen::Matrix<double, 4, 7> H1{
     {1.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0}, // R_yaw
     {0.0, 0.0, 1.0, 0.0, 0.0, 0.0, 0.0}, // R_pitch
     {0.0, 0.0, 0.0, 1.0, 0.0, 0.0, 0.0}, // R_dis
     {0.0, 0.0, 0.0, 0.0, 0.0, 1.0, 0.0}  // roll
   };
 
-  Eigen::MatrixXd R1{
+  Eigen::Matrix4d R1{
     {0.01, 0.0, 0.0,  0.0}, // R_yaw
     {0.0, 0.01, 0.0,  0.0}, // R_pitch
     {0.0,  0.0, 0.5,  0.0}, // R_dis
@@ -245,15 +240,15 @@ void SmallTarget::update(double nowtime, const PowerRune & p)
   // clang-format on
 
   // 防止夹角求差出现异常值
-  auto z_subtract1 = [](const Eigen::VectorXd & a, const Eigen::VectorXd & b) -> Eigen::VectorXd {
-    Eigen::VectorXd c = a - b;  //4 1
+  auto z_subtract1 = [](const Eigen::Vector4d & a, const Eigen::Vector4d & b) -> Eigen::Vector4d {
+    Eigen::Vector4d c = a - b;
     c[0] = tools::limit_rad(c[0]);
     c[1] = tools::limit_rad(c[1]);
     c[3] = tools::limit_rad(c[3]);
     return c;
   };
 
-  Eigen::VectorXd z1{{R_ypd[0], R_ypd[1], R_ypd[2], ypr[2]}};  // R_ypd roll
+  Eigen::Vector4d z1{{R_ypd[0], R_ypd[1], R_ypd[2], ypr[2]}};  // R_ypd roll
 
   ekf_.update(z1, H1, R1, z_subtract1);
 
@@ -264,9 +259,9 @@ void SmallTarget::update(double nowtime, const PowerRune & p)
   // [B_dis]
 
   // clang-format off
-  Eigen::MatrixXd H2 = h_jacobian();  // 3*7
+  Eigen::Matrix<double, 3, 7> H2 = h_jacobian();  // 3*7
 
-  Eigen::MatrixXd R2{
+  Eigen::Matrix3d R2{
     {0.01, 0.0, 0.0}, // B_yaw
     {0.0, 0.01, 0.0}, // B_pitch
     {0.0,  0.0, 0.5}  // B_dis
@@ -274,24 +269,20 @@ void SmallTarget::update(double nowtime, const PowerRune & p)
   // clang-format on
 
   // 定义非线性转换函数h: x -> z
-  auto h2 = [&](const Eigen::VectorXd & x) -> Eigen::Vector3d {
-    Eigen::VectorXd R_ypd{{x[0], x[2], x[3]}};
-    Eigen::VectorXd R_xyz = tools::ypd2xyz(R_ypd);
-    Eigen::VectorXd R_xyz_and_yr{{R_ypd[0], R_ypd[1], R_ypd[2], x[4], x[5]}};
-    Eigen::VectorXd B_xyz = point_buff2world(Eigen::Vector3d(0.0, 0.0, 0.7));
-    Eigen::VectorXd B_ypd = tools::xyz2ypd(B_xyz);
-    return B_ypd;
+  auto h2 = [&](const State &) -> Eigen::Vector3d {
+    Eigen::Vector3d B_xyz = point_buff2world(Eigen::Vector3d(0.0, 0.0, 0.7));
+    return tools::xyz2ypd(B_xyz);
   };
 
   // 防止夹角求差出现异常值
-  auto z_subtract2 = [](const Eigen::VectorXd & a, const Eigen::VectorXd & b) -> Eigen::VectorXd {
-    Eigen::VectorXd c = a - b;  //6 1
+  auto z_subtract2 = [](const Eigen::Vector3d & a, const Eigen::Vector3d & b) -> Eigen::Vector3d {
+    Eigen::Vector3d c = a - b;
     c[0] = tools::limit_rad(c[0]);
     c[1] = tools::limit_rad(c[1]);
     return c;
   };
 
-  Eigen::VectorXd z2{{B_ypd[0], B_ypd[1], B_ypd[2]}};
+  Eigen::Vector3d z2{{B_ypd[0], B_ypd[1], B_ypd[2]}};
 
   ekf_.update(z2, H2, R2, h2, z_subtract2);
 
@@ -300,12 +291,12 @@ void SmallTarget::update(double nowtime, const PowerRune & p)
   return;
 }
 
-Eigen::MatrixXd SmallTarget::h_jacobian() const
+Eigen::Matrix<double, 3, 7> SmallTarget::h_jacobian() const
 {
   /// Z(3,1) = H3(3,3) * H2(3,5) * H1(5,5) * H0(5,7) * x(7,1)
 
   // clang-format off
-  Eigen::MatrixXd H0{
+  Eigen::Matrix<double, 5, 7> H0{
     {1.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0},
     {0.0, 0.0, 1.0, 0.0, 0.0, 0.0, 0.0},
     {0.0, 0.0, 0.0, 1.0, 0.0, 0.0, 0.0},
@@ -313,9 +304,9 @@ Eigen::MatrixXd SmallTarget::h_jacobian() const
     {0.0, 0.0, 0.0, 0.0, 0.0, 1.0, 0.0}
   };// 5*7
 
-  Eigen::VectorXd R_ypd{{ekf_.x[0], ekf_.x[2], ekf_.x[3]}};
-  Eigen::MatrixXd H_ypd2xyz = tools::ypd2xyz_jacobian(R_ypd);  // 3*3
-  Eigen::MatrixXd H1{
+  Eigen::Vector3d R_ypd{{ekf_.x[0], ekf_.x[2], ekf_.x[3]}};
+  Eigen::Matrix3d H_ypd2xyz = tools::ypd2xyz_jacobian(R_ypd);  // 3*3
+  Eigen::Matrix<double, 5, 5> H1{
     {H_ypd2xyz(0, 0), H_ypd2xyz(0, 1), H_ypd2xyz(0, 2), 0.0, 0.0},
     {H_ypd2xyz(1, 0), H_ypd2xyz(1, 1), H_ypd2xyz(1, 2), 0.0, 0.0},
     {H_ypd2xyz(2, 0), H_ypd2xyz(2, 1), H_ypd2xyz(2, 2), 0.0, 0.0},
@@ -330,14 +321,14 @@ Eigen::MatrixXd SmallTarget::h_jacobian() const
   double sin_yaw = sin(yaw);
   double cos_roll = cos(roll);
   double sin_roll = sin(roll);
-  Eigen::MatrixXd H2{
+  Eigen::Matrix<double, 3, 5> H2{
     {1.0, 0.0, 0.0, 0.7 * cos_yaw * sin_roll,  0.7 * sin_yaw * cos_roll},
     {0.0, 1.0, 0.0, 0.7 * sin_yaw * sin_roll, -0.7 * cos_yaw * cos_roll},
     {0.0, 0.0, 1.0,                      0.0,           -0.7 * sin_roll}
   };// 3*5
 
-  Eigen::VectorXd B_xyz = point_buff2world(Eigen::Vector3d(0.0, 0.0, 0.7));
-  Eigen::MatrixXd H3 = tools::xyz2ypd_jacobian(B_xyz);// 3*3
+  Eigen::Vector3d B_xyz = point_buff2world(Eigen::Vector3d(0.0, 0.0, 0.7));
+  Eigen::Matrix3d H3 = tools::xyz2ypd_jacobian(B_xyz);// 3*3
   // clang-format on
 
   return H3 * H2 * H1 * H0;  // 3*7
@@ -356,6 +347,21 @@ Eigen::MatrixXd SmallTarget::h_jacobian() const
 
 BigTarget::BigTarget() : Target(), spd_fitter_(100, 0.5, 1.884, 2.000) {}
 
+Eigen::VectorXd BigTarget::ekf_x() const { return ekf_.x; }
+
+Eigen::Matrix<double, 6, 1> BigTarget::x_head() const { return ekf_.x.head<6>(); }
+
+BigTarget::State BigTarget::StateAdd::operator()(const State & a, const State & b) const
+{
+  State c = a + b;
+  c[0] = tools::limit_rad(c[0]);
+  c[2] = tools::limit_rad(c[2]);
+  c[4] = tools::limit_rad(c[4]);
+  c[5] = tools::limit_rad(c[5]);
+  c[9] = tools::limit_rad(c[9]);
+  return c;
+}
+
 void BigTarget::get_target(
   const std::optional<PowerRune> & p, std::chrono::steady_clock::time_point & timestamp)
 {
@@ -444,8 +450,8 @@ void BigTarget::predict(double dt)
             // 0.0,     0.0, 0.0, 0.0, 0.0,  0.0,  0.0,  0.0,  0.0,  0.0,
             // 0.0,     0.0, 0.0, 0.0, 0.0,  0.0,  0.0,  0.0,  0.0,  0.0, 
             // 0.0,     0.0, 0.0, 0.0, 0.0,  0.0,  0.0,  0.0,  0.0,  0.0;
-  auto f = [&](const Eigen::VectorXd & x) -> Eigen::VectorXd {
-    Eigen::VectorXd x_prior = x;
+  auto f = [&](const State & x) -> State {
+    State x_prior = x;
     x_prior[0] = tools::limit_rad(x_prior[0] + dt * x_prior[1]);
     x_prior[2] = tools::limit_rad(x_prior[2]);
     x_prior[4] = tools::limit_rad(x_prior[4]); // yaw
@@ -465,12 +471,8 @@ void BigTarget::init(double nowtime, const PowerRune & p)
   unsolvable_ = true;
 
   // 初始状态协方差矩阵
-  x0_.resize(10);
-  P0_.resize(10, 10);
-  A_.resize(10, 10);
-  Q_.resize(10, 10);
-  H_.resize(7, 10);
-  R_.resize(7, 7);
+  State x0;
+  EKF::MatrixX P0;
 
   // [R_yaw]
   // [v_R_yaw]
@@ -485,43 +487,28 @@ void BigTarget::init(double nowtime, const PowerRune & p)
 
   // clang-format off
   // 初始状态
-  x0_ << p.ypd_in_world[0], 0.0, p.ypd_in_world[1], p.ypd_in_world[2],
-         p.ypr_in_world[0], p.ypr_in_world[2], 
-         1.1775, 0.9125, 1.942, 0.0;//std::atan((spd - 2.09) / 0.9125 + 1
+  x0 << p.ypd_in_world[0], 0.0, p.ypd_in_world[1], p.ypd_in_world[2],
+        p.ypr_in_world[0], p.ypr_in_world[2], 
+        1.1775, 0.9125, 1.942, 0.0;//std::atan((spd - 2.09) / 0.9125 + 1
   // 初始状态协方差矩阵
-  P0_ << 10.0,  0.0,  0.0,  0.0,  0.0,  0.0,  0.0,  0.0,  0.0,  0.0,
-          0.0, 10.0,  0.0,  0.0,  0.0,  0.0,  0.0,  0.0,  0.0,  0.0,
-          0.0,  0.0, 10.0,  0.0,  0.0,  0.0,  0.0,  0.0,  0.0,  0.0,
-          0.0,  0.0,  0.0, 10.0,  0.0,  0.0,  0.0,  0.0,  0.0,  0.0,
-          0.0,  0.0,  0.0,  0.0, 10.0,  0.0,  0.0,  0.0,  0.0,  0.0,
-          0.0,  0.0,  0.0,  0.0,  0.0, 10.0,  0.0,  0.0,  0.0,  0.0,
-          0.0,  0.0,  0.0,  0.0,  0.0,  0.0, 100.0, 0.0,  0.0,  0.0,
-          0.0,  0.0,  0.0,  0.0,  0.0,  0.0,  0.0, 10.0,  0.0,  0.0,
-          0.0,  0.0,  0.0,  0.0,  0.0,  0.0,  0.0,  0.0, 10.0,  0.0,
-          0.0,  0.0,  0.0,  0.0,  0.0,  0.0,  0.0,  0.0,  0.0, 400.0;
+  P0 << 10.0,  0.0,  0.0,  0.0,  0.0,  0.0,  0.0,  0.0,  0.0,  0.0,
+         0.0, 10.0,  0.0,  0.0,  0.0,  0.0,  0.0,  0.0,  0.0,  0.0,
+         0.0,  0.0, 10.0,  0.0,  0.0,  0.0,  0.0,  0.0,  0.0,  0.0,
+         0.0,  0.0,  0.0, 10.0,  0.0,  0.0,  0.0,  0.0,  0.0,  0.0,
+         0.0,  0.0,  0.0,  0.0, 10.0,  0.0,  0.0,  0.0,  0.0,  0.0,
+         0.0,  0.0,  0.0,  0.0,  0.0, 10.0,  0.0,  0.0,  0.0,  0.0,
+         0.0,  0.0,  0.0,  0.0,  0.0,  0.0, 100.0, 0.0,  0.0,  0.0,
+         0.0,  0.0,  0.0,  0.0,  0.0,  0.0,  0.0, 10.0,  0.0,  0.0,
+         0.0,  0.0,  0.0,  0.0,  0.0,  0.0,  0.0,  0.0, 10.0,  0.0,
+         0.0,  0.0,  0.0,  0.0,  0.0,  0.0,  0.0,  0.0,  0.0, 400.0;
   // 状态转移矩阵
   // A_
   // 过程噪声协方差矩阵                            //// 调整
   // Q_
-  // 测量方程矩阵
-  // H_
-  // 测量噪声协方差矩阵                            //// 调整
-  // R_
 
   // clang-format on
 
-  // 防止夹角求和出现异常值
-  auto x_add = [](const Eigen::VectorXd & a, const Eigen::VectorXd & b) -> Eigen::VectorXd {
-    Eigen::VectorXd c = a + b;
-    c[0] = tools::limit_rad(c[0]);
-    c[2] = tools::limit_rad(c[2]);
-    c[4] = tools::limit_rad(c[4]);
-    c[5] = tools::limit_rad(c[5]);
-    c[9] = tools::limit_rad(c[9]);
-    return c;
-  };
-  // 创建扩展卡尔曼滤波器对象
-  ekf_ = tools::ExtendedKalmanFilter(x0_, P0_, x_add);
+  ekf_ = EKF(x0, P0);
 }
 
 void BigTarget::update(double nowtime, const PowerRune & p)
@@ -536,9 +523,9 @@ void BigTarget::update(double nowtime, const PowerRune & p)
   // [a]         0.78-1.045
   // [w]         1.884-2.000
   // [fi]
-  const Eigen::VectorXd & R_ypd = p.ypd_in_world;  // R
-  const Eigen::VectorXd & ypr = p.ypr_in_world;
-  const Eigen::VectorXd & B_ypd = p.blade_ypd_in_world;  // center of blade
+  const Eigen::Vector3d & R_ypd = p.ypd_in_world;  // R
+  const Eigen::Vector3d & ypr = p.ypr_in_world;
+  const Eigen::Vector3d & B_ypd = p.blade_ypd_in_world;  // center of blade
 
   // 处理扇叶跳变 angle/row
   if (abs(ypr[2] - ekf_.x[5]) > CV_PI / 12) {
@@ -575,14 +562,14 @@ void BigTarget::update(double nowtime, const PowerRune & p)
   // [angle/row] angle3
 
   // clang-format off
-  Eigen::MatrixXd H1{
+  Eigen::Matrix<double, 4, 10> H1{
     {1.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0}, // R_yaw
     {0.0, 0.0, 1.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0}, // R_pitch
     {0.0, 0.0, 0.0, 1.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0}, // R_dis
     {0.0, 0.0, 0.0, 0.0, 0.0, 1.0, 0.0, 0.0, 0.0, 0.0}  // roll
   };
 
-  Eigen::MatrixXd R1{
+  Eigen::Matrix4d R1{
     {0.01, 0.0, 0.0,  0.0}, // R_yaw
     {0.0, 0.01, 0.0,  0.0}, // R_pitch
     {0.0,  0.0, 0.5,  0.0}, // R_dis
@@ -591,15 +578,15 @@ void BigTarget::update(double nowtime, const PowerRune & p)
   // clang-format on
 
   // 防止夹角求差出现异常值
-  auto z_subtract1 = [](const Eigen::VectorXd & a, const Eigen::VectorXd & b) -> Eigen::VectorXd {
-    Eigen::VectorXd c = a - b;  //4 1
+  auto z_subtract1 = [](const Eigen::Vector4d & a, const Eigen::Vector4d & b) -> Eigen::Vector4d {
+    Eigen::Vector4d c = a - b;
     c[0] = tools::limit_rad(c[0]);
     c[1] = tools::limit_rad(c[1]);
     c[3] = tools::limit_rad(c[3]);
     return c;
   };
 
-  Eigen::VectorXd z1{{R_ypd[0], R_ypd[1], R_ypd[2], ypr[2]}};  // R_ypd roll
+  Eigen::Vector4d z1{{R_ypd[0], R_ypd[1], R_ypd[2], ypr[2]}};  // R_ypd roll
 
   ekf_.update(z1, H1, R1, z_subtract1);
 
@@ -610,9 +597,9 @@ void BigTarget::update(double nowtime, const PowerRune & p)
   // [B_dis]
 
   // clang-format off
-  Eigen::MatrixXd H2 = h_jacobian();  // 3*10
+  Eigen::Matrix<double, 3, 10> H2 = h_jacobian();  // 3*10
 
-  Eigen::MatrixXd R2{
+  Eigen::Matrix3d R2{
     {0.01, 0.0, 0.0}, // B_yaw
     {0.0, 0.01, 0.0}, // B_pitch
     {0.0,  0.0, 0.5}  // B_dis
@@ -620,24 +607,20 @@ void BigTarget::update(double nowtime, const PowerRune & p)
   // clang-format on
 
   // 定义非线性转换函数h: x -> z
-  auto h2 = [&](const Eigen::VectorXd & x) -> Eigen::Vector3d {
-    Eigen::VectorXd R_ypd{{x[0], x[2], x[3]}};
-    Eigen::VectorXd R_xyz = tools::ypd2xyz(R_ypd);
-    Eigen::VectorXd R_xyz_and_yr{{R_ypd[0], R_ypd[1], R_ypd[2], x[4], x[5]}};
-    Eigen::VectorXd B_xyz = point_buff2world(Eigen::Vector3d(0.0, 0.0, 0.7));
-    Eigen::VectorXd B_ypd = tools::xyz2ypd(B_xyz);
-    return B_ypd;
+  auto h2 = [&](const State &) -> Eigen::Vector3d {
+    Eigen::Vector3d B_xyz = point_buff2world(Eigen::Vector3d(0.0, 0.0, 0.7));
+    return tools::xyz2ypd(B_xyz);
   };
 
   // 防止夹角求差出现异常值
-  auto z_subtract2 = [](const Eigen::VectorXd & a, const Eigen::VectorXd & b) -> Eigen::VectorXd {
-    Eigen::VectorXd c = a - b;  //6 1
+  auto z_subtract2 = [](const Eigen::Vector3d & a, const Eigen::Vector3d & b) -> Eigen::Vector3d {
+    Eigen::Vector3d c = a - b;
     c[0] = tools::limit_rad(c[0]);
     c[1] = tools::limit_rad(c[1]);
     return c;
   };
 
-  Eigen::VectorXd z2{{B_ypd[0], B_ypd[1], B_ypd[2]}};
+  Eigen::Vector3d z2{{B_ypd[0], B_ypd[1], B_ypd[2]}};
 
   ekf_.update(z2, H2, R2, h2, z_subtract2);
 
@@ -659,12 +642,12 @@ void BigTarget::update(double nowtime, const PowerRune & p)
   return;
 }
 
-Eigen::MatrixXd BigTarget::h_jacobian() const
+Eigen::Matrix<double, 3, 10> BigTarget::h_jacobian() const
 {
   /// Z(3,1) = H3(3,3) * H2(3,5) * H1(5,5) * H0(5,10) * x(10,1)
 
   // clang-format off
-  Eigen::MatrixXd H0{
+  Eigen::Matrix<double, 5, 10> H0{
     {1.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0},
     {0.0, 0.0, 1.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0},
     {0.0, 0.0, 0.0, 1.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0},
@@ -672,9 +655,9 @@ Eigen::MatrixXd BigTarget::h_jacobian() const
     {0.0, 0.0, 0.0, 0.0, 0.0, 1.0, 0.0, 0.0, 0.0, 0.0}
   };// 5*7
 
-  Eigen::VectorXd R_ypd{{ekf_.x[0], ekf_.x[2], ekf_.x[3]}};
-  Eigen::MatrixXd H_ypd2xyz = tools::ypd2xyz_jacobian(R_ypd);  // 3*3
-  Eigen::MatrixXd H1{
+  Eigen::Vector3d R_ypd{{ekf_.x[0], ekf_.x[2], ekf_.x[3]}};
+  Eigen::Matrix3d H_ypd2xyz = tools::ypd2xyz_jacobian(R_ypd);  // 3*3
+  Eigen::Matrix<double, 5, 5> H1{
     {H_ypd2xyz(0, 0), H_ypd2xyz(0, 1), H_ypd2xyz(0, 2), 0.0, 0.0},
     {H_ypd2xyz(1, 0), H_ypd2xyz(1, 1), H_ypd2xyz(1, 2), 0.0, 0.0},
     {H_ypd2xyz(2, 0), H_ypd2xyz(2, 1), H_ypd2xyz(2, 2), 0.0, 0.0},
@@ -689,14 +672,14 @@ Eigen::MatrixXd BigTarget::h_jacobian() const
   double sin_yaw = sin(yaw);
   double cos_roll = cos(roll);
   double sin_roll = sin(roll);
-  Eigen::MatrixXd H2{
+  Eigen::Matrix<double, 3, 5> H2{
     {1.0, 0.0, 0.0, 0.7 * cos_yaw * sin_roll,  0.7 * sin_yaw * cos_roll},
     {0.0, 1.0, 0.0, 0.7 * sin_yaw * sin_roll, -0.7 * cos_yaw * cos_roll},
     {0.0, 0.0, 1.0,                      0.0,           -0.7 * sin_roll}
   };// 3*5
 
-  Eigen::VectorXd B_xyz = point_buff2world(Eigen::Vector3d(0.0, 0.0, 0.7));
-  Eigen::MatrixXd H3 = tools::xyz2ypd_jacobian(B_xyz);// 3*3
+  Eigen::Vector3d B_xyz = point_buff2world(Eigen::Vector3d(0.0, 0.0, 0.7));
+  Eigen::Matrix3d H3 = tools::xyz2ypd_jacobian(B_xyz);// 3*3
   // clang-format on
 
   return H3 * H2 * H1 * H0;  // 3*7
@@ -44,7 +44,7 @@ public:
 
   bool is_unsolve() const;
 
-  Eigen::VectorXd ekf_x() const;
+  virtual Eigen::VectorXd ekf_x() const = 0;  // 纯虚函数
 
   double spd = 0;  //调试用
 
@@ -53,13 +53,9 @@ protected:
 
   virtual void update(double nowtime, const PowerRune & p) = 0;  // 纯虚函数
 
-  Eigen::VectorXd x0_;
-  Eigen::MatrixXd P0_;
-  Eigen::MatrixXd A_;
-  Eigen::MatrixXd Q_;
-  Eigen::MatrixXd H_;
-  Eigen::MatrixXd R_;
-  tools::ExtendedKalmanFilter ekf_;
+  // 子类状态的前6维相同: R_yaw v_R_yaw R_pitch R_dis yaw roll
+  virtual Eigen::Matrix<double, 6, 1> x_head() const = 0;  // 纯虚函数
+
   double lasttime_ = 0;
   Voter voter;  // 逆时针-1 顺时针1
   bool first_in_;
@@ -78,12 +74,31 @@ public:
 
   void predict(double dt) override;
 
+  Eigen::VectorXd ekf_x() const override;
+
 private:
+  // R_yaw v_R_yaw R_pitch R_dis yaw roll spd
+  using State = Eigen::Matrix<double, 7, 1>;
+
+  // 防止夹角求和出现异常值
+  struct StateAdd
+  {
+    State operator()(const State & a, const State & b) const;
+  };
+
+  using EKF = tools::ExtendedKalmanFilter<7, 4, StateAdd>;
+
+  EKF ekf_;
+  EKF::MatrixX A_;
+  EKF::MatrixX Q_;
+
   void init(double nowtime, const PowerRune & p) override;
 
   void update(double nowtime, const PowerRune & p) override;
 
-  Eigen::MatrixXd h_jacobian() const;
+  Eigen::Matrix<double, 6, 1> x_head() const override;
+
+  Eigen::Matrix<double, 3, 7> h_jacobian() const;
 
   const double SMALL_W = CV_PI / 3;
   // const double SMALL_W = 0;
@@ -101,12 +116,31 @@ public:
 
   void predict(double dt) override;
 
+  Eigen::VectorXd ekf_x() const override;
+
 private:
+  // R_yaw v_R_yaw R_pitch R_dis yaw roll spd a w fi
+  using State = Eigen::Matrix<double, 10, 1>;
+
+  // 防止夹角求和出现异常值
+  struct StateAdd
+  {
+    State operator()(const State & a, const State & b) const;
+  };
+
+  using EKF = tools::ExtendedKalmanFilter<10, 4, StateAdd>;
+
+  EKF ekf_;
+  EKF::MatrixX A_;
+  EKF::MatrixX Q_;
+
   void init(double nowtime, const PowerRune & p) override;
 
   void update(double nowtime, const PowerRune & p) override;
 
-  Eigen::MatrixXd h_jacobian() const;
+  Eigen::Matrix<double, 6, 1> x_head() const override;
+
+  Eigen::Matrix<double, 3, 10> h_jacobian() const;
 
   tools::RansacSineFitter spd_fitter_;
 
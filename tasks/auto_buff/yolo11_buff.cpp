@@ -8,14 +8,12 @@ YOLO11_BUFF::YOLO11_BUFF(const std::string & config)
 {
   auto yaml = YAML::LoadFile(config);
   std::string model_path = yaml["model"].as<std::string>();
-  model = core.read_model(model_path);
-  // printInputAndOutputsInfo(*model);  // 打印模型信息
   /// 载入并编译模型
-  compiled_model = core.compile_model(model, "CPU");
-  /// 创建推理请求
-  infer_request = compiled_model.create_infer_request();
+  model = auto_aim::InferenceEngine::instance().load({model_path, "CPU"});
+  /// 创建推理请求, 整个生命周期内独占
+  infer_request = model->acquire();
   // 获取模型输入节点
-  input_tensor = infer_request.get_input_tensor();
+  input_tensor = infer_request->get_input_tensor();
   input_tensor.set_shape({1, 3, 640, 640});
 }
 
@@ -32,10 +30,10 @@ std::vector<YOLO11_BUFF::Object> YOLO11_BUFF::get_multicandidateboxes(cv::Mat &
   }
 
   /// 执行推理计算
-  infer_request.infer();
+  infer_request->infer();
 
   /// 处理推理计算结果
-  const ov::Tensor output = infer_request.get_output_tensor();  // 获得推理结果
+  const ov::Tensor output = infer_request->get_output_tensor();  // 获得推理结果
   const ov::Shape output_shape = output.get_shape();
   const float * output_buffer = output.data<const float>();
   const int out_rows = output_shape[1];  // 获得"output"节点的rows 15
@@ -138,11 +136,11 @@ std::vector<YOLO11_BUFF::Object> YOLO11_BUFF::get_onecandidatebox(cv::Mat & imag
 
   /// 执行推理计算
 
-  infer_request.infer();
+  infer_request->infer();
 
   /// 处理推理计算结果  output 输出格式是[17,8400], 每列代表一个框(即最多有8400个框), 前面4行分别是[cx, cy, ow, oh], 中间score, 最后6*3关键点(x,y坐标+是否隐藏)
 
-  const ov::Tensor output = infer_request.get_output_tensor();  // 获得推理结果
+  const ov::Tensor output = infer_request->get_output_tensor();  // 获得推理结果
   const ov::Shape output_shape = output.get_shape();
   const float * output_buffer = output.data<const float>();
   const int out_rows = output_shape[1];  // 获得"output"节点的rows 23
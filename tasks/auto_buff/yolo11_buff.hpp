@@ -6,6 +6,7 @@
 #include <opencv2/opencv.hpp>
 #include <openvino/openvino.hpp>
 
+#include "tasks/auto_aim/inference_engine.hpp"
 #include "tools/logger.hpp"
 
 namespace auto_buff
@@ -31,10 +32,8 @@ public:
   std::vector<Object> get_onecandidatebox(cv::Mat & image);
 
 private:
-  ov::Core core;  // 创建OpenVINO Runtime Core对象
-  std::shared_ptr<ov::Model> model;
-  ov::CompiledModel compiled_model;
-  ov::InferRequest infer_request;
+  std::shared_ptr<auto_aim::InferenceEngine::Model> model;  // 与其他检测器共用OpenVINO Core
+  std::shared_ptr<ov::InferRequest> infer_request;
   ov::Tensor input_tensor;
   const int NUM_POINTS = 6;
 
@@ -0,0 +1,98 @@
+#include "batch_detector.hpp"
+
+#include <yaml-cpp/yaml.h>
+
+#include "tools/logger.hpp"
+
+namespace omniperception
+{
+BatchDetector::BatchDetector(const std::string & config_path, int batch_size)
+: batch_size_(batch_size), yolo_(auto_aim::YOLO::postprocessor(config_path))
+{
+  auto yaml = YAML::LoadFile(config_path);
+  auto yolo_name = yaml["yolo_name"].as<std::string>();
+  auto model_path = yaml[yolo_name + "_model_path"].as<std::string>();
+  auto device = yaml["device"].as<std::string>();
+  use_roi_ = yaml["use_roi"].as<bool>();
+  roi_ = cv::Rect(
+    yaml["roi"]["x"].as<int>(), yaml["roi"]["y"].as<int>(), yaml["roi"]["width"].as<int>(),
+    yaml["roi"]["height"].as<int>());
+
+  // 不reshape模型, 网络输入尺寸以导出时为准
+  for (int batch = 1; batch <= batch_size_; batch++) {
+    auto model = auto_aim::InferenceEngine::instance().load(
+      {model_path, device, ov::hint::PerformanceMode::LATENCY,
+       auto_aim::InferenceEngine::NATIVE_INPUT_SIZE, 0, 0, batch});
+    models_.push_back(model);
+    infer_requests_.push_back(model->acquire());
+  }
+  input_size_ = models_.front()->compiled_model().input().get_shape()[1];  // NHWC
+
+  tools::logger()->info(
+    "[BatchDetector] {} x {} batch initialized, input size {}.", yolo_name, batch_size_,
+    input_size_);
+}
+
+std::vector<std::list<auto_aim::Armor>> BatchDetector::detect(const std::vector<cv::Mat> & imgs)
+{
+  std::vector<std::list<auto_aim::Armor>> results(imgs.size());
+
+  // 非空图像依次占用batch的前k个位置, 用batch大小为k的模型推理
+  std::vector<size_t> indices;
+  for (size_t i = 0; i < imgs.size() && i < size_t(batch_size_); i++)
+    if (!imgs[i].empty()) indices.push_back(i);
+  if (indices.empty()) return results;
+
+  auto & infer_request = infer_requests_[indices.size() - 1];
+  std::vector<double> scales(indices.size());
+  std::vector<cv::Point2f> offsets(indices.size());
+
+  // preproces: 每张图像裁切roi后letterbox到输入张量中各自的位置
+  auto input_tensor = infer_request->get_input_tensor();
+  auto image_bytes = static_cast<size_t>(input_size_) * input_size_ * 3;
+  for (size_t k = 0; k < indices.size(); k++) {
+    const auto & raw_img = imgs[indices[k]];
+    auto roi = full_roi(raw_img.size());
+    offsets[k] = roi.tl();
+    cv::Mat img = raw_img(roi);
+
+    scales[k] = std::min(
+      static_cast<double>(input_size_) / img.rows, static_cast<double>(input_size_) / img.cols);
+    auto h = static_cast<int>(img.rows * scales[k]);
+    auto w = static_cast<int>(img.cols * scales[k]);
+
+    auto input = cv::Mat(
+      input_size_, input_size_, CV_8UC3, input_tensor.data<uint8_t>() + k * image_bytes);
+    input.setTo(cv::Scalar(0, 0, 0));
+    cv::resize(img, input(cv::Rect(0, 0, w, h)), {w, h});
+  }
+
+  // infer
+  infer_request->infer();
+
+  // postprocess: 按batch拆开输出, 逐张解码, 装甲板坐标加上roi的偏移
+  auto output_tensor = infer_request->get_output_tensor();
+  auto output_shape = output_tensor.get_shape();
+  auto output_floats = output_shape[1] * output_shape[2];
+  for (size_t k = 0; k < indices.size(); k++) {
+    cv::Mat output(
+      output_shape[1], output_shape[2], CV_32F, output_tensor.data<float>() + k * output_floats);
+    results[indices[k]] = yolo_.postprocess(scales[k], output, imgs[indices[k]], 0, offsets[k]);
+  }
+
+  return results;
+}
+
+int BatchDetector::batch_size() const { return batch_size_; }
+
+cv::Rect BatchDetector::full_roi(const cv::Size & img_size) const
+{
+  if (!use_roi_) return cv::Rect(0, 0, img_size.width, img_size.height);
+
+  auto roi = roi_;
+  if (roi.width == -1) roi.width = img_size.width;  // -1 表示该维度不裁切
+  if (roi.height == -1) roi.height = img_size.height;
+  return roi;
+}
+
+}  // namespace omniperception
@@ -0,0 +1,45 @@
+#ifndef OMNIPERCEPTION__BATCH_DETECTOR_HPP
+#define OMNIPERCEPTION__BATCH_DETECTOR_HPP
+
+#include <list>
+#include <memory>
+#include <opencv2/opencv.hpp>
+#include <openvino/openvino.hpp>
+#include <string>
+#include <vector>
+
+#include "tasks/auto_aim/armor.hpp"
+#include "tasks/auto_aim/inference_engine.hpp"
+#include "tasks/auto_aim/yolo.hpp"
+
+namespace omniperception
+{
+// 多路相机共用batch模型: 各路图像按配置的roi裁切、letterbox后拼成一个batch, 一次推理, 再逐张后处理
+// 为每个batch大小(1~batch_size)各编译一个模型, 只推理非空图像, 相机掉帧时不为空位付出推理开销
+class BatchDetector
+{
+public:
+  BatchDetector(const std::string & config_path, int batch_size);
+
+  // imgs.size()不超过batch_size; 空图像不参与推理, 对应结果为空
+  std::vector<std::list<auto_aim::Armor>> detect(const std::vector<cv::Mat> & imgs);
+
+  int batch_size() const;
+
+private:
+  const int batch_size_;
+  int input_size_;  // 取自模型的输入尺寸
+  bool use_roi_;
+  cv::Rect roi_;
+  // 下标k为batch大小k+1的模型与推理请求
+  std::vector<std::shared_ptr<auto_aim::InferenceEngine::Model>> models_;
+  std::vector<std::shared_ptr<ov::InferRequest>> infer_requests_;
+  auto_aim::YOLO yolo_;  // 只用于后处理, 不编译检测模型
+
+  // 与YOLO相同: use_roi时只在roi内推理, roi的宽高为-1表示该维度不裁切
+  cv::Rect full_roi(const cv::Size & img_size) const;
+};
+
+}  // namespace omniperception
+
+#endif  // OMNIPERCEPTION__BATCH_DETECTOR_HPP
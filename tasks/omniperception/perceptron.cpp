@@ -1,5 +1,8 @@
 #include "perceptron.hpp"
 
+#include <yaml-cpp/yaml.h>
+
+#include <algorithm>
 #include <chrono>
 #include <memory>
 #include <thread>
@@ -12,8 +15,9 @@ namespace omniperception
 {
 Perceptron::Perceptron(
   io::USBCamera * usbcam1, io::USBCamera * usbcam2, io::USBCamera * usbcam3,
-  io::USBCamera * usbcam4, const std::string & config_path)
-: detection_queue_(10), decider_(config_path), stop_flag_(false)
+  io::USBCamera * usbcam4, const std::string & config_path,
+  auto_aim::InferenceScheduler * scheduler)
+: detection_queue_(10), decider_(config_path), scheduler_(scheduler), stop_flag_(false)
 {
   // 初始化 YOLO 模型
   yolo_parallel1_ = std::make_shared<auto_aim::YOLO>(config_path, false);
@@ -86,7 +90,16 @@ void Perceptron::parallel_infer(
         continue;
       }
 
-      auto armors = yolov8_parallel->detect(usb_img);
+      std::list<auto_aim::Armor> armors;
+      if (scheduler_) {
+        // 被限频时直接读下一帧
+        auto result = scheduler_->run(
+          auto_aim::InferenceScheduler::OMNI, [&] { return yolov8_parallel->detect(usb_img); });
+        if (!result) continue;
+        armors = std::move(*result);
+      } else {
+        armors = yolov8_parallel->detect(usb_img);
+      }
       if (!armors.empty()) {
         auto delta_angle = decider_.delta_angle(armors, cam->device_name);
 
@@ -103,4 +116,146 @@ void Perceptron::parallel_infer(
   }
 }
 
+BatchPerceptron::BatchPerceptron(
+  const std::vector<io::USBCamera *> & cams, const std::string & config_path,
+  auto_aim::InferenceScheduler * scheduler)
+: cams_(cams),
+  slots_(cams.size()),
+  detector_(config_path, cams.size()),
+  decider_(config_path),
+  scheduler_(scheduler),
+  detection_queue_(10),
+  stop_flag_(false)
+{
+  auto yaml = YAML::LoadFile(config_path);
+  auto window_ms = yaml["omni_batch_window"] ? yaml["omni_batch_window"].as<double>() : 5.0;
+  window_ = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+    std::chrono::duration<double, std::milli>(window_ms));
+
+  for (size_t i = 0; i < cams_.size(); i++) threads_.emplace_back([this, i] { read_loop(i); });
+  threads_.emplace_back([this] { infer_loop(); });
+
+  tools::logger()->info("BatchPerceptron initialized.");
+}
+
+BatchPerceptron::~BatchPerceptron()
+{
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    stop_flag_ = true;
+  }
+  condition_.notify_all();
+
+  for (auto & t : threads_) {
+    if (t.joinable()) t.join();
+  }
+  tools::logger()->info("BatchPerceptron destructed.");
+}
+
+std::vector<DetectionResult> BatchPerceptron::get_detection_queue()
+{
+  std::vector<DetectionResult> result;
+  DetectionResult temp;
+
+  while (!detection_queue_.empty()) {
+    detection_queue_.pop(temp);
+    result.push_back(std::move(temp));
+  }
+
+  return result;
+}
+
+// 取图线程: 只把最新帧放进对应的槽
+void BatchPerceptron::read_loop(size_t i)
+{
+  auto cam = cams_[i];
+  if (!cam) {
+    tools::logger()->error("Camera pointer is null!");
+    return;
+  }
+
+  while (true) {
+    cv::Mat img;
+    std::chrono::steady_clock::time_point ts;
+    cam->read(img, ts);
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (stop_flag_) break;
+    if (img.empty()) continue;
+
+    auto & slot = slots_[i];
+    slot.img = img;
+    slot.timestamp = ts;
+    slot.arrival = std::chrono::steady_clock::now();
+    slot.fresh = true;
+    condition_.notify_all();
+  }
+}
+
+// 推理线程: 第一路新帧到达后最多再等window_, 让其他相机的新帧赶上同一个batch
+void BatchPerceptron::infer_loop()
+{
+  std::vector<cv::Mat> imgs(cams_.size());
+  std::vector<std::chrono::steady_clock::time_point> timestamps(cams_.size());
+
+  try {
+    while (true) {
+      {
+        std::unique_lock<std::mutex> lock(mutex_);
+        auto any_fresh = [this] {
+          return std::any_of(slots_.begin(), slots_.end(), [](const Slot & s) { return s.fresh; });
+        };
+        auto all_fresh = [this] {
+          return std::all_of(slots_.begin(), slots_.end(), [](const Slot & s) { return s.fresh; });
+        };
+
+        condition_.wait(lock, [&] { return stop_flag_ || any_fresh(); });
+        if (stop_flag_) break;
+
+        auto first_arrival = std::chrono::steady_clock::time_point::max();
+        for (const auto & slot : slots_) {
+          if (slot.fresh) first_arrival = std::min(first_arrival, slot.arrival);
+        }
+        condition_.wait_until(lock, first_arrival + window_, [&] {
+          return stop_flag_ || all_fresh();
+        });
+        if (stop_flag_) break;
+
+        // 没有新帧的相机在本次batch中留空
+        for (size_t i = 0; i < slots_.size(); i++) {
+          auto & slot = slots_[i];
+          imgs[i] = slot.fresh ? slot.img : cv::Mat();
+          timestamps[i] = slot.timestamp;
+          slot.fresh = false;
+        }
+      }
+
+      std::vector<std::list<auto_aim::Armor>> results;
+      if (scheduler_) {
+        auto result = scheduler_->run(
+          auto_aim::InferenceScheduler::OMNI, [&] { return detector_.detect(imgs); });
+        if (!result) continue;  // 被限频, 这一批帧不再推理
+        results = std::move(*result);
+      } else {
+        results = detector_.detect(imgs);
+      }
+
+      for (size_t i = 0; i < results.size(); i++) {
+        if (results[i].empty()) continue;
+
+        auto delta_angle = decider_.delta_angle(results[i], cams_[i]->device_name);
+
+        DetectionResult dr;
+        dr.armors = std::move(results[i]);
+        dr.timestamp = timestamps[i];
+        dr.delta_yaw = delta_angle[0] / 57.3;
+        dr.delta_pitch = delta_angle[1] / 57.3;
+        detection_queue_.push(dr);
+      }
+    }
+  } catch (const std::exception & e) {
+    tools::logger()->error("Exception in BatchPerceptron::infer_loop: {}", e.what());
+  }
+}
+
 }  // namespace omniperception
@@ -5,10 +5,12 @@
 #include <list>
 #include <memory>
 
+#include "batch_detector.hpp"
 #include "decider.hpp"
 #include "detection.hpp"
 #include "io/usbcamera/usbcamera.hpp"
 #include "tasks/auto_aim/armor.hpp"
+#include "tasks/auto_aim/inference_scheduler.hpp"
 #include "tools/thread_pool.hpp"
 #include "tools/thread_safe_queue.hpp"
 
@@ -20,7 +22,8 @@ class Perceptron
 public:
   Perceptron(
     io::USBCamera * usbcma1, io::USBCamera * usbcam2, io::USBCamera * usbcam3,
-    io::USBCamera * usbcam4, const std::string & config_path);
+    io::USBCamera * usbcam4, const std::string & config_path,
+    auto_aim::InferenceScheduler * scheduler = nullptr);
 
   ~Perceptron();
 
@@ -38,10 +41,51 @@ private:
   std::shared_ptr<auto_aim::YOLO> yolo_parallel4_;
 
   Decider decider_;
+  auto_aim::InferenceScheduler * scheduler_;  // 为空时不经调度直接推理
   bool stop_flag_;
   mutable std::mutex mutex_;
   std::condition_variable condition_;
 };
 
+// 与Perceptron接口相同, 但各相机的最新帧在batch_window内凑齐后一次推理, 未更新的相机不占batch
+// 每路相机一个取图线程只负责保存最新帧, 另有一个推理线程
+class BatchPerceptron
+{
+public:
+  BatchPerceptron(
+    const std::vector<io::USBCamera *> & cams, const std::string & config_path,
+    auto_aim::InferenceScheduler * scheduler = nullptr);
+
+  ~BatchPerceptron();
+
+  std::vector<DetectionResult> get_detection_queue();
+
+private:
+  struct Slot
+  {
+    cv::Mat img;
+    std::chrono::steady_clock::time_point timestamp;
+    std::chrono::steady_clock::time_point arrival;
+    bool fresh = false;  // 还没有参与过推理
+  };
+
+  std::vector<io::USBCamera *> cams_;
+  std::vector<Slot> slots_;
+  std::chrono::steady_clock::duration window_;
+
+  BatchDetector detector_;
+  Decider decider_;
+  auto_aim::InferenceScheduler * scheduler_;
+  tools::ThreadSafeQueue<DetectionResult> detection_queue_;
+
+  bool stop_flag_;
+  std::mutex mutex_;
+  std::condition_variable condition_;
+  std::vector<std::thread> threads_;
+
+  void read_loop(size_t i);
+  void infer_loop();
+};
+
 }  // namespace omniperception
 #endif
\ No newline at end of file
@@ -46,6 +46,7 @@ int main(int argc, char * argv[])
   auto_aim::YOLO yolo(config_path);
   auto_aim::Solver solver(config_path);
   auto_aim::Tracker tracker(config_path, solver);
+  tracker.set_ekf_diagnostics(true);
   auto_aim::Aimer aimer(config_path);
 
   cv::Mat img, drawing;
@@ -175,15 +176,16 @@ int main(int argc, char * argv[])
       data["last_id"] = target.last_id;
 
       // 卡方检验数据
-      data["residual_yaw"] = target.ekf().data.at("residual_yaw");
-      data["residual_pitch"] = target.ekf().data.at("residual_pitch");
-      data["residual_distance"] = target.ekf().data.at("residual_distance");
-      data["residual_angle"] = target.ekf().data.at("residual_angle");
-      data["nis"] = target.ekf().data.at("nis");
-      data["nees"] = target.ekf().data.at("nees");
-      data["nis_fail"] = target.ekf().data.at("nis_fail");
-      data["nees_fail"] = target.ekf().data.at("nees_fail");
-      data["recent_nis_failures"] = target.ekf().data.at("recent_nis_failures");
+      const auto & diagnostics = target.ekf().diagnostics;
+      data["residual_yaw"] = diagnostics.residual[0];
+      data["residual_pitch"] = diagnostics.residual[1];
+      data["residual_distance"] = diagnostics.residual[2];
+      data["residual_angle"] = diagnostics.residual[3];
+      data["nis"] = diagnostics.nis;
+      data["nees"] = diagnostics.nees;
+      data["nis_fail"] = diagnostics.nis_fail ? 1 : 0;
+      data["nees_fail"] = diagnostics.nees_fail ? 1 : 0;
+      data["nis_fail_rate"] = diagnostics.nis_fail_rate;
     }
 
     plotter.plot(data);
@@ -0,0 +1,133 @@
+// auto_buff::Solver的对比测试: solve(查表去畸变 + Eigen IPPE) vs cv::solvePnP(IPPE)
+//   ./buff_solver_test configs/standard3.yaml --frames=1000
+// 随机生成相机前方的能量机关位姿, 用cv::projectPoints得到扇叶4个角点与R标,
+// 两种方法输入相同的像素点, 检查得到的位置与姿态在容差内一致, 并输出平均耗时
+
+#include <yaml-cpp/yaml.h>
+
+#include <chrono>
+#include <opencv2/opencv.hpp>
+#include <optional>
+#include <vector>
+
+#include "tasks/auto_buff/buff_solver.hpp"
+#include "tasks/auto_buff/buff_type.hpp"
+#include "tools/logger.hpp"
+#include "tools/math_tools.hpp"
+
+const std::string keys =
+  "{help h usage ? |                        | 输出命令行参数说明}"
+  "{@config-path   | configs/standard3.yaml | 位置参数，yaml配置文件路径 }"
+  "{frames f       | 1000                   | 测试帧数 }"
+  "{xyz-tolerance  | 1e-3                   | 允许的位置差, m }"
+  "{ypr-tolerance  | 0.1                    | 允许的姿态差, 度 }";
+
+// 与auto_buff::Solver的OBJECT_POINTS相同: 扇叶4个角点与R标, 单位: m
+const std::vector<cv::Point3f> OBJECT_POINTS{
+  {0, 0, 827e-3}, {0, 127e-3, 700e-3}, {0, 0, 573e-3}, {0, -127e-3, 700e-3}, {0, 0, 0}};
+
+int main(int argc, char * argv[])
+{
+  cv::CommandLineParser cli(argc, argv, keys);
+  if (cli.has("help")) {
+    cli.printMessage();
+    return 0;
+  }
+  auto config_path = cli.get<std::string>(0);
+  auto frames = cli.get<int>("frames");
+  auto xyz_tolerance = cli.get<double>("xyz-tolerance");
+  auto ypr_tolerance = cli.get<double>("ypr-tolerance") / 57.3;
+
+  auto yaml = YAML::LoadFile(config_path);
+  auto camera_matrix_data = yaml["camera_matrix"].as<std::vector<double>>();
+  auto distort_coeffs_data = yaml["distort_coeffs"].as<std::vector<double>>();
+  auto R_camera2gimbal_data = yaml["R_camera2gimbal"].as<std::vector<double>>();
+  auto t_camera2gimbal_data = yaml["t_camera2gimbal"].as<std::vector<double>>();
+  cv::Mat camera_matrix(3, 3, CV_64F, camera_matrix_data.data());
+  cv::Mat distort_coeffs(1, 5, CV_64F, distort_coeffs_data.data());
+  Eigen::Matrix3d R_camera2gimbal =
+    Eigen::Matrix<double, 3, 3, Eigen::RowMajor>(R_camera2gimbal_data.data());
+  Eigen::Vector3d t_camera2gimbal(t_camera2gimbal_data.data());
+
+  // 云台系即世界系, 两种方法只差在相机系中的PnP
+  auto_buff::Solver solver(config_path);
+  solver.set_R_gimbal2world(Eigen::Quaterniond::Identity());
+
+  // buff坐标系x轴(法向)指向相机, z轴朝上
+  Eigen::Matrix3d R_facing;
+  R_facing << 0, 1, 0, 0, 0, -1, -1, 0, 0;
+
+  cv::RNG rng(0);
+  double max_xyz_error = 0, max_ypr_error = 0;
+  double solve_time = 0, opencv_time = 0;  // s
+
+  for (int f = 0; f < frames; f++) {
+    // 能量机关在前方5~8m, 法向偏离视线±30°, 目标扇叶在任意角度
+    Eigen::Vector3d t_buff2camera(
+      rng.uniform(-1.0, 1.0), rng.uniform(-1.0, 0.5), rng.uniform(5.0, 8.0));
+    Eigen::Matrix3d R_buff2camera =
+      Eigen::AngleAxisd(rng.uniform(-0.5, 0.5), Eigen::Vector3d::UnitY()) * R_facing *
+      Eigen::AngleAxisd(rng.uniform(0.0, CV_2PI), Eigen::Vector3d::UnitX());
+
+    cv::Mat rvec, tvec;
+    cv::eigen2cv(t_buff2camera, tvec);
+    cv::Mat R;
+    cv::eigen2cv(R_buff2camera, R);
+    cv::Rodrigues(R, rvec);
+    std::vector<cv::Point2f> image_points;
+    cv::projectPoints(OBJECT_POINTS, rvec, tvec, camera_matrix, distort_coeffs, image_points);
+    for (auto & point : image_points) point += cv::Point2f(rng.gaussian(0.5), rng.gaussian(0.5));
+
+    std::vector<cv::Point2f> blade_points(image_points.begin(), image_points.begin() + 4);
+    auto blade_center = (blade_points[0] + blade_points[2]) / 2;
+    std::vector<auto_buff::FanBlade> blades{
+      auto_buff::FanBlade(blade_points, blade_center, auto_buff::_target)};
+    std::optional<auto_buff::PowerRune> power_rune =
+      auto_buff::PowerRune(blades, image_points[4], std::nullopt);
+
+    auto t0 = std::chrono::steady_clock::now();
+    solver.solve(power_rune);
+    auto t1 = std::chrono::steady_clock::now();
+
+    // 参照: 与solve()相同, 只用扇叶的4个共面点
+    std::vector<cv::Point3f> object_points(OBJECT_POINTS.begin(), OBJECT_POINTS.begin() + 4);
+    cv::Vec3d rvec_ref, tvec_ref;
+    cv::solvePnP(
+      object_points, blade_points, camera_matrix, distort_coeffs, rvec_ref, tvec_ref, false,
+      cv::SOLVEPNP_IPPE);
+    auto t2 = std::chrono::steady_clock::now();
+
+    solve_time += tools::delta_time(t1, t0);
+    opencv_time += tools::delta_time(t2, t1);
+
+    Eigen::Vector3d xyz_in_camera;
+    cv::cv2eigen(tvec_ref, xyz_in_camera);
+    cv::Mat rmat;
+    cv::Rodrigues(rvec_ref, rmat);
+    Eigen::Matrix3d R_ref;
+    cv::cv2eigen(rmat, R_ref);
+
+    Eigen::Vector3d xyz_ref = R_camera2gimbal * xyz_in_camera + t_camera2gimbal;
+    Eigen::Vector3d ypr_ref = tools::eulers(R_camera2gimbal * R_ref, 2, 1, 0);
+
+    const auto & p = power_rune.value();
+    max_xyz_error = std::max(max_xyz_error, (p.xyz_in_world - xyz_ref).norm());
+    for (int i = 0; i < 3; i++) {
+      auto error = std::abs(tools::limit_rad(p.ypr_in_world[i] - ypr_ref[i]));
+      max_ypr_error = std::max(max_ypr_error, error);
+    }
+  }
+
+  tools::logger()->info(
+    "{} frames | max xyz error {:.2e}m | max ypr error {:.2e}deg", frames, max_xyz_error,
+    max_ypr_error * 57.3);
+  tools::logger()->info(
+    "[solve] {:.1f}us | [cv::solvePnP] {:.1f}us", solve_time / frames * 1e6,
+    opencv_time / frames * 1e6);
+
+  auto ok = max_xyz_error < xyz_tolerance && max_ypr_error < ypr_tolerance;
+  if (!ok) tools::logger()->error("solve differs from cv::solvePnP beyond tolerance!");
+
+  tools::logger()->info(ok ? "PASS" : "FAIL");
+  return ok ? 0 : 1;
+}
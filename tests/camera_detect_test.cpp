@@ -38,16 +38,19 @@ int main(int argc, char * argv[])
     cv::Mat img;
     std::list<auto_aim::Armor> armors;
 
-    camera.read(img, timestamp);
+    if (!camera.read(img, timestamp)) break;
 
     if (img.empty()) break;
 
     auto last = std::chrono::steady_clock::now();
 
-    if (use_tradition)
+    if (use_tradition) {
       armors = detector.detect(img);
-    else
+      cv::imshow("binary_img", detector.debug_binary_img());
+      cv::imshow("detection", detector.debug_img());
+    } else {
       armors = yolo.detect(img);
+    }
 
     auto now = std::chrono::steady_clock::now();
     auto dt = tools::delta_time(now, last);
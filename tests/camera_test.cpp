@@ -9,7 +9,8 @@
 const std::string keys =
   "{help h usage ? |                     | 输出命令行参数说明}"
   "{config-path c  | configs/camera.yaml | yaml配置文件路径 }"
-  "{d display      |                     | 显示视频流       }";
+  "{d display      |                     | 显示视频流       }"
+  "{r raw          |                     | 读取原图, 只解马赛克出640x640网络输入}";
 
 int main(int argc, char * argv[])
 {
@@ -23,13 +24,29 @@ int main(int argc, char * argv[])
 
   auto config_path = cli.get<std::string>("config-path");
   auto display = cli.has("display");
+  auto raw = cli.has("raw");
   io::Camera camera(config_path);
 
   cv::Mat img;
   std::chrono::steady_clock::time_point timestamp;
   auto last_stamp = std::chrono::steady_clock::now();
+  auto frame_count = 0;
   while (!exiter.exit()) {
-    camera.read(img, timestamp);
+    if (raw) {
+      cv::Mat raw_img;
+      io::BayerPattern pattern;
+      if (!camera.read_raw(raw_img, pattern, timestamp)) break;
+      io::demosaic_resize(raw_img, pattern, {640, 640}, img);
+    } else {
+      if (!camera.read(img, timestamp)) break;
+    }
+
+    if (++frame_count % 300 == 0) {
+      auto stats = camera.stats();
+      tools::logger()->info(
+        "published {}, overwritten {}, duplicate reads {}", stats.published, stats.overwritten,
+        stats.duplicate_reads);
+    }
 
     auto dt = tools::delta_time(timestamp, last_stamp);
     last_stamp = timestamp;
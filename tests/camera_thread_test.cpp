@@ -81,7 +81,7 @@ int main(int argc, char * argv[])
   int frame_id = 0;
 
   while (!exiter.exit()) {
-    camera.read(img, t);
+    if (!camera.read(img, t)) break;
     auto dt = tools::delta_time(t, last_t);
     last_t = t;
 
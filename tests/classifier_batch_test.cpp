@@ -0,0 +1,94 @@
+// 装甲板图案分类的基准测试: 逐个classify(armor) vs 一次classify(armors)
+//   ./classifier_batch_test configs/standard3.yaml --img=assets/img_with_q/0.jpg --num=32
+// 从图像中随机截取num个图案(图像为空时随机生成), 检查两种方式的结果一致, 输出每帧耗时
+
+#include <chrono>
+#include <opencv2/opencv.hpp>
+#include <vector>
+
+#include "tasks/auto_aim/classifier.hpp"
+#include "tools/logger.hpp"
+#include "tools/math_tools.hpp"
+
+const std::string keys =
+  "{help h usage ? |                        | 输出命令行参数说明}"
+  "{@config-path   | configs/standard3.yaml | 位置参数，yaml配置文件路径 }"
+  "{img i          |                        | 输入图像, 为空时随机生成 }"
+  "{num n          | 32                     | 每帧的候选装甲板数 }"
+  "{frames f       | 200                    | 测试帧数 }";
+
+int main(int argc, char * argv[])
+{
+  cv::CommandLineParser cli(argc, argv, keys);
+  if (cli.has("help")) {
+    cli.printMessage();
+    return 0;
+  }
+  auto config_path = cli.get<std::string>(0);
+  auto img_path = cli.get<std::string>("img");
+  auto num = cli.get<int>("num");
+  auto frames = cli.get<int>("frames");
+
+  cv::Mat img;
+  if (!img_path.empty()) {
+    img = cv::imread(img_path);
+  } else {
+    img = cv::Mat(720, 1280, CV_8UC3);
+    cv::randu(img, cv::Scalar::all(0), cv::Scalar::all(255));
+  }
+  if (img.empty()) {
+    tools::logger()->error("Failed to read {}", img_path);
+    return 1;
+  }
+
+  // 与Detector::get_pattern相近的尺寸: 宽20~120, 高宽比0.5~1.5
+  cv::RNG rng(0);
+  std::vector<auto_aim::Armor> armors;
+  for (int i = 0; i < num; i++) {
+    auto w = rng.uniform(20, 120);
+    auto h = std::max(1, static_cast<int>(w * rng.uniform(0.5, 1.5)));
+    auto x = rng.uniform(0, img.cols - w);
+    auto y = rng.uniform(0, img.rows - h);
+    cv::Rect box(x, y, w, h);
+    std::vector<cv::Point2f> points = {
+      cv::Point2f(x, y), cv::Point2f(x + w, y), cv::Point2f(x + w, y + h), cv::Point2f(x, y + h)};
+    auto_aim::Armor armor(0, 0, box, points);
+    armor.pattern = img(box);
+    armors.push_back(armor);
+  }
+
+  auto_aim::Classifier classifier(config_path);
+
+  // 结果一致性
+  auto batched = armors;
+  classifier.classify(batched);
+  auto max_error = 0.0;
+  for (int i = 0; i < num; i++) {
+    classifier.classify(armors[i]);
+    if (armors[i].name != batched[i].name) {
+      tools::logger()->error(
+        "Armor {}: name {} != {}", i, static_cast<int>(armors[i].name),
+        static_cast<int>(batched[i].name));
+      return 1;
+    }
+    max_error = std::max(max_error, std::abs(armors[i].confidence - batched[i].confidence));
+  }
+  tools::logger()->info("{} patterns, same names, max confidence error {:.2e}", num, max_error);
+
+  auto t0 = std::chrono::steady_clock::now();
+  for (int f = 0; f < frames; f++) {
+    for (auto & armor : armors) classifier.classify(armor);
+  }
+  auto t1 = std::chrono::steady_clock::now();
+  for (int f = 0; f < frames; f++) {
+    classifier.classify(batched);
+  }
+  auto t2 = std::chrono::steady_clock::now();
+
+  auto single = tools::delta_time(t1, t0) / frames;
+  auto batch = tools::delta_time(t2, t1) / frames;
+  tools::logger()->info("[per armor] {:.2f}ms/frame", single * 1e3);
+  tools::logger()->info("[batched]   {:.2f}ms/frame, {:.1f}x", batch * 1e3, single / batch);
+
+  return 0;
+}
@@ -50,10 +50,13 @@ int main(int argc, char * argv[])
     if (img.empty()) break;
     // cv::GaussianBlur(img, img, cv::Size(5, 5), 0, 0, cv::BORDER_DEFAULT);
 
-    if (use_tradition)
+    if (use_tradition) {
       armors = detector.detect(img, frame_count);
-    else
+      cv::imshow("binary_img", detector.debug_binary_img());
+      cv::imshow("detection", detector.debug_img());
+    } else {
       armors = yolo.detect(img, frame_count);
+    }
 
     if (!armors.empty()) {
       nlohmann::json data;
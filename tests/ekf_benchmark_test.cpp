@@ -0,0 +1,282 @@
+// 扩展卡尔曼滤波器的微基准: 原实现(动态矩阵 + std::function + 逐次求逆) vs 定长模板
+//   ./ekf_benchmark_test --steps=10000
+// 用auto_aim::Target的11维整车模型跟踪仿真的旋转目标, 两种实现输入相同的观测,
+// 检查状态一致、P与原实现一致且保持对称半正定, 并输出predict、update的平均耗时
+
+#include <chrono>
+#include <functional>
+#include <map>
+#include <opencv2/opencv.hpp>
+
+#include "tools/extended_kalman_filter.hpp"
+#include "tools/logger.hpp"
+#include "tools/math_tools.hpp"
+
+const std::string keys =
+  "{help h usage ? |       | 输出命令行参数说明}"
+  "{steps s        | 10000 | 仿真步数 }"
+  "{dt             | 0.01  | 步长, s }";
+
+namespace
+{
+constexpr int ARMOR_NUM = 4;
+
+using State = Eigen::Matrix<double, 11, 1>;
+
+// 原实现, 仅用于对比
+class DynamicEKF
+{
+public:
+  Eigen::VectorXd x;
+  Eigen::MatrixXd P;
+  std::map<std::string, double> data;
+
+  DynamicEKF(
+    const Eigen::VectorXd & x0, const Eigen::MatrixXd & P0,
+    std::function<Eigen::VectorXd(const Eigen::VectorXd &, const Eigen::VectorXd &)> x_add)
+  : x(x0), P(P0), I_(Eigen::MatrixXd::Identity(x0.rows(), x0.rows())), x_add_(x_add)
+  {
+  }
+
+  void predict(
+    const Eigen::MatrixXd & F, const Eigen::MatrixXd & Q,
+    std::function<Eigen::VectorXd(const Eigen::VectorXd &)> f)
+  {
+    P = F * P * F.transpose() + Q;
+    x = f(x);
+  }
+
+  void update(
+    const Eigen::VectorXd & z, const Eigen::MatrixXd & H, const Eigen::MatrixXd & R,
+    std::function<Eigen::VectorXd(const Eigen::VectorXd &)> h,
+    std::function<Eigen::VectorXd(const Eigen::VectorXd &, const Eigen::VectorXd &)> z_subtract)
+  {
+    Eigen::VectorXd x_prior = x;
+    Eigen::MatrixXd K = P * H.transpose() * (H * P * H.transpose() + R).inverse();
+    P = (I_ - K * H) * P * (I_ - K * H).transpose() + K * R * K.transpose();
+    x = x_add_(x, K * z_subtract(z, h(x)));
+
+    Eigen::VectorXd residual = z_subtract(z, h(x));
+    Eigen::MatrixXd S = H * P * H.transpose() + R;
+    data["nis"] = residual.transpose() * S.inverse() * residual;
+    data["nees"] = (x - x_prior).transpose() * P.inverse() * (x - x_prior);
+    data["residual_yaw"] = residual[0];
+    data["residual_pitch"] = residual[1];
+    data["residual_distance"] = residual[2];
+    data["residual_angle"] = residual[3];
+  }
+
+private:
+  Eigen::MatrixXd I_;
+  std::function<Eigen::VectorXd(const Eigen::VectorXd &, const Eigen::VectorXd &)> x_add_;
+};
+
+struct StateAdd
+{
+  State operator()(const State & a, const State & b) const
+  {
+    State c = a + b;
+    c[6] = tools::limit_rad(c[6]);
+    return c;
+  }
+};
+
+using FixedEKF = tools::ExtendedKalmanFilter<11, 4, StateAdd>;
+
+// 与Target::predict相同的F与Q
+template <typename Matrix>
+void transition(double dt, Matrix & F, Matrix & Q)
+{
+  F = Matrix::Identity(11, 11);
+  Q = Matrix::Zero(11, 11);
+  for (int i = 0; i < 8; i += 2) {
+    auto v = (i == 6) ? 400.0 : 100.0;
+    F(i, i + 1) = dt;
+    Q(i, i) = dt * dt * dt * dt / 4 * v;
+    Q(i, i + 1) = Q(i + 1, i) = dt * dt * dt / 2 * v;
+    Q(i + 1, i + 1) = dt * dt * v;
+  }
+}
+
+// 与Target::h_armor_xyz、h_jacobian相同
+template <typename Vector>
+Eigen::Vector3d armor_xyz(const Vector & x, int id)
+{
+  auto angle = tools::limit_rad(x[6] + id * 2 * CV_PI / ARMOR_NUM);
+  auto use_l_h = (id == 1 || id == 3);
+  auto r = use_l_h ? x[8] + x[9] : x[8];
+  auto z = use_l_h ? x[4] + x[10] : x[4];
+  return {x[0] - r * std::cos(angle), x[2] - r * std::sin(angle), z};
+}
+
+template <typename Vector>
+Eigen::Vector4d measure(const Vector & x, int id)
+{
+  Eigen::Vector3d ypd = tools::xyz2ypd(armor_xyz(x, id));
+  return {ypd[0], ypd[1], ypd[2], tools::limit_rad(x[6] + id * 2 * CV_PI / ARMOR_NUM)};
+}
+
+template <typename Vector>
+Eigen::Matrix<double, 4, 11> jacobian(const Vector & x, int id)
+{
+  auto angle = tools::limit_rad(x[6] + id * 2 * CV_PI / ARMOR_NUM);
+  auto use_l_h = (id == 1 || id == 3);
+  auto r = use_l_h ? x[8] + x[9] : x[8];
+  auto l = use_l_h ? 1.0 : 0.0;
+
+  Eigen::Matrix<double, 4, 11> H_xyza = Eigen::Matrix<double, 4, 11>::Zero();
+  H_xyza(0, 0) = 1, H_xyza(0, 6) = r * std::sin(angle);
+  H_xyza(0, 8) = -std::cos(angle), H_xyza(0, 9) = -l * std::cos(angle);
+  H_xyza(1, 2) = 1, H_xyza(1, 6) = -r * std::cos(angle);
+  H_xyza(1, 8) = -std::sin(angle), H_xyza(1, 9) = -l * std::sin(angle);
+  H_xyza(2, 4) = 1, H_xyza(2, 10) = l;
+  H_xyza(3, 6) = 1;
+
+  Eigen::Matrix4d H_ypda = Eigen::Matrix4d::Identity();
+  H_ypda.topLeftCorner<3, 3>() = tools::xyz2ypd_jacobian(armor_xyz(x, id));
+  return H_ypda * H_xyza;
+}
+
+Eigen::Vector4d z_subtract(const Eigen::Vector4d & a, const Eigen::Vector4d & b)
+{
+  Eigen::Vector4d c = a - b;
+  c[0] = tools::limit_rad(c[0]);
+  c[1] = tools::limit_rad(c[1]);
+  c[3] = tools::limit_rad(c[3]);
+  return c;
+}
+
+}  // namespace
+
+int main(int argc, char * argv[])
+{
+  cv::CommandLineParser cli(argc, argv, keys);
+  if (cli.has("help")) {
+    cli.printMessage();
+    return 0;
+  }
+  auto steps = cli.get<int>("steps");
+  auto dt = cli.get<double>("dt");
+
+  // 真实状态: 3m外匀速平移, 6rad/s小陀螺
+  State truth{{3, 0.5, 0.5, 0, 0.1, 0, 0, 6, 0.25, 0.03, 0.05}};
+  State x0 = truth;
+  x0[1] = x0[3] = x0[7] = 0;
+  State P0_dig{{1, 64, 1, 64, 1, 64, 0.4, 100, 1, 1, 1}};
+  Eigen::Vector4d R_dig{{4e-3, 4e-3, 1, 9e-2}};
+  Eigen::Matrix4d R = R_dig.asDiagonal();
+
+  auto x_add = [](const Eigen::VectorXd & a, const Eigen::VectorXd & b) -> Eigen::VectorXd {
+    Eigen::VectorXd c = a + b;
+    c[6] = tools::limit_rad(c[6]);
+    return c;
+  };
+  DynamicEKF dynamic_ekf(x0, P0_dig.asDiagonal(), x_add);
+  FixedEKF fixed_ekf(x0, P0_dig.asDiagonal());
+  FixedEKF diagnosed_ekf(x0, P0_dig.asDiagonal());
+  diagnosed_ekf.diagnose = true;
+
+  cv::RNG rng(0);
+  double max_error = 0;
+  double max_P_error = 0, max_asymmetry = 0, min_eigenvalue = 1e10;  // 相对于P的最大元素
+  double dynamic_predict = 0, dynamic_update = 0;  // s
+  double fixed_predict = 0, fixed_update = 0;
+  double diagnosed_update = 0;
+
+  for (int step = 0; step < steps; step++) {
+    truth[0] += truth[1] * dt;
+    truth[6] = tools::limit_rad(truth[6] + truth[7] * dt);
+
+    // 观测朝向相机的装甲板
+    int id = 0;
+    auto min_error = 1e10;
+    for (int i = 0; i < ARMOR_NUM; i++) {
+      auto angle = truth[6] + i * 2 * CV_PI / ARMOR_NUM;
+      auto error = std::abs(tools::limit_rad(angle - std::atan2(truth[2], truth[0])));
+      if (error < min_error) min_error = error, id = i;
+    }
+    Eigen::Vector4d z = measure(truth, id);
+    for (int i = 0; i < 4; i++) z[i] += rng.gaussian(std::sqrt(R_dig[i]) * 0.1);
+
+    // 原实现
+    {
+      Eigen::MatrixXd F, Q;
+      auto t0 = std::chrono::steady_clock::now();
+      transition(dt, F, Q);
+      dynamic_ekf.predict(F, Q, [&](const Eigen::VectorXd & x) -> Eigen::VectorXd {
+        Eigen::VectorXd x_prior = F * x;
+        x_prior[6] = tools::limit_rad(x_prior[6]);
+        return x_prior;
+      });
+      auto t1 = std::chrono::steady_clock::now();
+      Eigen::MatrixXd H = jacobian(dynamic_ekf.x, id);
+      dynamic_ekf.update(
+        z, H, R, [&](const Eigen::VectorXd & x) -> Eigen::VectorXd { return measure(x, id); },
+        [](const Eigen::VectorXd & a, const Eigen::VectorXd & b) -> Eigen::VectorXd {
+          return z_subtract(a, b);
+        });
+      auto t2 = std::chrono::steady_clock::now();
+      dynamic_predict += tools::delta_time(t1, t0);
+      dynamic_update += tools::delta_time(t2, t1);
+    }
+
+    // 固定维度
+    for (auto * ekf : {&fixed_ekf, &diagnosed_ekf}) {
+      FixedEKF::MatrixX F, Q;
+      auto t0 = std::chrono::steady_clock::now();
+      transition(dt, F, Q);
+      ekf->predict(F, Q, [&](const State & x) -> State {
+        State x_prior = F * x;
+        x_prior[6] = tools::limit_rad(x_prior[6]);
+        return x_prior;
+      });
+      auto t1 = std::chrono::steady_clock::now();
+      Eigen::Matrix<double, 4, 11> H = jacobian(ekf->x, id);
+      ekf->update(
+        z, H, R, [&](const State & x) { return measure(x, id); },
+        [](const Eigen::Vector4d & a, const Eigen::Vector4d & b) { return z_subtract(a, b); });
+      auto t2 = std::chrono::steady_clock::now();
+      if (ekf == &fixed_ekf) {
+        fixed_predict += tools::delta_time(t1, t0);
+        fixed_update += tools::delta_time(t2, t1);
+      } else {
+        diagnosed_update += tools::delta_time(t2, t1);
+      }
+    }
+
+    Eigen::VectorXd error = dynamic_ekf.x - fixed_ekf.x;
+    error[6] = tools::limit_rad(error[6]);
+    max_error = std::max(max_error, error.cwiseAbs().maxCoeff());
+
+    // 检查P保持对称半正定, 并与原实现的Joseph形式一致
+    const auto & P = fixed_ekf.P;
+    auto scale = P.cwiseAbs().maxCoeff();
+    Eigen::SelfAdjointEigenSolver<FixedEKF::MatrixX> eigen(P, Eigen::EigenvaluesOnly);
+    max_P_error = std::max(max_P_error, (dynamic_ekf.P - P).cwiseAbs().maxCoeff() / scale);
+    max_asymmetry = std::max(max_asymmetry, (P - P.transpose()).cwiseAbs().maxCoeff() / scale);
+    min_eigenvalue = std::min(min_eigenvalue, eigen.eigenvalues().minCoeff() / scale);
+  }
+
+  tools::logger()->info(
+    "{} steps | max state error {:.2e} | nis {:.3f} vs {:.3f}", steps, max_error,
+    dynamic_ekf.data["nis"], diagnosed_ekf.diagnostics.nis);
+  tools::logger()->info(
+    "P vs Joseph form {:.2e} | asymmetry {:.2e} | min eigenvalue {:.2e}", max_P_error,
+    max_asymmetry, min_eigenvalue);
+  tools::logger()->info(
+    "[dynamic] predict {:.2f}us | update {:.2f}us", dynamic_predict / steps * 1e6,
+    dynamic_update / steps * 1e6);
+  tools::logger()->info(
+    "[fixed]   predict {:.2f}us | update {:.2f}us ({:.2f}us with diagnostics) | {:.1f}x",
+    fixed_predict / steps * 1e6, fixed_update / steps * 1e6, diagnosed_update / steps * 1e6,
+    (dynamic_predict + dynamic_update) / (fixed_predict + fixed_update));
+
+  // 关闭diagnose时nis的滑动窗口同样要更新, Tracker据此判断收敛
+  auto nis_ok = fixed_ekf.nis_fail_count() == diagnosed_ekf.nis_fail_count();
+  if (!nis_ok) tools::logger()->error("nis_fail_count depends on diagnose!");
+
+  auto P_ok = max_P_error < 1e-9 && max_asymmetry < 1e-12 && min_eigenvalue > -1e-12;
+  if (!P_ok) tools::logger()->error("P is not symmetric positive semi-definite!");
+
+  return max_error < 1e-6 && nis_ok && P_ok ? 0 : 1;
+}
@@ -0,0 +1,127 @@
+// 用pty对验证云台串口解帧器:
+// 发送端以远高于实际链路的速率写入GimbalToVision, 并混入随机噪声和损坏的帧,
+// 接收端用serial::Serial + FrameDecoder读取, 检查完好的帧全部解出且损坏的帧全部被丢弃
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <random>
+#include <thread>
+
+#include "io/gimbal/frame_decoder.hpp"
+#include "io/gimbal/gimbal.hpp"
+#include "serial/serial.h"
+#include "tools/crc.hpp"
+#include "tools/logger.hpp"
+
+using namespace std::chrono_literals;
+
+constexpr int FRAME_NUM = 200000;
+constexpr double NOISE_PROBABILITY = 0.2;    // 帧之间插入噪声的概率
+constexpr double CORRUPT_PROBABILITY = 0.05;  // 帧内翻转一个比特的概率
+
+int main()
+{
+  int master = posix_openpt(O_RDWR | O_NOCTTY);
+  if (master < 0 || grantpt(master) || unlockpt(master)) {
+    tools::logger()->error("Failed to open pty!");
+    return 1;
+  }
+
+  serial::Serial serial;
+  serial.setPort(ptsname(master));
+  serial::Timeout timeout = serial::Timeout::simpleTimeout(100);
+  serial.setTimeout(timeout);
+  serial.open();
+
+  std::atomic<bool> done = false;
+  int intact_count = 0;
+  int corrupt_count = 0;
+  size_t sent_bytes = 0;
+
+  auto begin = std::chrono::steady_clock::now();
+
+  std::thread writer([&] {
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<double> uniform(0, 1);
+    std::uniform_int_distribution<int> byte(0, 255);
+    std::vector<uint8_t> chunk;
+
+    for (int i = 0; i < FRAME_NUM; i++) {
+      if (uniform(rng) < NOISE_PROBABILITY) {
+        auto noise_len = byte(rng) % 40;
+        for (int j = 0; j < noise_len; j++) chunk.push_back(j % 7 == 0 ? 'S' : byte(rng));
+      }
+
+      io::GimbalToVision frame;
+      frame.mode = 1;
+      frame.q[0] = 1, frame.q[1] = frame.q[2] = frame.q[3] = 0;
+      frame.bullet_count = i;
+      frame.crc16 = tools::get_crc16(
+        reinterpret_cast<uint8_t *>(&frame), sizeof(frame) - sizeof(frame.crc16));
+
+      auto bytes = reinterpret_cast<uint8_t *>(&frame);
+      if (uniform(rng) < CORRUPT_PROBABILITY) {
+        bytes[2 + byte(rng) % (sizeof(frame) - 2)] ^= 1 << (byte(rng) % 8);
+        corrupt_count++;
+      } else {
+        intact_count++;
+      }
+      chunk.insert(chunk.end(), bytes, bytes + sizeof(frame));
+
+      // 攒一批再写, 模拟高负载下的突发
+      if (chunk.size() < 4096 && i != FRAME_NUM - 1) continue;
+      for (size_t written = 0; written < chunk.size();) {
+        auto n = ::write(master, chunk.data() + written, chunk.size() - written);
+        if (n > 0) written += n;
+      }
+      sent_bytes += chunk.size();
+      chunk.clear();
+    }
+    done = true;
+  });
+
+  io::FrameDecoder<io::GimbalToVision> decoder;
+  int received = 0;
+  int out_of_order = 0;
+  uint16_t last_count = 0;
+
+  while (true) {
+    if (!serial.waitReadable()) {
+      if (done) break;
+      continue;
+    }
+
+    size_t capacity;
+    auto buffer = decoder.write_ptr(capacity);
+    auto n = serial.read(buffer, std::min(std::max<size_t>(serial.available(), 1), capacity));
+    decoder.commit(n, [&](const io::GimbalToVision & frame) {
+      received++;
+      // bullet_count逐帧加1(会回绕), 中间只会因损坏的帧而跳过少量计数
+      uint16_t step = frame.bullet_count - last_count;
+      if (received > 1 && (step == 0 || step > 100)) out_of_order++;
+      last_count = frame.bullet_count;
+    });
+  }
+
+  writer.join();
+  auto seconds =
+    std::chrono::duration<double>(std::chrono::steady_clock::now() - begin - 100ms).count();
+
+  tools::logger()->info(
+    "sent {} intact + {} corrupt frames ({:.1f} MB/s, {:.0f} frames/s)", intact_count,
+    corrupt_count, sent_bytes / seconds / 1e6, FRAME_NUM / seconds);
+  tools::logger()->info(
+    "decoded {} frames, crc errors {}, discarded {} bytes, out of order {}", received,
+    decoder.crc_errors(), decoder.discarded_bytes(), out_of_order);
+
+  serial.close();
+  ::close(master);
+
+  auto ok = received == intact_count && out_of_order == 0;
+  tools::logger()->info(ok ? "PASS" : "FAIL");
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,123 @@
+// 用pty模拟回传命令序号的下位机, 验证Gimbal的延迟测量:
+//   ./gimbal_latency_test [单程延迟ms]
+// 下位机以1kHz发送GimbalToVisionEcho, 收到的命令和发出的帧各自延迟指定的时间, 模拟对称的链路
+// 视觉端以100Hz发送变化的命令, 检查测得的往返时间与命令延迟是否符合设定
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <deque>
+#include <fstream>
+#include <thread>
+
+#include "io/gimbal/frame_decoder.hpp"
+#include "io/gimbal/gimbal.hpp"
+#include "tools/crc.hpp"
+#include "tools/logger.hpp"
+#include "tools/math_tools.hpp"
+
+using namespace std::chrono_literals;
+
+constexpr double TOLERANCE = 2e-3;  // s
+
+int main(int argc, char * argv[])
+{
+  auto delay = (argc > 1 ? std::atof(argv[1]) : 5.0) * 1e-3;
+
+  int master = posix_openpt(O_RDWR | O_NOCTTY);
+  if (master < 0 || grantpt(master) || unlockpt(master)) {
+    tools::logger()->error("Failed to open pty!");
+    return 1;
+  }
+  fcntl(master, F_SETFL, O_NONBLOCK);
+
+  auto config_path = "/tmp/gimbal_latency_test.yaml";
+  std::ofstream(config_path) << "com_port: \"" << ptsname(master) << "\"\ncommand_echo: true\n";
+
+  std::atomic<bool> quit = false;
+
+  // 下位机替身
+  std::thread stand_in([&] {
+    struct Pending
+    {
+      std::chrono::steady_clock::time_point due;
+      uint16_t seq;
+      io::GimbalToVisionEcho frame;
+    };
+    std::deque<Pending> inbox, outbox;
+    io::FrameDecoder<io::VisionToGimbalSeq> decoder;
+    uint16_t seq = 0;
+    auto received = std::chrono::steady_clock::now();
+    auto next = std::chrono::steady_clock::now();
+
+    while (!quit) {
+      next += 1ms;
+      std::this_thread::sleep_until(next);
+      auto now = std::chrono::steady_clock::now();
+
+      // 收: 命令在delay之后才算到达
+      size_t capacity;
+      auto buffer = decoder.write_ptr(capacity);
+      auto n = ::read(master, buffer, capacity);
+      decoder.commit(n > 0 ? n : 0, [&](const io::VisionToGimbalSeq & command) {
+        inbox.push_back({now + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                                 std::chrono::duration<double>(delay)),
+                         command.seq,
+                         {}});
+      });
+      while (!inbox.empty() && inbox.front().due <= now) {
+        seq = inbox.front().seq;
+        received = inbox.front().due;
+        inbox.pop_front();
+      }
+
+      // 发: 帧在delay之后才写出
+      io::GimbalToVisionEcho frame;
+      frame.mode = 1;
+      frame.q[0] = 1, frame.q[1] = frame.q[2] = frame.q[3] = 0;
+      frame.bullet_count = 0;
+      frame.echo_seq = seq;
+      frame.echo_age = seq == 0 ? 0 : tools::delta_time(now, received) * 1e4;
+      frame.crc16 = tools::get_crc16(
+        reinterpret_cast<uint8_t *>(&frame), sizeof(frame) - sizeof(frame.crc16));
+      outbox.push_back({now + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                                std::chrono::duration<double>(delay)),
+                        seq, frame});
+      while (!outbox.empty() && outbox.front().due <= now) {
+        ::write(master, &outbox.front().frame, sizeof(io::GimbalToVisionEcho));
+        outbox.pop_front();
+      }
+    }
+  });
+
+  int ok = 0;
+  {
+    io::Gimbal gimbal(config_path);
+
+    for (int i = 0; i < 300; i++) {
+      gimbal.send(true, false, i * 1e-3, 0, 0, 0, 0, 0);
+      std::this_thread::sleep_for(10ms);
+    }
+
+    auto & latency = *gimbal.command_latency();
+    auto & rtt = *gimbal.round_trip();
+    tools::logger()->info(
+      "set one-way delay {:.1f}ms | {} samples | rtt p50 {:.2f}ms p90 {:.2f}ms | command latency "
+      "p50 {:.2f}ms p90 {:.2f}ms mean {:.2f}ms",
+      delay * 1e3, latency.count(), rtt.percentile(0.5) * 1e3, rtt.percentile(0.9) * 1e3,
+      latency.percentile(0.5) * 1e3, latency.percentile(0.9) * 1e3, latency.mean() * 1e3);
+
+    ok = latency.count() > 200 && std::abs(rtt.percentile(0.5) - 2 * delay) < 2 * TOLERANCE &&
+         std::abs(latency.percentile(0.5) - delay) < TOLERANCE;
+  }
+
+  quit = true;
+  stand_in.join();
+  ::close(master);
+
+  tools::logger()->info(ok ? "PASS" : "FAIL");
+  return ok ? 0 : 1;
+}
@@ -54,7 +54,7 @@ int main(int argc, char * argv[])
     }
   }
   while (!exiter.exit()) {
-    camera.read(img, t);
+    if (!camera.read(img, t)) break;
     q = cboard.imu_at(t - 1ms * delay);
     solver.set_R_gimbal2world(q);
     cv::Mat result = img.clone();
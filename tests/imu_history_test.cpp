@@ -0,0 +1,64 @@
+// ImuHistory的stale告警测试, 不需要下位机:
+//   ./imu_history_test
+// 1. 链路中断(最新样本过旧)时attitude_at()标记stale, 且第一次查询就触发告警
+// 2. 1s内的重复查询不再告警, 1s后再次告警
+// 3. 数据新鲜时不告警
+
+#include <chrono>
+
+#include "tools/imu_history.hpp"
+#include "tools/logger.hpp"
+
+using namespace std::chrono_literals;
+
+// 以now - age为最新样本的时刻, 每1ms写入一个样本
+void push_samples(
+  tools::ImuHistory & history, std::chrono::steady_clock::time_point now, double age)
+{
+  auto newest = now - std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                        std::chrono::duration<double>(age));
+  for (int i = 9; i >= 0; i--) history.push(Eigen::Quaterniond::Identity(), newest - i * 1ms);
+}
+
+bool test_stale()
+{
+  tools::ImuHistory history(100);
+  auto now = std::chrono::steady_clock::now();
+  push_samples(history, now, 0.5);
+
+  auto attitude = history.attitude_at(now);
+  auto first = history.stale_warning_due(attitude, now);
+  auto repeated = history.stale_warning_due(attitude, now + 500ms);
+  auto later = history.stale_warning_due(attitude, now + 1100ms);
+
+  auto ok = attitude.stale && first && !repeated && later;
+  tools::logger()->info(
+    "[stale] age {:.1f}ms, stale {} | warned first {}, within 1s {}, after 1s {} | {}",
+    attitude.age * 1e3, attitude.stale, first, repeated, later, ok ? "ok" : "FAIL");
+  return ok;
+}
+
+bool test_fresh()
+{
+  tools::ImuHistory history(100);
+  auto now = std::chrono::steady_clock::now();
+  push_samples(history, now, 0.005);
+
+  auto attitude = history.attitude_at(now);
+  auto warned = history.stale_warning_due(attitude, now);
+
+  auto ok = !attitude.stale && !warned;
+  tools::logger()->info(
+    "[fresh] age {:.1f}ms, stale {} | warned {} | {}", attitude.age * 1e3, attitude.stale, warned,
+    ok ? "ok" : "FAIL");
+  return ok;
+}
+
+int main()
+{
+  auto ok = test_stale();
+  ok = test_fresh() && ok;
+
+  tools::logger()->info(ok ? "PASS" : "FAIL");
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,125 @@
+// InferenceScheduler的调度规则测试, 不需要模型与相机:
+//   ./inference_scheduler_test
+// 1. 同时执行的请求数不超过scheduler_slots
+// 2. 槽位空出时, 等待中的主相机请求先于更早到达的全向相机请求
+// 3. 全向相机两次推理的间隔小于omni_min_interval时被跳过
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "tasks/auto_aim/inference_scheduler.hpp"
+#include "tools/logger.hpp"
+
+using namespace std::chrono_literals;
+using Scheduler = auto_aim::InferenceScheduler;
+
+constexpr auto CONFIG_PATH = "/tmp/inference_scheduler_test.yaml";
+
+// 预算取大值, 避免主相机超时改变全向相机的间隔
+void write_config(int slots, double omni_min_interval_ms)
+{
+  std::ofstream(CONFIG_PATH) << "scheduler_slots: " << slots << "\n"
+                             << "main_budget_ms: 1000\n"
+                             << "omni_min_interval_ms: " << omni_min_interval_ms << "\n";
+}
+
+bool test_slots()
+{
+  constexpr int SLOTS = 2;
+  write_config(SLOTS, 0);
+  Scheduler scheduler(CONFIG_PATH);
+
+  std::atomic<int> running = 0, max_running = 0;
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 3 * SLOTS; i++) {
+    threads.emplace_back([&] {
+      scheduler.run(Scheduler::MAIN, [&] {
+        auto n = ++running;
+        auto max = max_running.load();
+        while (n > max && !max_running.compare_exchange_weak(max, n)) continue;
+        std::this_thread::sleep_for(20ms);
+        return --running;
+      });
+    });
+  }
+  for (auto & t : threads) t.join();
+
+  auto ok = max_running == SLOTS && scheduler.stats(Scheduler::MAIN).completed == 3 * SLOTS;
+  tools::logger()->info(
+    "[slots] {} slots, at most {} running | {}", SLOTS, max_running.load(), ok ? "ok" : "FAIL");
+  return ok;
+}
+
+bool test_priority()
+{
+  write_config(1, 0);
+  Scheduler scheduler(CONFIG_PATH);
+
+  std::mutex order_mutex;
+  std::vector<Scheduler::Priority> order;
+  auto request = [&](Scheduler::Priority priority) {
+    scheduler.run(priority, [&] {
+      std::lock_guard<std::mutex> lock(order_mutex);
+      order.push_back(priority);
+      return 0;
+    });
+  };
+
+  // 占住唯一的槽位, 期间全向相机先到、主相机后到
+  std::thread holder([&] {
+    scheduler.run(Scheduler::MAIN, [] {
+      std::this_thread::sleep_for(100ms);
+      return 0;
+    });
+  });
+  std::this_thread::sleep_for(20ms);
+  std::thread omni(request, Scheduler::OMNI);
+  std::this_thread::sleep_for(20ms);
+  std::thread main(request, Scheduler::MAIN);
+
+  holder.join();
+  omni.join();
+  main.join();
+
+  auto ok = order.size() == 2 && order[0] == Scheduler::MAIN && order[1] == Scheduler::OMNI;
+  tools::logger()->info(
+    "[priority] omni queued first, {} ran first | {}",
+    order.empty() ? "none" : (order[0] == Scheduler::MAIN ? "main" : "omni"), ok ? "ok" : "FAIL");
+  return ok;
+}
+
+bool test_omni_interval()
+{
+  write_config(1, 50);
+  Scheduler scheduler(CONFIG_PATH);
+
+  // 构造时刻计为上一次全向推理, 先等过一个间隔
+  std::this_thread::sleep_for(60ms);
+  auto first = scheduler.run(Scheduler::OMNI, [] { return 0; });
+  auto second = scheduler.run(Scheduler::OMNI, [] { return 0; });
+  std::this_thread::sleep_for(60ms);
+  auto third = scheduler.run(Scheduler::OMNI, [] { return 0; });
+
+  auto stats = scheduler.stats(Scheduler::OMNI);
+  auto ok = first.has_value() && !second.has_value() && third.has_value() && stats.skipped == 1;
+  tools::logger()->info(
+    "[omni interval] {} requests, {} skipped | {}", stats.requests, stats.skipped,
+    ok ? "ok" : "FAIL");
+  return ok;
+}
+
+int main()
+{
+  auto ok = test_slots();
+  ok = test_priority() && ok;
+  ok = test_omni_interval() && ok;
+
+  tools::logger()->info(ok ? "PASS" : "FAIL");
+  return ok ? 0 : 1;
+}
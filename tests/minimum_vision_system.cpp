@@ -37,6 +37,7 @@ int main(int argc, char * argv[])
   auto_aim::multithread::MultiThreadDetector detector(config_path);
   auto_aim::Solver solver(config_path);
   auto_aim::Tracker tracker(config_path, solver);
+  tracker.set_ekf_diagnostics(true);
   auto_aim::Aimer aimer(config_path);
   auto_aim::Shooter shooter(config_path);
 
@@ -45,9 +46,10 @@ int main(int argc, char * argv[])
     std::chrono::steady_clock::time_point t;
 
     while (!exiter.exit()) {
-      camera.read(img, t);
+      if (!camera.read(img, t)) break;
       detector.push(img, t);
     }
+    detector.close();
   });
 
   auto last_t = std::chrono::steady_clock::now();
@@ -55,6 +57,7 @@ int main(int argc, char * argv[])
 
   while (!exiter.exit()) {
     auto [img, armors, t] = detector.debug_pop();
+    if (img.empty()) break;  // 回放结束
 
     Eigen::Quaterniond q = dm_imu.imu_at(t);
 
@@ -131,15 +134,16 @@ int main(int argc, char * argv[])
       data["distance"] = std::sqrt(x[0] * x[0] + x[2] * x[2] + x[4] * x[4]);
 
       // 卡方检验数据
-      data["residual_yaw"] = target.ekf().data.at("residual_yaw");
-      data["residual_pitch"] = target.ekf().data.at("residual_pitch");
-      data["residual_distance"] = target.ekf().data.at("residual_distance");
-      data["residual_angle"] = target.ekf().data.at("residual_angle");
-      data["nis"] = target.ekf().data.at("nis");
-      data["nees"] = target.ekf().data.at("nees");
-      data["nis_fail"] = target.ekf().data.at("nis_fail");
-      data["nees_fail"] = target.ekf().data.at("nees_fail");
-      data["recent_nis_failures"] = target.ekf().data.at("recent_nis_failures");
+      const auto & diagnostics = target.ekf().diagnostics;
+      data["residual_yaw"] = diagnostics.residual[0];
+      data["residual_pitch"] = diagnostics.residual[1];
+      data["residual_distance"] = diagnostics.residual[2];
+      data["residual_angle"] = diagnostics.residual[3];
+      data["nis"] = diagnostics.nis;
+      data["nees"] = diagnostics.nees;
+      data["nis_fail"] = diagnostics.nis_fail ? 1 : 0;
+      data["nees_fail"] = diagnostics.nees_fail ? 1 : 0;
+      data["nis_fail_rate"] = diagnostics.nis_fail_rate;
     }
     cv::resize(img, img, {}, 0.5, 0.5);  // 显示时缩小图片尺寸
     cv::imshow("reprojection", img);
@@ -149,5 +153,6 @@ int main(int argc, char * argv[])
 
   detect_thread.join();
 
+  camera.report();
   return 0;
 }
\ No newline at end of file
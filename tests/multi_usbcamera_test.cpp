@@ -36,7 +36,7 @@ int main(int argc, char * argv[])
   while (!exiter.exit()) {
     usbcam1.read(img1, timestamp);
     usbcam2.read(img2, timestamp);
-    camera.read(img3, timestamp);
+    if (!camera.read(img3, timestamp)) break;
 
     auto dt = tools::delta_time(timestamp, last_stamp);
     last_stamp = timestamp;
@@ -0,0 +1,175 @@
+// 全向感知推理方式的基准测试: 每路相机一个线程batch-1推理(Perceptron) vs batch推理(BatchPerceptron)
+//   ./omni_batch_test configs/sentry.yaml --img=assets/img_with_q/0.jpg --cams=4 --seconds=10
+// 不使用真实相机, 每路输入同一张图像(为空时随机生成)或其水平翻转, 输出总帧率与每帧的CPU时间
+// 计时前先检查batch推理(含某一路掉帧时)的结果与逐张推理一致, 不一致时返回1
+
+#include <fmt/core.h>
+
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <ctime>
+#include <list>
+#include <memory>
+#include <opencv2/opencv.hpp>
+#include <thread>
+#include <vector>
+
+#include "tasks/auto_aim/yolo.hpp"
+#include "tasks/omniperception/batch_detector.hpp"
+#include "tools/logger.hpp"
+#include "tools/math_tools.hpp"
+
+const std::string keys =
+  "{help h usage ? |                     | 输出命令行参数说明}"
+  "{@config-path   | configs/sentry.yaml | 位置参数，yaml配置文件路径 }"
+  "{img i          |                     | 输入图像, 为空时随机生成 }"
+  "{cams c         | 4                   | 相机路数 }"
+  "{seconds s      | 10                  | 每种方式的测试时长 }";
+
+struct Result
+{
+  int frames;
+  double wall, cpu;  // s
+};
+
+template <typename F>
+Result measure(double seconds, F && run)
+{
+  auto t0 = std::chrono::steady_clock::now();
+  auto c0 = std::clock();
+  auto frames = run(t0 + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                          std::chrono::duration<double>(seconds)));
+  auto c1 = std::clock();
+  auto t1 = std::chrono::steady_clock::now();
+  return {frames, tools::delta_time(t1, t0), static_cast<double>(c1 - c0) / CLOCKS_PER_SEC};
+}
+
+// 逐张推理与batch推理的装甲板应一一对应
+constexpr double MAX_POINT_ERROR = 1.0;        // pixel
+constexpr double MAX_CONFIDENCE_ERROR = 0.01;
+
+bool same_armors(
+  const std::list<auto_aim::Armor> & expected, const std::list<auto_aim::Armor> & actual)
+{
+  if (expected.size() != actual.size()) return false;
+
+  for (const auto & e : expected) {
+    auto matched = false;
+    for (const auto & a : actual) {
+      if (a.name != e.name || a.color != e.color) continue;
+      if (std::abs(a.confidence - e.confidence) > MAX_CONFIDENCE_ERROR) continue;
+
+      auto max_error = 0.0;
+      for (size_t i = 0; i < e.points.size(); i++)
+        max_error = std::max(max_error, cv::norm(a.points[i] - e.points[i]));
+      if (max_error > MAX_POINT_ERROR) continue;
+
+      matched = true;
+      break;
+    }
+    if (!matched) return false;
+  }
+  return true;
+}
+
+void report(const std::string & name, const Result & r, int cams)
+{
+  tools::logger()->info(
+    "[{}] {:.1f} fps total ({:.1f} per camera) | cpu {:.1f}ms/frame | cpu load {:.0f}%", name,
+    r.frames / r.wall, r.frames / r.wall / cams, r.cpu / r.frames * 1e3, r.cpu / r.wall * 100);
+}
+
+int main(int argc, char * argv[])
+{
+  cv::CommandLineParser cli(argc, argv, keys);
+  if (cli.has("help")) {
+    cli.printMessage();
+    return 0;
+  }
+  auto config_path = cli.get<std::string>(0);
+  auto img_path = cli.get<std::string>("img");
+  auto cams = cli.get<int>("cams");
+  auto seconds = cli.get<double>("seconds");
+
+  cv::Mat img;
+  if (!img_path.empty()) {
+    img = cv::imread(img_path);
+  } else {
+    img = cv::Mat(720, 1280, CV_8UC3);
+    cv::randu(img, cv::Scalar::all(0), cv::Scalar::all(255));
+  }
+  if (img.empty()) {
+    tools::logger()->error("Failed to read {}", img_path);
+    return 1;
+  }
+
+  // 每路相机一个YOLO与一个线程, 与Perceptron相同
+  std::vector<std::unique_ptr<auto_aim::YOLO>> yolos;
+  for (int i = 0; i < cams; i++) {
+    yolos.push_back(std::make_unique<auto_aim::YOLO>(config_path, false));
+  }
+  for (auto & yolo : yolos) yolo->detect(img);  // 预热
+
+  auto threaded = measure(seconds, [&](std::chrono::steady_clock::time_point end) {
+    std::atomic<int> frames = 0;
+    std::vector<std::thread> threads;
+    for (auto & yolo : yolos) {
+      threads.emplace_back([&, yolo = yolo.get()] {
+        while (std::chrono::steady_clock::now() < end) {
+          yolo->detect(img);
+          frames++;
+        }
+      });
+    }
+    for (auto & t : threads) t.join();
+    return frames.load();
+  });
+
+  // 一个BatchDetector, 一个线程, 与BatchPerceptron相同
+  // 相邻两路输入不同的图像, 检查各路输出没有错位
+  cv::Mat flipped;
+  cv::flip(img, flipped, 1);
+  std::vector<cv::Mat> imgs;
+  for (int i = 0; i < cams; i++) imgs.push_back(i % 2 == 0 ? img : flipped);
+
+  omniperception::BatchDetector batch_detector(config_path, cams);
+  auto batch_results = batch_detector.detect(imgs);  // 兼作预热
+
+  std::list<auto_aim::Armor> expected[2] = {yolos[0]->detect(img), yolos[0]->detect(flipped)};
+  auto ok = true;
+  for (int i = 0; i < cams; i++) {
+    const auto & e = expected[i % 2];
+    auto same = same_armors(e, batch_results[i]);
+    tools::logger()->info(
+      "camera {}: {} armors per image, {} batched, {}", i, e.size(), batch_results[i].size(),
+      same ? "match" : "MISMATCH");
+    ok = ok && same;
+  }
+
+  // 第0路掉帧: 其余图像前移到batch的前几个位置, 结果仍应回到各自的下标
+  if (cams > 1) {
+    auto dropped = imgs;
+    dropped[0] = cv::Mat();
+    auto dropped_results = batch_detector.detect(dropped);
+    auto same = dropped_results[0].empty();
+    for (int i = 1; i < cams; i++) same = same && same_armors(expected[i % 2], dropped_results[i]);
+    tools::logger()->info("camera 0 dropped: {}", same ? "match" : "MISMATCH");
+    ok = ok && same;
+  }
+
+  auto batched = measure(seconds, [&](std::chrono::steady_clock::time_point end) {
+    int frames = 0;
+    while (std::chrono::steady_clock::now() < end) {
+      batch_detector.detect(imgs);
+      frames += cams;
+    }
+    return frames;
+  });
+
+  report(fmt::format("{} threads x batch 1", cams), threaded, cams);
+  report(fmt::format("1 thread x batch {}", cams), batched, cams);
+
+  tools::logger()->info(ok ? "PASS" : "FAIL");
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,122 @@
+// 在虚拟CAN上验证接收路径:
+//   sudo modprobe vcan && sudo ip link add dev vcan0 type vcan && sudo ip link set up vcan0
+//   ./socketcan_test vcan0
+// 同一进程内用另一个socket以1kHz发送四元数帧, 比较内核时间戳与回调时刻两种时间戳的间隔抖动
+
+#include "io/socketcan.hpp"
+
+#include <cmath>
+#include <mutex>
+#include <opencv2/opencv.hpp>
+
+#include "tools/exiter.hpp"
+#include "tools/logger.hpp"
+#include "tools/math_tools.hpp"
+
+using namespace std::chrono_literals;
+
+const std::string keys =
+  "{help h usage ? |       | 输出命令行参数说明}"
+  "{@interface     | vcan0 | CAN接口名 }"
+  "{canid          | 256   | 四元数帧的CAN ID }"
+  "{rate           | 1000  | 发送频率, Hz }";
+
+// 间隔统计: 均值与标准差
+struct IntervalStats
+{
+  std::chrono::steady_clock::time_point last;
+  double sum = 0, sum2 = 0, max = 0;
+  int count = 0;
+
+  void add(std::chrono::steady_clock::time_point t)
+  {
+    if (last.time_since_epoch().count() != 0) {
+      auto dt = tools::delta_time(t, last) * 1e3;
+      sum += dt;
+      sum2 += dt * dt;
+      max = std::max(max, dt);
+      count++;
+    }
+    last = t;
+  }
+
+  double mean() const { return sum / count; }
+  double stddev() const { return std::sqrt(std::max(0.0, sum2 / count - mean() * mean())); }
+};
+
+int main(int argc, char * argv[])
+{
+  cv::CommandLineParser cli(argc, argv, keys);
+  if (cli.has("help")) {
+    cli.printMessage();
+    return 0;
+  }
+  auto interface = cli.get<std::string>(0);
+  auto canid = cli.get<int>("canid");
+  auto rate = cli.get<double>("rate");
+
+  tools::Exiter exiter;
+
+  std::mutex mutex;
+  IntervalStats kernel_stats, callback_stats;
+  double latency_sum = 0;
+
+  io::SocketCAN receiver(interface, [&](const can_frame & frame, auto timestamp) {
+    if (frame.can_id != canid) return;
+    auto now = std::chrono::steady_clock::now();
+    std::lock_guard<std::mutex> lock(mutex);
+    kernel_stats.add(timestamp);
+    callback_stats.add(now);
+    latency_sum += tools::delta_time(now, timestamp) * 1e3;
+  });
+
+  // 原始CAN套接字收不到自己发出的帧, 发送端单独开一个
+  io::SocketCAN sender(interface, [](const can_frame &, auto) {});
+
+  // 四元数发生器: 绕z轴以1rad/s旋转, 格式与CBoard::callback一致
+  auto period = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+    std::chrono::duration<double>(1 / rate));
+  auto next = std::chrono::steady_clock::now();
+  auto start = next;
+  auto last_report = next;
+  while (!exiter.exit()) {
+    next += period;
+    std::this_thread::sleep_until(next);
+
+    auto angle = tools::delta_time(next, start);
+    auto z = (int16_t)(std::sin(angle / 2) * 1e4);
+    auto w = (int16_t)(std::cos(angle / 2) * 1e4);
+    int16_t q[4] = {0, 0, z, w};  // xyzw
+
+    can_frame frame;
+    frame.can_id = canid;
+    frame.can_dlc = 8;
+    for (int i = 0; i < 4; i++) {
+      frame.data[2 * i] = q[i] >> 8;
+      frame.data[2 * i + 1] = q[i];
+    }
+
+    try {
+      sender.write(&frame);
+    } catch (const std::exception & e) {
+      tools::logger()->warn("{}", e.what());
+    }
+
+    if (tools::delta_time(next, last_report) < 1.0) continue;
+    last_report = next;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    if (kernel_stats.count == 0) continue;
+    tools::logger()->info(
+      "{} frames | kernel dt {:.3f}±{:.3f}ms max {:.3f}ms | callback dt {:.3f}±{:.3f}ms max "
+      "{:.3f}ms | kernel->callback {:.3f}ms",
+      kernel_stats.count, kernel_stats.mean(), kernel_stats.stddev(), kernel_stats.max,
+      callback_stats.mean(), callback_stats.stddev(), callback_stats.max,
+      latency_sum / kernel_stats.count);
+    kernel_stats = {kernel_stats.last};
+    callback_stats = {callback_stats.last};
+    latency_sum = 0;
+  }
+
+  return 0;
+}
@@ -0,0 +1,103 @@
+// Solver的微基准: 逐个solve(cv::solvePnP) vs solve_all(查表去畸变 + Eigen IPPE)
+//   ./solver_batch_test configs/standard3.yaml --num=6 --frames=1000
+// 每帧随机生成num个装甲板, 由reproject_armor得到角点, 检查两种方法的结果在容差内一致
+// PnP与optimize_yaw分开计时, 两种方法的yaw优化完全相同, 只比较PnP本身的耗时
+
+#include <chrono>
+#include <list>
+#include <opencv2/opencv.hpp>
+
+#include "tasks/auto_aim/solver.hpp"
+#include "tools/logger.hpp"
+#include "tools/math_tools.hpp"
+
+const std::string keys =
+  "{help h usage ? |                        | 输出命令行参数说明}"
+  "{@config-path   | configs/standard3.yaml | 位置参数，yaml配置文件路径 }"
+  "{num n          | 6                      | 每帧的装甲板数 }"
+  "{frames f       | 1000                   | 测试帧数 }"
+  "{xyz-tolerance  | 1e-3                   | 允许的位置差, m }"
+  "{ypr-tolerance  | 0.1                    | 允许的姿态差, 度 }";
+
+int main(int argc, char * argv[])
+{
+  cv::CommandLineParser cli(argc, argv, keys);
+  if (cli.has("help")) {
+    cli.printMessage();
+    return 0;
+  }
+  auto config_path = cli.get<std::string>(0);
+  auto num = cli.get<int>("num");
+  auto frames = cli.get<int>("frames");
+  auto xyz_tolerance = cli.get<double>("xyz-tolerance");
+  auto ypr_tolerance = cli.get<double>("ypr-tolerance") / 57.3;
+
+  auto_aim::Solver solver(config_path);
+  cv::RNG rng(0);
+
+  double max_xyz_error = 0, max_ypr_error = 0;
+  double single_time = 0, batch_time = 0, yaw_time = 0;  // s
+
+  for (int f = 0; f < frames; f++) {
+    // 云台大致朝前, 装甲板在前方1~6m内, yaw相对视线±60°
+    auto gimbal_yaw = rng.uniform(-0.2, 0.2);
+    auto gimbal_pitch = rng.uniform(-0.2, 0.2);
+    Eigen::Quaterniond q(
+      Eigen::AngleAxisd(gimbal_yaw, Eigen::Vector3d::UnitZ()) *
+      Eigen::AngleAxisd(gimbal_pitch, Eigen::Vector3d::UnitY()));
+    solver.set_R_gimbal2world(q);
+
+    std::list<auto_aim::Armor> armors;
+    for (int i = 0; i < num; i++) {
+      auto distance = rng.uniform(1.0, 6.0);
+      auto azimuth = gimbal_yaw + rng.uniform(-0.2, 0.2);
+      Eigen::Vector3d xyz(
+        distance * std::cos(azimuth), distance * std::sin(azimuth), rng.uniform(-0.3, 0.3));
+      auto yaw = azimuth + rng.uniform(-1.0, 1.0);
+      auto type = (i % 3 == 0) ? auto_aim::ArmorType::big : auto_aim::ArmorType::small;
+
+      auto points = solver.reproject_armor(xyz, yaw, type, auto_aim::ArmorName::two);
+      for (auto & point : points) point += cv::Point2f(rng.gaussian(0.5), rng.gaussian(0.5));
+
+      auto_aim::Armor armor(0, 1, cv::boundingRect(points), points);
+      armor.type = type;
+      armor.name = auto_aim::ArmorName::two;
+      armors.push_back(armor);
+    }
+
+    auto batched = armors;
+
+    auto t0 = std::chrono::steady_clock::now();
+    for (auto & armor : armors) solver.solve(armor, false);
+    auto t1 = std::chrono::steady_clock::now();
+    solver.solve_all(batched, nullptr, false);
+    auto t2 = std::chrono::steady_clock::now();
+    for (auto & armor : batched) armor.ypr_in_world[0] = solver.optimize_yaw(armor);
+    auto t3 = std::chrono::steady_clock::now();
+    for (auto & armor : armors) armor.ypr_in_world[0] = solver.optimize_yaw(armor);
+    single_time += tools::delta_time(t1, t0);
+    batch_time += tools::delta_time(t2, t1);
+    yaw_time += tools::delta_time(t3, t2);
+
+    for (auto a = armors.begin(), b = batched.begin(); a != armors.end(); a++, b++) {
+      max_xyz_error = std::max(max_xyz_error, (a->xyz_in_world - b->xyz_in_world).norm());
+      for (int i = 0; i < 3; i++) {
+        auto error = std::abs(tools::limit_rad(a->ypr_in_world[i] - b->ypr_in_world[i]));
+        max_ypr_error = std::max(max_ypr_error, error);
+      }
+    }
+  }
+
+  tools::logger()->info(
+    "{} frames x {} armors | max xyz error {:.2e}m | max ypr error {:.2e}deg", frames, num,
+    max_xyz_error, max_ypr_error * 57.3);
+  tools::logger()->info("[solve]        {:.1f}us/frame", single_time / frames * 1e6);
+  tools::logger()->info(
+    "[solve_all]    {:.1f}us/frame, {:.1f}x", batch_time / frames * 1e6,
+    single_time / batch_time);
+  tools::logger()->info("[optimize_yaw] {:.1f}us/frame", yaw_time / frames * 1e6);
+
+  auto ok = max_xyz_error < xyz_tolerance && max_ypr_error < ypr_tolerance;
+  if (!ok) tools::logger()->error("solve_all differs from solve beyond tolerance!");
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,102 @@
+// Solver yaw优化的对比测试: 粗搜索+黄金分割(optimize_yaw) vs 1°步长穷举(optimize_yaw_brute_force)
+//   ./solver_yaw_test assets/demo/demo -c configs/demo.yaml --tolerance=1
+// 在录制的视频上检测装甲板, 逐个比较两种方法得到的yaw与重复计算的耗时
+
+#include <fmt/core.h>
+
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <opencv2/opencv.hpp>
+#include <vector>
+
+#include "tasks/auto_aim/solver.hpp"
+#include "tasks/auto_aim/yolo.hpp"
+#include "tools/logger.hpp"
+#include "tools/math_tools.hpp"
+
+const std::string keys =
+  "{help h usage ? |                   | 输出命令行参数说明 }"
+  "{config-path c  | configs/demo.yaml | yaml配置文件的路径}"
+  "{tolerance t    | 1                 | 允许的yaw差, 度   }"
+  "{repeat r       | 100               | 计时的重复次数    }"
+  "{@input-path    | assets/demo/demo  | avi和txt文件的路径}";
+
+int main(int argc, char * argv[])
+{
+  cv::CommandLineParser cli(argc, argv, keys);
+  if (cli.has("help")) {
+    cli.printMessage();
+    return 0;
+  }
+  auto input_path = cli.get<std::string>(0);
+  auto config_path = cli.get<std::string>("config-path");
+  auto tolerance = cli.get<double>("tolerance") / 57.3;
+  auto repeat = cli.get<int>("repeat");
+
+  cv::VideoCapture video(fmt::format("{}.avi", input_path));
+  std::ifstream text(fmt::format("{}.txt", input_path));
+
+  auto_aim::YOLO yolo(config_path, false);
+  auto_aim::Solver solver(config_path);
+
+  int armor_num = 0, mismatch_num = 0;
+  double max_error = 0, sum_error = 0;
+  double fast_time = 0, brute_force_time = 0;  // s
+
+  cv::Mat img;
+  for (int frame_count = 0;; frame_count++) {
+    video.read(img);
+    if (img.empty()) break;
+
+    double t, w, x, y, z;
+    text >> t >> w >> x >> y >> z;
+    solver.set_R_gimbal2world({w, x, y, z});
+
+    for (auto & armor : yolo.detect(img, frame_count)) {
+      solver.solve(armor);
+
+      auto t0 = std::chrono::steady_clock::now();
+      double fast_yaw = 0, brute_force_yaw = 0;
+      for (int i = 0; i < repeat; i++) fast_yaw = solver.optimize_yaw(armor);
+      auto t1 = std::chrono::steady_clock::now();
+      for (int i = 0; i < repeat; i++) brute_force_yaw = solver.optimize_yaw_brute_force(armor);
+      auto t2 = std::chrono::steady_clock::now();
+      fast_time += tools::delta_time(t1, t0) / repeat;
+      brute_force_time += tools::delta_time(t2, t1) / repeat;
+
+      auto error = std::abs(tools::limit_rad(fast_yaw - brute_force_yaw));
+      armor_num++;
+      sum_error += error;
+      max_error = std::max(max_error, error);
+      if (error > tolerance) {
+        mismatch_num++;
+        tools::logger()->warn(
+          "[{}] {} yaw differs: {:.2f} vs {:.2f} deg", frame_count,
+          auto_aim::ARMOR_NAMES[armor.name], fast_yaw * 57.3, brute_force_yaw * 57.3);
+      }
+    }
+  }
+
+  if (armor_num == 0) {
+    tools::logger()->error("No armor detected in {}", input_path);
+    return 1;
+  }
+
+  tools::logger()->info(
+    "{} armors | yaw error mean {:.3f} max {:.3f} deg | {} over tolerance", armor_num,
+    sum_error / armor_num * 57.3, max_error * 57.3, mismatch_num);
+  tools::logger()->info(
+    "optimize_yaw {:.1f}us | brute force {:.1f}us | {:.1f}x", fast_time / armor_num * 1e6,
+    brute_force_time / armor_num * 1e6, brute_force_time / fast_time);
+
+  // 重投影误差全为NaN时没有极小值, 应保留IPPE的yaw
+  std::vector<cv::Point2f> points{{0, 0}, {1, 0}, {1, 1}, {0, 1}};
+  auto_aim::Armor nan_armor(0, 1, cv::Rect(0, 0, 1, 1), points);
+  nan_armor.xyz_in_world.setConstant(std::nan(""));
+  nan_armor.yaw_raw = 0.5;
+  auto nan_ok = solver.optimize_yaw(nan_armor) == nan_armor.yaw_raw;
+  if (!nan_ok) tools::logger()->warn("optimize_yaw does not fall back to yaw_raw on NaN errors");
+
+  return mismatch_num == 0 && nan_ok ? 0 : 1;
+}
@@ -0,0 +1,133 @@
+// Target预测的微基准: 逐步predict(DT) vs 闭式的armor_xyza_at
+//   ./target_predict_test --steps=300 --repeat=1000
+// 先用仿真的旋转目标观测更新Target, 再在Planner的规划时域上比较两种方法得到的装甲板xyza与耗时
+
+#include <chrono>
+#include <opencv2/opencv.hpp>
+#include <vector>
+
+#include "tasks/auto_aim/target.hpp"
+#include "tools/logger.hpp"
+#include "tools/math_tools.hpp"
+
+const std::string keys =
+  "{help h usage ? |      | 输出命令行参数说明}"
+  "{steps s        | 300  | 跟踪的仿真步数 }"
+  "{repeat r       | 1000 | 计时的重复次数 }";
+
+namespace
+{
+constexpr int ARMOR_NUM = 4;
+constexpr double DT = 0.01;
+constexpr int HALF_HORIZON = 50;
+constexpr int N = HALF_HORIZON * 2 + 2;  // 与Planner::get_trajectory相同的时域
+
+using Horizon = Eigen::Array<double, N, 1>;
+using XYZAs = Eigen::Matrix<double, 4, N>;
+
+// 真实状态下朝向相机的装甲板
+auto_aim::Armor observe(const auto_aim::Target::State & truth, cv::RNG & rng)
+{
+  int id = 0;
+  auto min_error = 1e10;
+  for (int i = 0; i < ARMOR_NUM; i++) {
+    auto angle = truth[6] + i * 2 * CV_PI / ARMOR_NUM;
+    auto error = std::abs(tools::limit_rad(angle - std::atan2(truth[2], truth[0])));
+    if (error < min_error) min_error = error, id = i;
+  }
+
+  auto angle = tools::limit_rad(truth[6] + id * 2 * CV_PI / ARMOR_NUM);
+  auto use_l_h = (id == 1 || id == 3);
+  auto r = use_l_h ? truth[8] + truth[9] : truth[8];
+  Eigen::Vector3d xyz{
+    truth[0] - r * std::cos(angle) + rng.gaussian(0.005),
+    truth[2] - r * std::sin(angle) + rng.gaussian(0.005),
+    (use_l_h ? truth[4] + truth[10] : truth[4]) + rng.gaussian(0.005)};
+
+  std::vector<cv::Point2f> points{{0, 0}, {1, 0}, {1, 1}, {0, 1}};
+  auto_aim::Armor armor(0, 1, cv::Rect(0, 0, 1, 1), points);
+  armor.name = auto_aim::ArmorName::three;
+  armor.type = auto_aim::ArmorType::small;
+  armor.xyz_in_world = xyz;
+  armor.ypr_in_world = {angle + rng.gaussian(0.02), 0, 0};
+  armor.ypd_in_world = tools::xyz2ypd(xyz);
+  return armor;
+}
+
+}  // namespace
+
+int main(int argc, char * argv[])
+{
+  cv::CommandLineParser cli(argc, argv, keys);
+  if (cli.has("help")) {
+    cli.printMessage();
+    return 0;
+  }
+  auto steps = cli.get<int>("steps");
+  auto repeat = cli.get<int>("repeat");
+
+  // 真实状态: 3m外匀速平移, 6rad/s小陀螺
+  auto_aim::Target::State truth{{3, 0.5, 0.5, -0.2, 0.1, 0, 0, 6, 0.25, 0.03, 0.05}};
+  cv::RNG rng(0);
+
+  auto t = std::chrono::steady_clock::now();
+  Eigen::VectorXd P0_dig{{1, 64, 1, 64, 1, 64, 0.4, 100, 1, 1, 1}};
+  auto_aim::Target target(observe(truth, rng), t, 0.2, ARMOR_NUM, P0_dig);
+
+  for (int step = 0; step < steps; step++) {
+    truth[0] += truth[1] * DT;
+    truth[2] += truth[3] * DT;
+    truth[6] = tools::limit_rad(truth[6] + truth[7] * DT);
+    t += std::chrono::microseconds(int(DT * 1e6));
+    target.predict(t);
+    target.update(observe(truth, rng));
+  }
+
+  // [0] = -(HALF_HORIZON + 1) * DT -> [N - 1] = HALF_HORIZON * DT, 再整体偏移飞行时间
+  auto fly_time = 0.3;
+  Horizon dts = Horizon::LinSpaced(N, -DT * (HALF_HORIZON + 1), DT * HALF_HORIZON) + fly_time;
+
+  std::vector<XYZAs> stepped(ARMOR_NUM), closed(ARMOR_NUM);
+  double stepped_time = 0, closed_time = 0;  // s
+
+  for (int i = 0; i < repeat; i++) {
+    // 原做法: 复制目标并逐步predict, 每步都构造F、Q并传播协方差
+    auto t0 = std::chrono::steady_clock::now();
+    auto copy = target;
+    copy.predict(dts[0]);
+    for (int k = 0; k < N; k++) {
+      if (k > 0) copy.predict(DT);
+      auto xyza_list = copy.armor_xyza_list();
+      for (int id = 0; id < ARMOR_NUM; id++) stepped[id].col(k) = xyza_list[id];
+    }
+    auto t1 = std::chrono::steady_clock::now();
+    for (int id = 0; id < ARMOR_NUM; id++) closed[id] = target.armor_xyza_at(dts, id);
+    auto t2 = std::chrono::steady_clock::now();
+    stepped_time += tools::delta_time(t1, t0);
+    closed_time += tools::delta_time(t2, t1);
+  }
+
+  double max_error = 0;
+  for (int id = 0; id < ARMOR_NUM; id++) {
+    for (int k = 0; k < N; k++) {
+      Eigen::Vector4d error = stepped[id].col(k) - closed[id].col(k);
+      error[3] = tools::limit_rad(error[3]);
+      max_error = std::max(max_error, error.cwiseAbs().maxCoeff());
+    }
+  }
+
+  // 单步的闭式预测应与predict()得到的状态一致
+  auto predicted = target;
+  predicted.predict(fly_time);
+  auto_aim::Target::State state_error = predicted.ekf().x - target.predicted_state(fly_time);
+  state_error[6] = tools::limit_rad(state_error[6]);
+  max_error = std::max(max_error, state_error.cwiseAbs().maxCoeff());
+
+  tools::logger()->info("{} steps x {} armors | max error {:.2e}", N, ARMOR_NUM, max_error);
+  tools::logger()->info("[predict]       {:.1f}us/horizon", stepped_time / repeat * 1e6);
+  tools::logger()->info(
+    "[armor_xyza_at] {:.1f}us/horizon, {:.1f}x", closed_time / repeat * 1e6,
+    stepped_time / closed_time);
+
+  return max_error < 1e-9 ? 0 : 1;
+}
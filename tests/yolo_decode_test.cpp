@@ -0,0 +1,179 @@
+// YOLO输出解码的微基准: 比较原先的parse(转置 + 逐行cv::Mat视图 + minMaxLoc)与YOLODecoder
+//   ./yolo_decode_test --head=yolo11 --output=yolo11_output.bin
+// output为推理输出张量的float32原始数据(output_tensor.data()直接写入文件), 为空时随机生成
+// 同时检查两者筛选出的候选完全一致
+
+#include <fmt/core.h>
+
+#include <chrono>
+#include <fstream>
+#include <opencv2/opencv.hpp>
+#include <random>
+
+#include "tasks/auto_aim/yolos/yolo_decoder.hpp"
+#include "tools/logger.hpp"
+
+const std::string keys =
+  "{help h usage ? |        | 输出命令行参数说明}"
+  "{head           | yolo11 | yolo11, yolov8或yolov5 }"
+  "{output o       |        | 保存的输出张量 }"
+  "{n              | 1000   | 重复次数 }";
+
+constexpr float SCORE_THRESHOLD = 0.7;
+
+struct Head
+{
+  int rows, cols;  // 输出张量的形状
+  int class_num;
+};
+
+// 原先的解码方式, 只保留到NMS之前
+struct Reference
+{
+  std::vector<int> ids;
+  std::vector<float> confidences;
+  std::vector<cv::Rect> boxes;
+  std::vector<std::vector<cv::Point2f>> key_points;
+
+  void channel_major(cv::Mat output, int class_num, double scale)
+  {
+    ids.clear(), confidences.clear(), boxes.clear(), key_points.clear();
+    cv::transpose(output, output);
+    for (int r = 0; r < output.rows; r++) {
+      auto xywh = output.row(r).colRange(0, 4);
+      auto scores = output.row(r).colRange(4, 4 + class_num);
+      auto one_key_points = output.row(r).colRange(4 + class_num, 4 + class_num + 8);
+
+      double score;
+      cv::Point max_point;
+      cv::minMaxLoc(scores, nullptr, &score, nullptr, &max_point);
+      if (score < SCORE_THRESHOLD) continue;
+
+      auto x = xywh.at<float>(0);
+      auto y = xywh.at<float>(1);
+      auto w = xywh.at<float>(2);
+      auto h = xywh.at<float>(3);
+      std::vector<cv::Point2f> armor_key_points;
+      for (int i = 0; i < 4; i++) {
+        float x = one_key_points.at<float>(0, i * 2 + 0) / scale;
+        float y = one_key_points.at<float>(0, i * 2 + 1) / scale;
+        armor_key_points.push_back({x, y});
+      }
+      ids.emplace_back(max_point.x);
+      confidences.emplace_back(score);
+      boxes.emplace_back(
+        static_cast<int>((x - 0.5 * w) / scale), static_cast<int>((y - 0.5 * h) / scale),
+        static_cast<int>(w / scale), static_cast<int>(h / scale));
+      key_points.emplace_back(armor_key_points);
+    }
+  }
+
+  void anchor_major(const cv::Mat & output)
+  {
+    ids.clear(), confidences.clear();
+    for (int r = 0; r < output.rows; r++) {
+      double score = output.at<float>(r, 8);
+      score = 1 / (1 + std::exp(-score));
+      if (score < SCORE_THRESHOLD) continue;
+
+      cv::Point class_id;
+      cv::minMaxLoc(output.row(r).colRange(13, 22), nullptr, nullptr, nullptr, &class_id);
+      ids.emplace_back(r * 100 + class_id.x);
+      confidences.emplace_back(score);
+    }
+  }
+};
+
+int main(int argc, char * argv[])
+{
+  cv::CommandLineParser cli(argc, argv, keys);
+  if (cli.has("help")) {
+    cli.printMessage();
+    return 0;
+  }
+  auto head_name = cli.get<std::string>("head");
+  auto output_path = cli.get<std::string>("output");
+  auto n = cli.get<int>("n");
+
+  Head head;
+  if (head_name == "yolo11")
+    head = {4 + 38 + 8, 8400, 38};
+  else if (head_name == "yolov8")
+    head = {4 + 2 + 8, 3549, 2};
+  else if (head_name == "yolov5")
+    head = {25200, 22, 13};
+  else {
+    tools::logger()->error("Unknown head: {}", head_name);
+    return 1;
+  }
+  auto anchor_major = head_name == "yolov5";
+
+  cv::Mat output(head.rows, head.cols, CV_32F);
+  if (!output_path.empty()) {
+    std::ifstream file(output_path, std::ios::binary);
+    file.read(reinterpret_cast<char *>(output.data), output.total() * sizeof(float));
+    if (!file) {
+      tools::logger()->error("Failed to read {} floats from {}", output.total(), output_path);
+      return 1;
+    }
+  } else {
+    // 得分大多很低, 约千分之三超过阈值, 与实际输出相近
+    // 通道优先的头输出已经过sigmoid, yolov5输出的是logit
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<float> coord(0, 640);
+    std::uniform_real_distribution<float> low(anchor_major ? -8 : 0, 0.5);
+    std::uniform_real_distribution<float> high(anchor_major ? 1 : 0.7, anchor_major ? 5 : 1);
+    std::bernoulli_distribution hit(0.003);
+    for (int r = 0; r < output.rows; r++)
+      for (int c = 0; c < output.cols; c++) {
+        auto score = anchor_major ? (c >= 8) : (r >= 4 && r < 4 + head.class_num);
+        output.at<float>(r, c) = score ? (hit(rng) ? high(rng) : low(rng)) : coord(rng);
+      }
+  }
+
+  Reference reference;
+  auto_aim::YOLODecoder decoder;
+  double scale = 640.0 / 1440;
+
+  auto benchmark = [n](auto && f) {
+    auto t0 = std::chrono::steady_clock::now();
+    for (int i = 0; i < n; i++) f();
+    auto t1 = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::micro>(t1 - t0).count() / n;
+  };
+
+  double reference_us, decoder_us;
+  bool same;
+  if (anchor_major) {
+    reference_us = benchmark([&] { reference.anchor_major(output); });
+    std::vector<int> ids;
+    decoder_us = benchmark([&] {
+      auto & candidates = decoder.select_anchor_major(
+        output.ptr<float>(), output.rows, output.cols, 8, SCORE_THRESHOLD);
+      ids.clear();
+      for (const auto & c : candidates) {
+        auto row = output.ptr<float>(c.anchor);
+        ids.push_back(c.anchor * 100 + (std::max_element(row + 13, row + 22) - (row + 13)));
+      }
+    });
+
+    auto & candidates = decoder.candidates();
+    same = ids == reference.ids;
+    for (size_t i = 0; same && i < candidates.size(); i++)
+      same = std::abs(candidates[i].score - reference.confidences[i]) < 1e-5;
+  } else {
+    reference_us = benchmark([&] { reference.channel_major(output, head.class_num, scale); });
+    decoder_us = benchmark(
+      [&] { decoder.decode_channel_major(output, head.class_num, 4, SCORE_THRESHOLD, scale); });
+
+    same = decoder.boxes == reference.boxes && decoder.class_ids == reference.ids &&
+           decoder.scores == reference.confidences && decoder.key_points == reference.key_points;
+  }
+
+  tools::logger()->info(
+    "[{}] {}x{} output, {} candidates | reference {:.1f}us | decoder {:.1f}us | {:.1f}x | {}",
+    head_name, head.rows, head.cols, reference.confidences.size(), reference_us, decoder_us,
+    reference_us / decoder_us, same ? "identical" : "MISMATCH");
+
+  return same ? 0 : 1;
+}
@@ -0,0 +1,154 @@
+#include "camera_model.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <opencv2/core/eigen.hpp>
+
+#include "tools/logger.hpp"
+#include "tools/yaml.hpp"
+
+namespace tools
+{
+constexpr int UNDISTORT_ITERATIONS = 20;  // 现有配置中畸变最大的也能收敛到1e-7像素以下
+
+CameraModel::CameraModel(const std::string & config_path) : CameraModel(load(config_path)) {}
+
+CameraModel::CameraModel(const YAML::Node & yaml)
+: CameraModel(
+    read<std::vector<double>>(yaml, "camera_matrix"),
+    read<std::vector<double>>(yaml, "distort_coeffs"),
+    yaml["undistort_grid_step"] ? yaml["undistort_grid_step"].as<int>() : 8)
+{
+}
+
+CameraModel::CameraModel(
+  const std::vector<double> & camera_matrix, const std::vector<double> & distort_coeffs,
+  int grid_step)
+: step_(grid_step)
+{
+  fx_ = camera_matrix[0], cx_ = camera_matrix[2];
+  fy_ = camera_matrix[4], cy_ = camera_matrix[5];
+  k1_ = distort_coeffs[0], k2_ = distort_coeffs[1];
+  p1_ = distort_coeffs[2], p2_ = distort_coeffs[3];
+  k3_ = distort_coeffs[4];
+
+  Eigen::Matrix<double, 3, 3, Eigen::RowMajor> K(camera_matrix.data());
+  Eigen::Matrix<double, 1, 5> D(distort_coeffs.data());
+  cv::eigen2cv(K, camera_matrix_);
+  cv::eigen2cv(D, distort_coeffs_);
+
+  // 节点覆盖[-step, 2cx + step] x [-step, 2cy + step]
+  u0_ = -step_;
+  v0_ = -step_;
+  auto cols = static_cast<int>(std::ceil(2 * cx_ / step_)) + 3;
+  auto rows = static_cast<int>(std::ceil(2 * cy_ / step_)) + 3;
+  grid_x_.create(rows, cols, CV_64F);
+  grid_y_.create(rows, cols, CV_64F);
+  for (int r = 0; r < rows; r++) {
+    for (int c = 0; c < cols; c++) {
+      auto xy = undistort_iterative(u0_ + c * step_, v0_ + r * step_);
+      grid_x_.at<double>(r, c) = xy.x();
+      grid_y_.at<double>(r, c) = xy.y();
+    }
+  }
+
+  // 与OpenCV比较: 去畸变在网格中心(插值误差最大处)取样, 投影用去畸变的结果
+  std::vector<cv::Point2d> pixels, normalized;
+  for (int r = 0; r + 1 < rows; r += 4) {
+    for (int c = 0; c + 1 < cols; c += 4) {
+      pixels.emplace_back(u0_ + (c + 0.5) * step_, v0_ + (r + 0.5) * step_);
+    }
+  }
+  cv::undistortPoints(
+    pixels, normalized, camera_matrix_, distort_coeffs_, cv::noArray(), cv::noArray(),
+    cv::TermCriteria(cv::TermCriteria::COUNT | cv::TermCriteria::EPS, 100, 1e-12));
+
+  std::vector<cv::Point3d> object_points;
+  for (const auto & p : normalized) object_points.emplace_back(p.x, p.y, 1);
+  std::vector<cv::Point2d> reprojected;
+  cv::projectPoints(
+    object_points, cv::Vec3d(0, 0, 0), cv::Vec3d(0, 0, 0), camera_matrix_, distort_coeffs_,
+    reprojected);
+
+  auto undistort_error = 0.0, project_error = 0.0;  // 像素
+  for (std::size_t i = 0; i < pixels.size(); i++) {
+    auto xy = undistort(pixels[i].x, pixels[i].y);
+    auto du = (xy.x() - normalized[i].x) * fx_;
+    auto dv = (xy.y() - normalized[i].y) * fy_;
+    undistort_error = std::max(undistort_error, std::hypot(du, dv));
+    auto uv = distort(normalized[i].x, normalized[i].y);
+    project_error =
+      std::max(project_error, std::hypot(uv.x() - reprojected[i].x, uv.y() - reprojected[i].y));
+  }
+
+  logger()->info(
+    "[CameraModel] Undistort grid {}x{}, step {}px. Max error vs OpenCV: undistort {:.1e}px, "
+    "project {:.1e}px",
+    cols, rows, step_, undistort_error, project_error);
+}
+
+Eigen::Vector2d CameraModel::undistort(double u, double v) const
+{
+  auto gu = (u - u0_) / step_;
+  auto gv = (v - v0_) / step_;
+  auto c = static_cast<int>(std::floor(gu));
+  auto r = static_cast<int>(std::floor(gv));
+  if (c < 0 || r < 0 || c + 1 >= grid_x_.cols || r + 1 >= grid_x_.rows) {
+    return undistort_iterative(u, v);
+  }
+
+  auto a = gu - c, b = gv - r;
+  auto bilinear = [&](const cv::Mat & grid) {
+    const auto * row0 = grid.ptr<double>(r) + c;
+    const auto * row1 = grid.ptr<double>(r + 1) + c;
+    return (1 - b) * ((1 - a) * row0[0] + a * row0[1]) + b * ((1 - a) * row1[0] + a * row1[1]);
+  };
+  return {bilinear(grid_x_), bilinear(grid_y_)};
+}
+
+void CameraModel::undistort(
+  const Eigen::Ref<const Eigen::Matrix2Xd> & pixels, Eigen::Ref<Eigen::Matrix2Xd> normalized) const
+{
+  const auto * grid_x = grid_x_.ptr<double>();
+  const auto * grid_y = grid_y_.ptr<double>();
+  auto stride = grid_x_.cols;  // 网格由create()分配, 连续存储
+
+  for (Eigen::Index i = 0; i < pixels.cols(); i++) {
+    auto gu = (pixels(0, i) - u0_) / step_;
+    auto gv = (pixels(1, i) - v0_) / step_;
+    auto c = static_cast<int>(std::floor(gu));
+    auto r = static_cast<int>(std::floor(gv));
+    if (c < 0 || r < 0 || c + 1 >= grid_x_.cols || r + 1 >= grid_x_.rows) {
+      normalized.col(i) = undistort_iterative(pixels(0, i), pixels(1, i));
+      continue;
+    }
+
+    // 四个节点的权重
+    auto a = gu - c, b = gv - r;
+    auto w00 = (1 - a) * (1 - b), w01 = a * (1 - b), w10 = (1 - a) * b, w11 = a * b;
+    auto k = r * stride + c;
+    normalized(0, i) = w00 * grid_x[k] + w01 * grid_x[k + 1] + w10 * grid_x[k + stride] +
+                       w11 * grid_x[k + stride + 1];
+    normalized(1, i) = w00 * grid_y[k] + w01 * grid_y[k + 1] + w10 * grid_y[k + stride] +
+                       w11 * grid_y[k + stride + 1];
+  }
+}
+
+// 与cv::undistortPoints相同的不动点迭代
+Eigen::Vector2d CameraModel::undistort_iterative(double u, double v) const
+{
+  auto x0 = (u - cx_) / fx_;
+  auto y0 = (v - cy_) / fy_;
+  auto x = x0, y = y0;
+  for (int i = 0; i < UNDISTORT_ITERATIONS; i++) {
+    auto r2 = x * x + y * y;
+    auto icdist = 1 / (1 + r2 * (k1_ + r2 * (k2_ + r2 * k3_)));
+    auto dx = 2 * p1_ * x * y + p2_ * (r2 + 2 * x * x);
+    auto dy = p1_ * (r2 + 2 * y * y) + 2 * p2_ * x * y;
+    x = (x0 - dx) * icdist;
+    y = (y0 - dy) * icdist;
+  }
+  return {x, y};
+}
+
+}  // namespace tools
@@ -0,0 +1,73 @@
+#ifndef TOOLS__CAMERA_MODEL_HPP
+#define TOOLS__CAMERA_MODEL_HPP
+
+#include <Eigen/Dense>
+#include <yaml-cpp/yaml.h>
+
+#include <opencv2/opencv.hpp>
+#include <string>
+#include <vector>
+
+namespace tools
+{
+// 针孔相机与5参数(k1, k2, p1, p2, k3)畸变模型
+// 投影(加畸变)是闭式的; 去畸变需要迭代, 构造时在像素网格上预先算好, 使用时双线性插值
+// 构造时与OpenCV比较并输出精度
+class CameraModel
+{
+public:
+  // 读取camera_matrix, distort_coeffs与可选的undistort_grid_step(默认8)
+  explicit CameraModel(const std::string & config_path);
+
+  // camera_matrix为按行排列的3x3内参, distort_coeffs为k1, k2, p1, p2, k3
+  // 网格覆盖以主点为中心、2cx x 2cy的图像(外扩一格), 间隔为grid_step像素
+  CameraModel(
+    const std::vector<double> & camera_matrix, const std::vector<double> & distort_coeffs,
+    int grid_step = 8);
+
+  // 相机坐标系中的点 -> 像素坐标, 与cv::projectPoints相同
+  Eigen::Vector2d project(const Eigen::Vector3d & xyz_in_camera) const
+  {
+    auto z = xyz_in_camera.z() != 0 ? 1.0 / xyz_in_camera.z() : 1.0;
+    return distort(xyz_in_camera.x() * z, xyz_in_camera.y() * z);
+  }
+
+  // 归一化坐标(z = 1) -> 像素坐标
+  Eigen::Vector2d distort(double x, double y) const
+  {
+    auto r2 = x * x + y * y;
+    auto radial = 1 + r2 * (k1_ + r2 * (k2_ + r2 * k3_));
+    auto xd = x * radial + 2 * p1_ * x * y + p2_ * (r2 + 2 * x * x);
+    auto yd = y * radial + p1_ * (r2 + 2 * y * y) + 2 * p2_ * x * y;
+    return {fx_ * xd + cx_, fy_ * yd + cy_};
+  }
+
+  // 像素坐标 -> 去畸变的归一化坐标(z = 1), 网格外的点迭代求解
+  Eigen::Vector2d undistort(double u, double v) const;
+
+  // 同上, 一次处理多个点(每列一个), normalized须与pixels尺寸相同
+  void undistort(
+    const Eigen::Ref<const Eigen::Matrix2Xd> & pixels,
+    Eigen::Ref<Eigen::Matrix2Xd> normalized) const;
+
+  // 供cv::solvePnP等使用
+  const cv::Mat & camera_matrix() const { return camera_matrix_; }
+  const cv::Mat & distort_coeffs() const { return distort_coeffs_; }
+
+private:
+  double fx_, fy_, cx_, cy_;
+  double k1_, k2_, p1_, p2_, k3_;
+  cv::Mat camera_matrix_, distort_coeffs_;
+
+  int step_;                 // 网格间隔, 像素
+  double u0_, v0_;           // 第一个节点的像素坐标
+  cv::Mat grid_x_, grid_y_;  // CV_64F, 各节点去畸变后的归一化坐标
+
+  explicit CameraModel(const YAML::Node & yaml);
+
+  Eigen::Vector2d undistort_iterative(double u, double v) const;
+};
+
+}  // namespace tools
+
+#endif  // TOOLS__CAMERA_MODEL_HPP
@@ -2,56 +2,145 @@
 #define TOOLS__EXTENDED_KALMAN_FILTER_HPP
 
 #include <Eigen/Dense>
-#include <deque>
+#include <array>
 #include <functional>
-#include <map>
 
 namespace tools
 {
+// 固定维度的扩展卡尔曼滤波器, 所有矩阵都在栈上, 模型函数作为模板参数内联
+// NX: 状态维度
+// NZ: 主要观测的维度, 卡方检验只对这一维度的update()进行
+// XAdd: 状态加法x + dx, 有角度的状态需在其中限制角度范围
+template <int NX, int NZ, typename XAdd = std::plus<>>
 class ExtendedKalmanFilter
 {
 public:
-  Eigen::VectorXd x;
-  Eigen::MatrixXd P;
+  using VectorX = Eigen::Matrix<double, NX, 1>;
+  using MatrixX = Eigen::Matrix<double, NX, NX>;
+
+  // 卡方检验数据
+  struct Diagnostics
+  {
+    Eigen::Matrix<double, NZ, 1> residual = Eigen::Matrix<double, NZ, 1>::Zero();  // 更新后的残差
+    double nis = 0;
+    double nees = 0;
+    bool nis_fail = false;   // 曾经超过阈值
+    bool nees_fail = false;  // 曾经超过阈值
+    double nis_fail_rate = 0;  // 最近WINDOW_SIZE次update中nis超过阈值的比例
+  };
+
+  static constexpr int WINDOW_SIZE = 100;
+
+  VectorX x;
+  MatrixX P;
+
+  bool diagnose = false;  // 为true时update()填写diagnostics, 否则diagnostics保持不变
+  Diagnostics diagnostics;
 
   ExtendedKalmanFilter() = default;
 
-  ExtendedKalmanFilter(
-    const Eigen::VectorXd & x0, const Eigen::MatrixXd & P0,
-    std::function<Eigen::VectorXd(const Eigen::VectorXd &, const Eigen::VectorXd &)> x_add =
-      [](const Eigen::VectorXd & a, const Eigen::VectorXd & b) { return a + b; });
+  ExtendedKalmanFilter(const VectorX & x0, const MatrixX & P0, XAdd x_add = {})
+  : x(x0), P(P0), x_add_(x_add)
+  {
+  }
+
+  const VectorX & predict(const MatrixX & F, const MatrixX & Q)
+  {
+    return predict(F, Q, [&](const VectorX & x) -> VectorX { return F * x; });
+  }
+
+  template <typename StateFn>
+  const VectorX & predict(const MatrixX & F, const MatrixX & Q, StateFn f)
+  {
+    P = F * P * F.transpose() + Q;
+    x = f(x);
+    return x;
+  }
+
+  template <int M, typename ZSubtract = std::minus<>>
+  const VectorX & update(
+    const Eigen::Matrix<double, M, 1> & z, const Eigen::Matrix<double, M, NX> & H,
+    const Eigen::Matrix<double, M, M> & R, ZSubtract z_subtract = {})
+  {
+    auto h = [&](const VectorX & x) -> Eigen::Matrix<double, M, 1> { return H * x; };
+    return update(z, H, R, h, z_subtract);
+  }
+
+  // 最近WINDOW_SIZE次主要观测的update中nis超过阈值的次数, 与diagnose无关, 总是记录
+  int nis_fail_count() const { return nis_fail_count_; }
 
-  Eigen::VectorXd predict(const Eigen::MatrixXd & F, const Eigen::MatrixXd & Q);
+  template <int M, typename MeasureFn, typename ZSubtract>
+  const VectorX & update(
+    const Eigen::Matrix<double, M, 1> & z, const Eigen::Matrix<double, M, NX> & H,
+    const Eigen::Matrix<double, M, M> & R, MeasureFn h, ZSubtract z_subtract)
+  {
+    // S = H P H^T + R = L L^T, 用Cholesky分解代替求逆
+    Eigen::Matrix<double, M, NX> HP = H * P;
+    Eigen::Matrix<double, M, M> S = HP * H.transpose() + R;
+    Eigen::LLT<Eigen::Matrix<double, M, M>> llt(S);
 
-  Eigen::VectorXd predict(
-    const Eigen::MatrixXd & F, const Eigen::MatrixXd & Q,
-    std::function<Eigen::VectorXd(const Eigen::VectorXd &)> f);
+    // K = P H^T S^-1
+    Eigen::Matrix<double, NX, M> K = llt.solve(HP).transpose();
 
-  Eigen::VectorXd update(
-    const Eigen::VectorXd & z, const Eigen::MatrixXd & H, const Eigen::MatrixXd & R,
-    std::function<Eigen::VectorXd(const Eigen::VectorXd &, const Eigen::VectorXd &)> z_subtract =
-      [](const Eigen::VectorXd & a, const Eigen::VectorXd & b) { return a - b; });
+    // Joseph形式, 保证P的对称半正定
+    MatrixX IKH = MatrixX::Identity() - K * H;
+    MatrixX P_new = IKH * P * IKH.transpose() + K * R * K.transpose();
+    P = 0.5 * (P_new + P_new.transpose());
 
-  Eigen::VectorXd update(
-    const Eigen::VectorXd & z, const Eigen::MatrixXd & H, const Eigen::MatrixXd & R,
-    std::function<Eigen::VectorXd(const Eigen::VectorXd &)> h,
-    std::function<Eigen::VectorXd(const Eigen::VectorXd &, const Eigen::VectorXd &)> z_subtract =
-      [](const Eigen::VectorXd & a, const Eigen::VectorXd & b) { return a - b; });
+    VectorX x_prior = x;
+    Eigen::Matrix<double, M, 1> innovation = z_subtract(z, h(x));
+    VectorX dx = K * innovation;
+    x = x_add_(x_prior, dx);
 
-  std::map<std::string, double> data;  //卡方检验数据
-  std::deque<int> recent_nis_failures{0};
-  size_t window_size = 100;
-  double last_nis;
+    if constexpr (M == NZ) check(z, H, R, h, z_subtract, x_prior);
+
+    return x;
+  }
 
 private:
-  Eigen::MatrixXd I;
-  std::function<Eigen::VectorXd(const Eigen::VectorXd &, const Eigen::VectorXd &)> x_add;
+  XAdd x_add_;
+
+  std::array<bool, WINDOW_SIZE> nis_fail_ring_{};
+  int nis_ring_size_ = 0;
+  int nis_ring_index_ = 0;
+  int nis_fail_count_ = 0;  // nis_fail_ring_中为true的个数
+
+  // 卡方检验: 总是更新nis的滑动窗口, diagnose时再计算nees并填写diagnostics
+  template <typename MeasureFn, typename ZSubtract>
+  void check(
+    const Eigen::Matrix<double, NZ, 1> & z, const Eigen::Matrix<double, NZ, NX> & H,
+    const Eigen::Matrix<double, NZ, NZ> & R, MeasureFn & h, ZSubtract & z_subtract,
+    const VectorX & x_prior)
+  {
+    // 卡方检验阈值（自由度=4，取置信水平95%）
+    constexpr double nis_threshold = 0.711;
+    constexpr double nees_threshold = 0.711;
+
+    Eigen::Matrix<double, NZ, 1> residual = z_subtract(z, h(x));
+    Eigen::Matrix<double, NZ, NZ> S = H * P * H.transpose() + R;
+    auto nis = residual.dot(S.llt().solve(residual));
+
+    // 覆盖窗口中最旧的一次
+    auto fail = nis > nis_threshold;
+    nis_fail_count_ += int(fail) - int(nis_fail_ring_[nis_ring_index_]);
+    nis_fail_ring_[nis_ring_index_] = fail;
+    nis_ring_index_ = (nis_ring_index_ + 1) % WINDOW_SIZE;
+    if (nis_ring_size_ < WINDOW_SIZE) nis_ring_size_++;
+
+    if (!diagnose) return;
+
+    VectorX dx = x - x_prior;
 
-  int nees_count_ = 0;
-  int nis_count_ = 0;
-  int total_count_ = 0;
+    auto & d = diagnostics;
+    d.residual = residual;
+    d.nis = nis;
+    d.nees = dx.dot(P.ldlt().solve(dx));  // P可能半正定
+    if (fail) d.nis_fail = true;
+    if (d.nees > nees_threshold) d.nees_fail = true;
+    d.nis_fail_rate = static_cast<double>(nis_fail_count_) / nis_ring_size_;
+  }
 };
 
 }  // namespace tools
 
-#endif  // TOOLS__EXTENDED_KALMAN_FILTER_HPP
\ No newline at end of file
+#endif  // TOOLS__EXTENDED_KALMAN_FILTER_HPP
@@ -0,0 +1,60 @@
+#ifndef TOOLS__FRAME_POOL_HPP
+#define TOOLS__FRAME_POOL_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <opencv2/opencv.hpp>
+#include <vector>
+
+namespace tools
+{
+// 预分配的图像缓冲池
+// 借用cv::Mat自身的引用计数: 池中每个槽位持有一份引用,
+// 当所有消费者(队列、检测、录像...)都释放了拷贝后, 引用计数回到1, 该槽位即可复用.
+// acquire()只允许在单个生产者线程中调用, 消费者线程只需正常拷贝/释放cv::Mat.
+class FramePool
+{
+public:
+  explicit FramePool(size_t capacity) : slots_(capacity), next_(0) {}
+
+  // 取出一个rows x cols x type的空闲缓冲, 成功返回true
+  // 池耗尽时退化为普通分配(保证不丢帧), 返回false并计数
+  bool acquire(int rows, int cols, int type, cv::Mat & out)
+  {
+    for (size_t i = 0; i < slots_.size(); i++) {
+      auto & slot = slots_[(next_ + i) % slots_.size()];
+
+      if (slot.empty() || slot.rows != rows || slot.cols != cols || slot.type() != type) {
+        if (!slot.empty() && refcount(slot) > 1) continue;
+        slot.create(rows, cols, type);
+      }
+
+      if (refcount(slot) > 1) continue;
+
+      next_ = (next_ + i + 1) % slots_.size();
+      out = slot;
+      return true;
+    }
+
+    exhausted_++;
+    out = cv::Mat(rows, cols, type);
+    return false;
+  }
+
+  size_t capacity() const { return slots_.size(); }
+
+  // 池耗尽(退化为普通分配)的次数
+  size_t exhausted() const { return exhausted_; }
+
+private:
+  std::vector<cv::Mat> slots_;
+  size_t next_;
+  std::atomic<size_t> exhausted_{0};
+
+  // 消费者线程会并发地增减引用计数, 这里用原子操作读取
+  static int refcount(const cv::Mat & mat) { return CV_XADD(&mat.u->refcount, 0); }
+};
+
+}  // namespace tools
+
+#endif  // TOOLS__FRAME_POOL_HPP
@@ -0,0 +1,255 @@
+#ifndef TOOLS__IMU_HISTORY_HPP
+#define TOOLS__IMU_HISTORY_HPP
+
+#include <Eigen/Geometry>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <memory>
+
+namespace tools
+{
+// 定长、无锁的姿态历史
+// 单个写者(接收线程)按时间顺序push, 任意多个读者可并发查询任意过去时刻, 查询不消耗数据
+// 每个槽位用序号实现seqlock: 读到一半被覆盖的槽位会被发现并重试
+class ImuHistory
+{
+public:
+  struct Sample
+  {
+    Eigen::Quaterniond q;
+    std::chrono::steady_clock::time_point timestamp;
+    bool has_gyro;
+    Eigen::Vector3d gyro;  // 机体系角速度, rad/s
+  };
+
+  // attitude_at()的结果
+  struct Attitude
+  {
+    Eigen::Quaterniond q;
+    double age;         // 查询时刻比最新样本晚多少秒, <=0表示由插值得到
+    bool extrapolated;  // 是否由角速度外推得到
+    bool stale;         // 超出可信的外推范围(如链路中断), 只外推到范围边界
+  };
+
+  explicit ImuHistory(size_t capacity) : capacity_(capacity), slots_(new Slot[capacity]) {}
+
+  // 只允许一个线程调用, timestamp应单调不减(倒退时按上一个样本的时刻记录)
+  void push(const Eigen::Quaterniond & q, std::chrono::steady_clock::time_point timestamp)
+  {
+    push(q, timestamp, Eigen::Vector3d::Constant(std::numeric_limits<double>::quiet_NaN()));
+  }
+
+  // 同时记录陀螺仪角速度(机体系, rad/s), 外推时优先使用
+  void push(
+    const Eigen::Quaterniond & q, std::chrono::steady_clock::time_point timestamp,
+    const Eigen::Vector3d & gyro)
+  {
+    auto n = count_.load(std::memory_order_relaxed);
+    auto & slot = slots_[n % capacity_];
+    last_timestamp_ = std::max(last_timestamp_, timestamp);
+
+    slot.seq.store(2 * n + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    slot.w.store(q.w(), std::memory_order_relaxed);
+    slot.x.store(q.x(), std::memory_order_relaxed);
+    slot.y.store(q.y(), std::memory_order_relaxed);
+    slot.z.store(q.z(), std::memory_order_relaxed);
+    slot.t.store(last_timestamp_.time_since_epoch().count(), std::memory_order_relaxed);
+    slot.gx.store(gyro.x(), std::memory_order_relaxed);
+    slot.gy.store(gyro.y(), std::memory_order_relaxed);
+    slot.gz.store(gyro.z(), std::memory_order_relaxed);
+
+    slot.seq.store(2 * n + 2, std::memory_order_release);
+    count_.store(n + 1, std::memory_order_release);
+  }
+
+  // 累计push的样本数
+  uint64_t size() const { return count_.load(std::memory_order_acquire); }
+
+  bool latest(Sample & sample) const
+  {
+    while (true) {
+      auto n = count_.load(std::memory_order_acquire);
+      if (n == 0) return false;
+      if (read(n - 1, sample)) return true;
+    }
+  }
+
+  // 查询t时刻的姿态, 球面线性插值（SLERP）
+  // 早于最旧样本时取最旧样本; 晚于最新样本或没有样本时返回false
+  bool at(std::chrono::steady_clock::time_point t, Eigen::Quaterniond & q) const
+  {
+    while (true) {
+      auto n = count_.load(std::memory_order_acquire);
+      if (n == 0) return false;
+
+      Sample newest;
+      if (!read(n - 1, newest)) continue;
+      if (t > newest.timestamp) return false;
+
+      // 二分查找第一个晚于t的样本
+      auto first = n > capacity_ ? n - capacity_ : 0;
+      auto lo = first, hi = n;
+      bool ok = true;
+      while (lo < hi && ok) {
+        auto mid = lo + (hi - lo) / 2;
+        Sample s;
+        ok = read(mid, s);
+        if (s.timestamp > t)
+          hi = mid;
+        else
+          lo = mid + 1;
+      }
+      if (!ok) continue;  // 查找期间旧样本被覆盖, 重新查找
+
+      if (lo == n) {
+        q = newest.q;
+        return true;
+      }
+
+      Sample b;
+      if (!read(lo, b)) continue;
+      if (lo == first) {
+        q = b.q;
+        return true;
+      }
+
+      Sample a;
+      if (!read(lo - 1, a)) continue;
+
+      std::chrono::duration<double> t_ab = b.timestamp - a.timestamp;
+      std::chrono::duration<double> t_ac = t - a.timestamp;
+      q = a.q.slerp(t_ac / t_ab, b.q).normalized();
+      return true;
+    }
+  }
+
+  // 不阻塞的查询: 历史范围内插值, 晚于最新样本时按最新角速度外推
+  // 外推超过max_extrapolation(s)时只外推到该时长, 并标记为stale
+  Attitude attitude_at(
+    std::chrono::steady_clock::time_point t, double max_extrapolation = 0.02) const
+  {
+    Attitude attitude{Eigen::Quaterniond::Identity(), 0, false, true};
+
+    while (true) {
+      auto n = count_.load(std::memory_order_acquire);
+      if (n == 0) return attitude;  // 没有任何样本
+
+      Sample newest;
+      if (!read(n - 1, newest)) continue;
+      attitude.age = std::chrono::duration<double>(t - newest.timestamp).count();
+
+      if (attitude.age <= 0) {
+        if (!at(t, attitude.q)) continue;  // 期间有新样本写入, 重新查询
+        attitude.stale = false;
+        return attitude;
+      }
+
+      attitude.extrapolated = true;
+      attitude.stale = attitude.age > max_extrapolation;
+      attitude.q = newest.q;
+
+      Eigen::Vector3d w;
+      if (!angular_velocity(newest, n, w)) return attitude;
+
+      auto angle = w.norm() * std::min(attitude.age, max_extrapolation);
+      if (angle > 0) {
+        Eigen::Quaterniond dq(Eigen::AngleAxisd(angle, w.normalized()));
+        attitude.q = (newest.q * dq).normalized();
+      }
+      return attitude;
+    }
+  }
+
+  // 限制stale告警的频率: attitude为stale且距上次返回true已过interval(s)时返回true
+  // 可在多个线程中并发调用, 同一次告警只有一个线程得到true
+  bool stale_warning_due(
+    const Attitude & attitude, std::chrono::steady_clock::time_point now, double interval = 1.0)
+  {
+    if (!attitude.stale) return false;
+
+    auto last = last_stale_warning_.load(std::memory_order_relaxed);
+    if (std::chrono::duration<double>(now - last).count() < interval) return false;
+    return last_stale_warning_.compare_exchange_strong(last, now, std::memory_order_relaxed);
+  }
+
+private:
+  struct Slot
+  {
+    std::atomic<uint64_t> seq{0};  // 2n+2: 第n个样本已写完, 奇数: 正在写
+    std::atomic<double> w{1}, x{0}, y{0}, z{0};
+    std::atomic<std::chrono::steady_clock::rep> t{0};
+    std::atomic<double> gx{0}, gy{0}, gz{0};  // NaN表示没有陀螺仪数据
+  };
+
+  // 四元数差分时两样本的最小间隔, 避免量化噪声被放大
+  static constexpr double MIN_DIFF_INTERVAL = 5e-3;
+  static constexpr int MAX_DIFF_STEPS = 20;
+
+  const uint64_t capacity_;
+  std::unique_ptr<Slot[]> slots_;
+  std::atomic<uint64_t> count_{0};
+  std::chrono::steady_clock::time_point last_timestamp_;  // 只由写者访问
+
+  // 初始为时钟纪元而不是time_point::min(), 否则now - last溢出, 告警永远不会触发
+  std::atomic<std::chrono::steady_clock::time_point> last_stale_warning_{
+    std::chrono::steady_clock::time_point{}};
+
+  // 读取第i个样本, 已被覆盖或正在写入时返回false
+  bool read(uint64_t i, Sample & sample) const
+  {
+    const auto & slot = slots_[i % capacity_];
+
+    auto seq = slot.seq.load(std::memory_order_acquire);
+    if (seq != 2 * i + 2) return false;
+
+    sample.q = Eigen::Quaterniond(
+      slot.w.load(std::memory_order_relaxed), slot.x.load(std::memory_order_relaxed),
+      slot.y.load(std::memory_order_relaxed), slot.z.load(std::memory_order_relaxed));
+    sample.timestamp = std::chrono::steady_clock::time_point(
+      std::chrono::steady_clock::duration(slot.t.load(std::memory_order_relaxed)));
+    sample.gyro = Eigen::Vector3d(
+      slot.gx.load(std::memory_order_relaxed), slot.gy.load(std::memory_order_relaxed),
+      slot.gz.load(std::memory_order_relaxed));
+    sample.has_gyro = !std::isnan(sample.gyro.x());
+
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return slot.seq.load(std::memory_order_relaxed) == seq;
+  }
+
+  // 最新样本(第n-1个)处的机体系角速度: 有陀螺仪数据时直接使用, 否则对四元数差分
+  bool angular_velocity(const Sample & newest, uint64_t n, Eigen::Vector3d & w) const
+  {
+    if (newest.has_gyro) {
+      w = newest.gyro;
+      return true;
+    }
+
+    // 向前找一个间隔足够的样本
+    auto first = n > capacity_ ? n - capacity_ : 0;
+    auto i = n - 1;
+    Sample prev;
+    double dt = 0;
+    while (i > first && n - i <= MAX_DIFF_STEPS && dt < MIN_DIFF_INTERVAL) {
+      if (!read(--i, prev)) return false;
+      dt = std::chrono::duration<double>(newest.timestamp - prev.timestamp).count();
+    }
+    if (dt <= 0) return false;
+
+    // newest.q = prev.q * dq, dq为机体系下的旋转
+    Eigen::AngleAxisd dq(prev.q.conjugate() * newest.q);
+    auto angle = dq.angle();
+    if (angle > M_PI) angle -= 2 * M_PI;
+    w = dq.axis() * angle / dt;
+    return true;
+  }
+};
+
+}  // namespace tools
+
+#endif  // TOOLS__IMU_HISTORY_HPP
@@ -0,0 +1,109 @@
+#include "ippe.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace tools
+{
+namespace
+{
+using Points = Eigen::Matrix<double, 2, 4>;
+
+// 平面上4个点到归一化像平面的单应矩阵, H(2, 2) = 1
+Eigen::Matrix3d homography(const Points & plane, const Points & image)
+{
+  Eigen::Matrix<double, 8, 8> A;
+  Eigen::Matrix<double, 8, 1> b;
+  for (int i = 0; i < 4; i++) {
+    auto X = plane(0, i), Y = plane(1, i);
+    auto x = image(0, i), y = image(1, i);
+    A.row(2 * i) << X, Y, 1, 0, 0, 0, -x * X, -x * Y;
+    A.row(2 * i + 1) << 0, 0, 0, X, Y, 1, -y * X, -y * Y;
+    b(2 * i) = x;
+    b(2 * i + 1) = y;
+  }
+  Eigen::Matrix<double, 8, 1> h = A.partialPivLu().solve(b);
+
+  Eigen::Matrix3d H;
+  H << h(0), h(1), h(2), h(3), h(4), h(5), h(6), h(7), 1;
+  return H;
+}
+
+// IPPE(Collins & Bartoli, 2014): 由单应矩阵在原点处的雅可比得到平面的两个可能的旋转
+void ippe_rotations(const Eigen::Matrix3d & H, Eigen::Matrix3d & R1, Eigen::Matrix3d & R2)
+{
+  auto p = H(0, 2), q = H(1, 2);
+  Eigen::Matrix2d J;
+  J << H(0, 0) - H(2, 0) * p, H(0, 1) - H(2, 1) * p, H(1, 0) - H(2, 0) * q, H(1, 1) - H(2, 1) * q;
+
+  // Rv把z轴转到原点的视线方向
+  Eigen::Matrix3d Rv =
+    Eigen::Quaterniond::FromTwoVectors(Eigen::Vector3d::UnitZ(), Eigen::Vector3d(p, q, 1))
+      .toRotationMatrix();
+  Eigen::Matrix<double, 2, 3> P;
+  P << 1, 0, -p, 0, 1, -q;
+  Eigen::Matrix2d B = (P * Rv).leftCols<2>();
+  Eigen::Matrix2d A = B.inverse() * J;
+
+  // A的最大奇异值
+  auto ata00 = A.row(0).squaredNorm();
+  auto ata11 = A.row(1).squaredNorm();
+  auto ata01 = A.row(0).dot(A.row(1));
+  auto gamma = std::sqrt(
+    0.5 * (ata00 + ata11 + std::sqrt((ata00 - ata11) * (ata00 - ata11) + 4 * ata01 * ata01)));
+  Eigen::Matrix2d R22 = A / gamma;
+
+  // 补全旋转矩阵的前两列, 第三行的符号对应两个解
+  auto b0 = std::sqrt(std::max(0.0, 1 - R22.col(0).squaredNorm()));
+  auto b1 = std::sqrt(std::max(0.0, 1 - R22.col(1).squaredNorm()));
+  if (R22.col(0).dot(R22.col(1)) > 0) b1 = -b1;
+
+  Eigen::Vector3d c0(R22(0, 0), R22(1, 0), b0), c1(R22(0, 1), R22(1, 1), b1);
+  R1 << c0, c1, c0.cross(c1);
+  c0.z() = -b0, c1.z() = -b1;
+  R2 << c0, c1, c0.cross(c1);
+  R1 = Rv * R1;
+  R2 = Rv * R2;
+}
+
+// 旋转已知时平移的最小二乘解: x * (z + tz) = x' + tx, y同理
+Eigen::Vector3d ippe_translation(
+  const Points & plane, const Points & image, const Eigen::Matrix3d & R)
+{
+  Eigen::Matrix3d AtA = Eigen::Matrix3d::Zero();
+  Eigen::Vector3d Atb = Eigen::Vector3d::Zero();
+  for (int i = 0; i < 4; i++) {
+    Eigen::Vector3d xyz = R.leftCols<2>() * plane.col(i);
+    Eigen::Vector3d ax(1, 0, -image(0, i)), ay(0, 1, -image(1, i));
+    AtA += ax * ax.transpose() + ay * ay.transpose();
+    Atb += ax * (image(0, i) * xyz.z() - xyz.x()) + ay * (image(1, i) * xyz.z() - xyz.y());
+  }
+  return AtA.ldlt().solve(Atb);
+}
+
+double ippe_error(
+  const Points & plane, const Points & image, const Eigen::Matrix3d & R, const Eigen::Vector3d & t)
+{
+  auto error = 0.0;
+  for (int i = 0; i < 4; i++) {
+    Eigen::Vector3d xyz = R.leftCols<2>() * plane.col(i) + t;
+    error += (xyz.head<2>() / xyz.z() - image.col(i)).squaredNorm();
+  }
+  return error;
+}
+
+}  // namespace
+
+void ippe(const Points & plane, const Points & image, Eigen::Matrix3d & R, Eigen::Vector3d & t)
+{
+  Eigen::Matrix3d R1, R2;
+  ippe_rotations(homography(plane, image), R1, R2);
+  Eigen::Vector3d t1 = ippe_translation(plane, image, R1);
+  Eigen::Vector3d t2 = ippe_translation(plane, image, R2);
+
+  auto first = ippe_error(plane, image, R1, t1) <= ippe_error(plane, image, R2, t2);
+  R = first ? R1 : R2;
+  t = first ? t1 : t2;
+}
+
+}  // namespace tools
@@ -0,0 +1,17 @@
+#ifndef TOOLS__IPPE_HPP
+#define TOOLS__IPPE_HPP
+
+#include <Eigen/Dense>
+
+namespace tools
+{
+// 共面4点的PnP(IPPE, Collins & Bartoli, 2014), 全部为固定尺寸的Eigen运算, 不分配内存
+// plane为各点在平面坐标系中的(x, y), 平面为z = 0; image为对应像点去畸变后的归一化坐标(z = 1)
+// 取两个解中重投影误差较小的一个, R与t为平面坐标系到相机坐标系的变换
+void ippe(
+  const Eigen::Matrix<double, 2, 4> & plane, const Eigen::Matrix<double, 2, 4> & image,
+  Eigen::Matrix3d & R, Eigen::Vector3d & t);
+
+}  // namespace tools
+
+#endif  // TOOLS__IPPE_HPP
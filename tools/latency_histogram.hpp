@@ -0,0 +1,86 @@
+#ifndef TOOLS__LATENCY_HISTOGRAM_HPP
+#define TOOLS__LATENCY_HISTOGRAM_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <mutex>
+#include <vector>
+
+namespace tools
+{
+// 滚动直方图: 只统计最近window个样本, 可在一个线程add()的同时在其他线程查询
+// 按resolution分桶, 超出range的样本计入最后一个桶
+class LatencyHistogram
+{
+public:
+  // window: 样本数; resolution, range: s
+  explicit LatencyHistogram(size_t window = 500, double resolution = 1e-4, double range = 0.2)
+  : resolution_(resolution),
+    samples_(window),
+    bins_(static_cast<size_t>(range / resolution) + 1, 0)
+  {
+  }
+
+  void add(double latency)
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    if (count_ == samples_.size()) {
+      auto & oldest = samples_[next_];
+      bins_[bin(oldest)]--;
+      sum_ -= oldest;
+    } else {
+      count_++;
+    }
+
+    samples_[next_] = latency;
+    next_ = (next_ + 1) % samples_.size();
+    bins_[bin(latency)]++;
+    sum_ += latency;
+  }
+
+  size_t count() const
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return count_;
+  }
+
+  double mean() const
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return count_ == 0 ? 0 : sum_ / count_;
+  }
+
+  // p取0~1, 返回所在桶的中心值; 没有样本时返回0
+  double percentile(double p) const
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (count_ == 0) return 0;
+
+    auto rank = static_cast<size_t>(std::clamp(p, 0.0, 1.0) * (count_ - 1)) + 1;
+    size_t accumulated = 0;
+    for (size_t i = 0; i < bins_.size(); i++) {
+      accumulated += bins_[i];
+      if (accumulated >= rank) return (i + 0.5) * resolution_;
+    }
+    return (bins_.size() - 0.5) * resolution_;
+  }
+
+private:
+  const double resolution_;
+  std::vector<double> samples_;  // 环形缓冲, 用于移除最旧的样本
+  std::vector<size_t> bins_;
+  size_t next_ = 0, count_ = 0;
+  double sum_ = 0;
+  mutable std::mutex mutex_;
+
+  size_t bin(double latency) const
+  {
+    if (latency <= 0) return 0;
+    return std::min(static_cast<size_t>(latency / resolution_), bins_.size() - 1);
+  }
+};
+
+}  // namespace tools
+
+#endif  // TOOLS__LATENCY_HISTOGRAM_HPP
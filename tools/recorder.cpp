@@ -62,13 +62,17 @@ void Recorder::record(
   if (img.empty()) return;
   if (!init_) init(img);
 
-  auto since_last = tools::delta_time(timestamp, last_time_);
-  if (since_last < 1.0 / fps_) return;
+  if (!due(timestamp)) return;
 
   last_time_ = timestamp;
   queue_.push({img, q, timestamp});
 }
 
+bool Recorder::due(const std::chrono::steady_clock::time_point & timestamp) const
+{
+  return tools::delta_time(timestamp, last_time_) >= 1.0 / fps_;
+}
+
 void Recorder::init(const cv::Mat & img)
 {
   text_writer_.open(text_path_);
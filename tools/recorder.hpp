@@ -19,6 +19,9 @@ public:
     const cv::Mat & img, const Eigen::Quaterniond & q,
     const std::chrono::steady_clock::time_point & timestamp);
 
+  // 该时刻的帧是否会被记录, 供调用者只在需要时生成BGR图像
+  bool due(const std::chrono::steady_clock::time_point & timestamp) const;
+
 private:
   struct FrameData
   {
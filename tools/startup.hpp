@@ -0,0 +1,100 @@
+#ifndef TOOLS__STARTUP_HPP
+#define TOOLS__STARTUP_HPP
+
+#include <algorithm>
+#include <chrono>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "tools/logger.hpp"
+#include "tools/math_tools.hpp"
+
+namespace tools
+{
+// 启动计时: 互不依赖的模块在各自线程中并行构造, 主循环开始前输出各阶段耗时
+class Startup
+{
+public:
+  Startup() : t0_(std::chrono::steady_clock::now()) {}
+
+  // 在新线程中构造T, 参数按值传入; 构造完成后get()得到对象, 构造抛出的异常也在get()时抛出
+  template <typename T, typename... Args>
+  std::future<std::unique_ptr<T>> async(const std::string & name, Args... args)
+  {
+    return std::async(std::launch::async, [this, name, args...] {
+      return measure(name, [&] { return std::make_unique<T>(args...); });
+    });
+  }
+
+  // 在当前线程中执行f并计时
+  template <typename F>
+  auto measure(const std::string & name, F && f) -> decltype(f())
+  {
+    auto begin = std::chrono::steady_clock::now();
+    if constexpr (std::is_void_v<decltype(f())>) {
+      f();
+      record(name, begin);
+    } else {
+      auto result = f();
+      record(name, begin);
+      return result;
+    }
+  }
+
+  // 各阶段的开始、结束时刻(相对启动)与耗时; 各阶段耗时之和与其覆盖的时长之差即并行节省的时间
+  void report() const
+  {
+    auto now = std::chrono::steady_clock::now();
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    auto stages = stages_;
+    std::sort(stages.begin(), stages.end(), [](const Stage & a, const Stage & b) {
+      return a.begin < b.begin;
+    });
+
+    auto sum = 0.0, covered = 0.0;
+    auto covered_end = t0_;
+    for (const auto & stage : stages) {
+      auto duration = delta_time(stage.end, stage.begin);
+      sum += duration;
+      if (stage.end > covered_end) {
+        covered += delta_time(stage.end, std::max(stage.begin, covered_end));
+        covered_end = stage.end;
+      }
+      logger()->info(
+        "[Startup] {:<16} {:>7.0f}ms  ({:.0f} -> {:.0f}ms)", stage.name, duration * 1e3,
+        delta_time(stage.begin, t0_) * 1e3, delta_time(stage.end, t0_) * 1e3);
+    }
+
+    auto total = delta_time(now, t0_);
+    logger()->info(
+      "[Startup] total {:.0f}ms | stages {:.0f}ms, saved by parallel {:.0f}ms | other {:.0f}ms",
+      total * 1e3, covered * 1e3, (sum - covered) * 1e3, (total - covered) * 1e3);
+  }
+
+private:
+  struct Stage
+  {
+    std::string name;
+    std::chrono::steady_clock::time_point begin, end;
+  };
+
+  const std::chrono::steady_clock::time_point t0_;
+  mutable std::mutex mutex_;
+  std::vector<Stage> stages_;
+
+  void record(const std::string & name, std::chrono::steady_clock::time_point begin)
+  {
+    auto end = std::chrono::steady_clock::now();
+    std::lock_guard<std::mutex> lock(mutex_);
+    stages_.push_back({name, begin, end});
+  }
+};
+
+}  // namespace tools
+
+#endif  // TOOLS__STARTUP_HPP